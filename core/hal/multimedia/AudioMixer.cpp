@@ -20,11 +20,20 @@
 #include "AudioMixer.h"
 
 #include <QMutexLocker>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 
 #include "../../services/logging/Logger.h"
 
+namespace {
+/// Smallest ring per channel, whatever the configured latency
+constexpr qint64 kMinRingBytes = 4096;
+/// One overrun warning per this many dropped chunks
+constexpr quint64 kOverrunLogSampling = 100;
+}  // namespace
+
 AudioMixer::AudioMixer(QObject* parent) : IAudioMixer(parent) {
   Logger::instance().info("AudioMixer created");
 }
@@ -41,7 +50,7 @@ bool AudioMixer::initialize(const AudioFormat& masterFormat) {
   }
 
   m_masterFormat = masterFormat;
-  m_isInitialized = true;
+  m_isInitialized.store(true, std::memory_order_release);
 
   Logger::instance().info(QString("AudioMixer initialized: %1Hz, %2ch, %3bit")
                               .arg(masterFormat.sampleRate)
@@ -57,36 +66,70 @@ void AudioMixer::deinitialize() {
   }
 
   QMutexLocker locker(&m_mutex);
-  m_channels.clear();
+  m_isInitialized.store(false, std::memory_order_release);
+  // Rings stay allocated for reuse; slots are only hidden
+  for (ChannelData& channel : m_channels) {
+    channel.present.store(false, std::memory_order_release);
+  }
   m_mixBuffer.clear();
-  m_isInitialized = false;
 
   Logger::instance().info("AudioMixer deinitialized");
 }
 
+auto AudioMixer::presentChannel(ChannelId channelId) -> ChannelData* {
+  const int index = static_cast<int>(channelId);
+  if (index < 0 || index >= kChannelCount ||
+      !m_channels[index].present.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return &m_channels[index];
+}
+
+auto AudioMixer::presentChannel(ChannelId channelId) const -> const ChannelData* {
+  return const_cast<AudioMixer*>(this)->presentChannel(channelId);
+}
+
 bool AudioMixer::addChannel(const ChannelConfig& config) {
   QMutexLocker locker(&m_mutex);
 
-  if (m_channels.contains(config.id)) {
+  const int index = static_cast<int>(config.id);
+  if (index < 0 || index >= kChannelCount) {
+    Logger::instance().warning(QString("Invalid audio channel id %1").arg(index));
+    return false;
+  }
+  if (presentChannel(config.id) != nullptr) {
     Logger::instance().warning(
         QString("Channel %1 already exists").arg(channelIdToString(config.id)));
     return false;
   }
 
-  ChannelData data;
-  data.config = config;
-  data.active = false;
-
-  m_channels.insert(config.id, data);
+  // Size the ring from the latency budget in master format, which is what it holds
+  const qint64 bytesPerSecond = qint64(m_masterFormat.sampleRate) * m_masterFormat.channels *
+                                (m_masterFormat.bitsPerSample / 8);
+  const qint64 ringBytes =
+      std::max(kMinRingBytes, bytesPerSecond * std::max(config.latencyMs, 1) / 1000);
+
+  ChannelData& channel = m_channels[index];
+  channel.config = config;
+  channel.volume.store(qBound(0.0f, config.volume, 1.0f), std::memory_order_relaxed);
+  channel.muted.store(config.muted, std::memory_order_relaxed);
+  channel.overruns.store(0, std::memory_order_relaxed);
+  if (!channel.ring || channel.ring->capacity() < ringBytes) {
+    channel.ring = std::make_unique<SpscByteRing>(static_cast<std::size_t>(ringBytes));
+  } else {
+    channel.ring->clear();
+  }
+  channel.present.store(true, std::memory_order_release);
 
   Logger::instance().info(
-      QString("Added audio channel: %1 (%2Hz, %3ch, %4bit, volume=%5, priority=%6)")
+      QString("Added audio channel: %1 (%2Hz, %3ch, %4bit, volume=%5, priority=%6, buffer=%7B)")
           .arg(channelIdToString(config.id))
           .arg(config.format.sampleRate)
           .arg(config.format.channels)
           .arg(config.format.bitsPerSample)
           .arg(config.volume)
-          .arg(config.priority));
+          .arg(config.priority)
+          .arg(channel.ring->capacity()));
 
   emit channelConfigChanged(config.id);
   return true;
@@ -95,193 +138,200 @@ bool AudioMixer::addChannel(const ChannelConfig& config) {
 bool AudioMixer::removeChannel(ChannelId channelId) {
   QMutexLocker locker(&m_mutex);
 
-  if (!m_channels.contains(channelId)) {
+  ChannelData* channel = presentChannel(channelId);
+  if (channel == nullptr) {
     Logger::instance().warning(
         QString("Channel %1 does not exist").arg(channelIdToString(channelId)));
     return false;
   }
 
-  m_channels.remove(channelId);
+  // The ring is kept so re-adding the channel does not allocate
+  channel->present.store(false, std::memory_order_release);
   Logger::instance().info(QString("Removed audio channel: %1").arg(channelIdToString(channelId)));
 
   return true;
 }
 
 bool AudioMixer::mixAudioData(ChannelId channelId, const QByteArray& audioData) {
-  if (!m_isInitialized) {
+  if (!m_isInitialized.load(std::memory_order_acquire)) {
     return false;
   }
 
-  QMutexLocker locker(&m_mutex);
-
-  if (!m_channels.contains(channelId)) {
+  ChannelData* channel = presentChannel(channelId);
+  if (channel == nullptr) {
     Logger::instance().warning(
         QString("Cannot mix audio: channel %1 not found").arg(channelIdToString(channelId)));
     return false;
   }
 
-  ChannelData& channel = m_channels[channelId];
-
-  // Convert format if needed
-  QByteArray convertedData = audioData;
-  if (channel.config.format.sampleRate != m_masterFormat.sampleRate ||
-      channel.config.format.channels != m_masterFormat.channels ||
-      channel.config.format.bitsPerSample != m_masterFormat.bitsPerSample) {
-    convertedData = convertFormat(audioData, channel.config.format, m_masterFormat);
+  // Convert format if needed (into scratch buffers that keep their capacity)
+  const QByteArray* pcm = &audioData;
+  if (channel->config.format.sampleRate != m_masterFormat.sampleRate ||
+      channel->config.format.channels != m_masterFormat.channels ||
+      channel->config.format.bitsPerSample != m_masterFormat.bitsPerSample) {
+    convertFormat(audioData, channel->config.format, m_masterFormat, channel->converted,
+                  channel->resampled);
+    pcm = &channel->converted;
   }
 
-  // Append to channel buffer
-  channel.buffer.append(convertedData);
-  channel.active = true;
+  if (!channel->ring->write(pcm->constData(), static_cast<std::size_t>(pcm->size()))) {
+    const quint64 overruns = channel->overruns.fetch_add(1, std::memory_order_relaxed) + 1;
+    CRANKSHAFT_LOG_SAMPLED(Logger::Level::Warning, "AudioMixer", kOverrunLogSampling,
+                           QString("Channel %1 buffer full: dropped %2 bytes (%3 overruns)")
+                               .arg(channelIdToString(channelId))
+                               .arg(pcm->size())
+                               .arg(overruns));
+  }
 
-  // Mix all active channels
-  mixBuffers();
+  // Mix all active channels, unless another producer is already doing so
+  if (!m_mixing.test_and_set(std::memory_order_acquire)) {
+    mixBuffers();
+    m_mixing.clear(std::memory_order_release);
+  }
 
   return true;
 }
 
 void AudioMixer::setChannelVolume(ChannelId channelId, float volume) {
-  QMutexLocker locker(&m_mutex);
-
-  if (!m_channels.contains(channelId)) {
+  ChannelData* channel = presentChannel(channelId);
+  if (channel == nullptr) {
     return;
   }
 
   volume = qBound(0.0f, volume, 1.0f);
-  m_channels[channelId].config.volume = volume;
+  channel->volume.store(volume, std::memory_order_relaxed);
 
-  Logger::instance().debug(
+  CRANKSHAFT_LOG_DEBUG(
       QString("Channel %1 volume set to %2").arg(channelIdToString(channelId)).arg(volume));
 
   emit channelConfigChanged(channelId);
 }
 
 float AudioMixer::getChannelVolume(ChannelId channelId) const {
-  QMutexLocker locker(&m_mutex);
-
-  if (!m_channels.contains(channelId)) {
+  const ChannelData* channel = presentChannel(channelId);
+  if (channel == nullptr) {
     return 0.0f;
   }
 
-  return m_channels[channelId].config.volume;
+  return channel->volume.load(std::memory_order_relaxed);
 }
 
 void AudioMixer::setChannelMuted(ChannelId channelId, bool muted) {
-  QMutexLocker locker(&m_mutex);
-
-  if (!m_channels.contains(channelId)) {
+  ChannelData* channel = presentChannel(channelId);
+  if (channel == nullptr) {
     return;
   }
 
-  m_channels[channelId].config.muted = muted;
+  channel->muted.store(muted, std::memory_order_relaxed);
 
-  Logger::instance().debug(
+  CRANKSHAFT_LOG_DEBUG(
       QString("Channel %1 %2").arg(channelIdToString(channelId)).arg(muted ? "muted" : "unmuted"));
 
   emit channelConfigChanged(channelId);
 }
 
 bool AudioMixer::isChannelMuted(ChannelId channelId) const {
-  QMutexLocker locker(&m_mutex);
-
-  if (!m_channels.contains(channelId)) {
+  const ChannelData* channel = presentChannel(channelId);
+  if (channel == nullptr) {
     return true;
   }
 
-  return m_channels[channelId].config.muted;
+  return channel->muted.load(std::memory_order_relaxed);
 }
 
 void AudioMixer::setMasterVolume(float volume) {
   volume = qBound(0.0f, volume, 1.0f);
-  m_masterVolume = volume;
+  m_masterVolume.store(volume, std::memory_order_relaxed);
+
+  CRANKSHAFT_LOG_DEBUG(QString("Master volume set to %1").arg(volume));
+}
 
-  Logger::instance().debug(QString("Master volume set to %1").arg(volume));
+quint64 AudioMixer::channelOverruns(ChannelId channelId) const {
+  const ChannelData* channel = presentChannel(channelId);
+  return channel != nullptr ? channel->overruns.load(std::memory_order_relaxed) : 0;
+}
+
+qsizetype AudioMixer::channelBufferSize(ChannelId channelId) const {
+  const ChannelData* channel = presentChannel(channelId);
+  return channel != nullptr ? channel->ring->capacity() : 0;
 }
 
 void AudioMixer::mixBuffers() {
-  // Calculate minimum buffer size across all active channels
-  int minBufferSize = INT_MAX;
+  // Calculate minimum buffered size across all active channels
+  std::array<ChannelData*, kChannelCount> active{};
   int activeChannelCount = 0;
+  std::size_t minBufferSize = SIZE_MAX;
 
-  for (auto it = m_channels.begin(); it != m_channels.end(); ++it) {
-    if (it->active && it->buffer.size() > 0) {
-      minBufferSize = qMin(minBufferSize, it->buffer.size());
-      activeChannelCount++;
+  for (ChannelData& channel : m_channels) {
+    if (!channel.present.load(std::memory_order_acquire)) {
+      continue;
+    }
+    const std::size_t readable = channel.ring->readable();
+    if (readable > 0) {
+      minBufferSize = std::min(minBufferSize, readable);
+      active[activeChannelCount++] = &channel;
     }
   }
 
-  if (activeChannelCount == 0 || minBufferSize == 0) {
+  if (activeChannelCount == 0) {
     return;
   }
 
   // Calculate number of samples to mix
-  int bytesPerSample = m_masterFormat.bitsPerSample / 8;
-  int sampleCount = minBufferSize / (bytesPerSample * m_masterFormat.channels);
+  const int bytesPerSample = m_masterFormat.bitsPerSample / 8;
+  const std::size_t frameBytes = static_cast<std::size_t>(bytesPerSample * m_masterFormat.channels);
+  if (frameBytes == 0) {
+    return;
+  }
+  const std::size_t mixBufferSize = (minBufferSize / frameBytes) * frameBytes;
 
-  if (sampleCount == 0) {
+  if (mixBufferSize == 0) {
     return;
   }
 
-  // Prepare mix buffer
-  int mixBufferSize = sampleCount * bytesPerSample * m_masterFormat.channels;
-  m_mixBuffer.resize(mixBufferSize);
+  // Prepare mix buffer (keeps its capacity between mixes)
+  m_mixBuffer.resize(static_cast<qsizetype>(mixBufferSize));
   m_mixBuffer.fill(0);
 
-  // Mix samples (16-bit PCM assumed)
-  if (m_masterFormat.bitsPerSample == 16) {
-    int16_t* mixBufferPtr = reinterpret_cast<int16_t*>(m_mixBuffer.data());
-
-    // Sort channels by priority (highest first)
-    QList<ChannelId> sortedChannels;
-    for (auto it = m_channels.begin(); it != m_channels.end(); ++it) {
-      if (it->active && it->buffer.size() >= mixBufferSize) {
-        sortedChannels.append(it.key());
+  // Sort channels by priority (highest first)
+  std::sort(active.begin(), active.begin() + activeChannelCount,
+            [](const ChannelData* a, const ChannelData* b) {
+              return a->config.priority > b->config.priority;
+            });
+
+  // Mix each channel straight out of its ring; muted channels are consumed too
+  const float masterVolume = m_masterVolume.load(std::memory_order_relaxed);
+  int16_t* mixBufferPtr = reinterpret_cast<int16_t*>(m_mixBuffer.data());
+  for (int c = 0; c < activeChannelCount; ++c) {
+    ChannelData& channel = *active[c];
+    const bool mix =
+        m_masterFormat.bitsPerSample == 16 && !channel.muted.load(std::memory_order_relaxed);
+    const float channelVolume = channel.volume.load(std::memory_order_relaxed) * masterVolume;
+    std::size_t offset = 0;
+
+    channel.ring->read(mixBufferSize, [&](const char* data, std::size_t length) {
+      if (mix) {
+        const int16_t* channelPtr = reinterpret_cast<const int16_t*>(data);
+        int16_t* out = mixBufferPtr + offset / sizeof(int16_t);
+        const std::size_t samples = length / sizeof(int16_t);
+
+        // Mix samples
+        for (std::size_t i = 0; i < samples; ++i) {
+          float sample =
+              static_cast<float>(out[i]) + (static_cast<float>(channelPtr[i]) * channelVolume);
+
+          // Apply soft saturation
+          sample = applySaturation(sample);
+
+          out[i] = static_cast<int16_t>(sample);
+        }
       }
-    }
-
-    std::sort(sortedChannels.begin(), sortedChannels.end(), [this](ChannelId a, ChannelId b) {
-      return m_channels[a].config.priority > m_channels[b].config.priority;
+      offset += length;
     });
-
-    // Mix each channel
-    for (ChannelId channelId : sortedChannels) {
-      ChannelData& channel = m_channels[channelId];
-
-      if (channel.config.muted) {
-        continue;
-      }
-
-      const int16_t* channelPtr = reinterpret_cast<const int16_t*>(channel.buffer.constData());
-      float channelVolume = channel.config.volume * m_masterVolume;
-
-      // Mix samples
-      for (int i = 0; i < sampleCount * m_masterFormat.channels; ++i) {
-        float sample = static_cast<float>(mixBufferPtr[i]) +
-                       (static_cast<float>(channelPtr[i]) * channelVolume);
-
-        // Apply soft saturation
-        sample = applySaturation(sample);
-
-        mixBufferPtr[i] = static_cast<int16_t>(sample);
-      }
-    }
-  }
-
-  // Remove mixed data from channel buffers
-  for (auto it = m_channels.begin(); it != m_channels.end(); ++it) {
-    if (it->active && it->buffer.size() >= mixBufferSize) {
-      it->buffer.remove(0, mixBufferSize);
-
-      if (it->buffer.isEmpty()) {
-        it->active = false;
-      }
-    }
   }
 
   // Emit mixed audio
-  if (!m_mixBuffer.isEmpty()) {
-    emit audioMixed(m_mixBuffer);
-  }
+  emit audioMixed(m_mixBuffer);
 }
 
 float AudioMixer::applySaturation(float sample) {
@@ -308,72 +358,66 @@ float AudioMixer::applySaturation(float sample) {
   return sample;
 }
 
-QByteArray AudioMixer::convertFormat(const QByteArray& input, const AudioFormat& inputFormat,
-                                     const AudioFormat& outputFormat) {
-  // Simple format conversion (resampling + channel conversion)
-  QByteArray result = input;
+void AudioMixer::convertFormat(const QByteArray& input, const AudioFormat& inputFormat,
+                               const AudioFormat& outputFormat, QByteArray& output,
+                               QByteArray& scratch) {
+  // Simple format conversion (resampling + channel conversion). Both buffers are
+  // reused across calls, so a steady stream converts without allocating.
+  const bool remix = inputFormat.channels != outputFormat.channels;
+  const QByteArray* source = &input;
 
   // First, resample if sample rates differ
   if (inputFormat.sampleRate != outputFormat.sampleRate) {
-    result = resample(result, inputFormat.sampleRate, outputFormat.sampleRate, inputFormat.channels,
-                      inputFormat.bitsPerSample);
+    QByteArray& target = remix ? scratch : output;
+    resample(input, inputFormat.sampleRate, outputFormat.sampleRate, inputFormat.channels,
+             inputFormat.bitsPerSample, target);
+    source = &target;
   }
 
   // Then, convert channels if needed (mono<->stereo)
-  if (inputFormat.channels != outputFormat.channels) {
-    if (inputFormat.channels == 1 && outputFormat.channels == 2) {
+  if (remix) {
+    if (inputFormat.channels == 1 && outputFormat.channels == 2 &&
+        inputFormat.bitsPerSample == 16) {
       // Mono to stereo: duplicate samples
-      QByteArray stereo;
-      stereo.reserve(result.size() * 2);
-
-      if (inputFormat.bitsPerSample == 16) {
-        const int16_t* monoPtr = reinterpret_cast<const int16_t*>(result.constData());
-        int sampleCount = result.size() / 2;
-
-        for (int i = 0; i < sampleCount; ++i) {
-          int16_t sample = monoPtr[i];
-          stereo.append(reinterpret_cast<const char*>(&sample), 2);
-          stereo.append(reinterpret_cast<const char*>(&sample), 2);
-        }
+      const int16_t* monoPtr = reinterpret_cast<const int16_t*>(source->constData());
+      const qsizetype sampleCount = source->size() / 2;
+      output.resize(sampleCount * 4);
+      int16_t* stereoPtr = reinterpret_cast<int16_t*>(output.data());
+
+      for (qsizetype i = 0; i < sampleCount; ++i) {
+        stereoPtr[i * 2] = monoPtr[i];
+        stereoPtr[i * 2 + 1] = monoPtr[i];
       }
-
-      result = stereo;
-    } else if (inputFormat.channels == 2 && outputFormat.channels == 1) {
+    } else if (inputFormat.channels == 2 && outputFormat.channels == 1 &&
+               inputFormat.bitsPerSample == 16) {
       // Stereo to mono: average samples
-      QByteArray mono;
-      mono.reserve(result.size() / 2);
-
-      if (inputFormat.bitsPerSample == 16) {
-        const int16_t* stereoPtr = reinterpret_cast<const int16_t*>(result.constData());
-        int sampleCount = result.size() / 4;  // 2 samples per frame, 2 bytes each
-
-        for (int i = 0; i < sampleCount; ++i) {
-          int16_t left = stereoPtr[i * 2];
-          int16_t right = stereoPtr[i * 2 + 1];
-          int16_t avg = (left + right) / 2;
-          mono.append(reinterpret_cast<const char*>(&avg), 2);
-        }
+      const int16_t* stereoPtr = reinterpret_cast<const int16_t*>(source->constData());
+      const qsizetype sampleCount = source->size() / 4;  // 2 samples per frame, 2 bytes each
+      output.resize(sampleCount * 2);
+      int16_t* monoPtr = reinterpret_cast<int16_t*>(output.data());
+
+      for (qsizetype i = 0; i < sampleCount; ++i) {
+        int16_t left = stereoPtr[i * 2];
+        int16_t right = stereoPtr[i * 2 + 1];
+        monoPtr[i] = static_cast<int16_t>((left + right) / 2);
       }
-
-      result = mono;
+    } else {
+      output.resize(0);
     }
+  } else if (source != &output) {
+    // Copy rather than share, so the next resize() does not detach
+    output.resize(source->size());
+    std::memcpy(output.data(), source->constData(), static_cast<std::size_t>(source->size()));
   }
-
-  return result;
 }
 
-QByteArray AudioMixer::resample(const QByteArray& input, int inputSampleRate, int outputSampleRate,
-                                int channels, int bitsPerSample) {
+void AudioMixer::resample(const QByteArray& input, int inputSampleRate, int outputSampleRate,
+                          int channels, int bitsPerSample, QByteArray& output) {
   // Simple linear interpolation resampling
-  if (inputSampleRate == outputSampleRate) {
-    return input;
-  }
-
   int bytesPerSample = bitsPerSample / 8;
   int inputSampleCount = input.size() / (bytesPerSample * channels);
   int outputSampleCount = (inputSampleCount * outputSampleRate) / inputSampleRate;
 
-  QByteArray output;
   output.resize(outputSampleCount * bytesPerSample * channels);
 
   if (bitsPerSample == 16) {
@@ -399,6 +443,4 @@ QByteArray AudioMixer::resample(const QByteArray& input, int inputSampleRate, in
       }
     }
   }
-
-  return output;
 }
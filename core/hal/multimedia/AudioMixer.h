@@ -19,11 +19,13 @@
 
 #pragma once
 
-#include <QMap>
 #include <QMutex>
-#include <QVector>
+#include <array>
+#include <atomic>
+#include <memory>
 
 #include "IAudioMixer.h"
+#include "SpscByteRing.h"
 
 /**
  * @brief Software audio mixer implementation
@@ -31,6 +33,22 @@
  * Mixes multiple PCM audio streams with volume control and format conversion.
  * Supports mixing channels with different sample rates and channel counts.
  * Uses priority-based mixing when channels overlap.
+ *
+ * RING BUFFERS:
+ * ─────────────
+ * Each channel writes converted PCM into its own SpscByteRing. The ring is
+ * preallocated in addChannel() to hold ChannelConfig::latencyMs of master
+ * format audio. mixAudioData() never takes a lock. The producer converts
+ * into per-channel scratch buffers and copies into the ring. It then mixes
+ * only if no other producer is mixing, and otherwise returns at once. Data
+ * that arrives during a mix is mixed by the next call. A chunk that does
+ * not fit is dropped and counted (channelOverruns()).
+ *
+ * THREAD SAFETY:
+ * - mixAudioData() may be called from one thread per channel
+ * - Volume, mute and master volume may be changed from any thread
+ * - addChannel(), removeChannel() and deinitialize() must not race with
+ *   mixAudioData() for the same channel (stop the stream first)
  */
 class AudioMixer : public IAudioMixer {
   Q_OBJECT
@@ -54,38 +72,59 @@ class AudioMixer : public IAudioMixer {
 
   void setMasterVolume(float volume) override;
   float getMasterVolume() const override {
-    return m_masterVolume;
+    return m_masterVolume.load(std::memory_order_relaxed);
   }
 
   bool isReady() const override {
-    return m_isInitialized;
+    return m_isInitialized.load(std::memory_order_acquire);
   }
   QString getMixerName() const override {
     return "Software PCM Mixer";
   }
 
+  /**
+   * @brief Chunks dropped because the channel's ring was full
+   */
+  [[nodiscard]] auto channelOverruns(ChannelId channelId) const -> quint64;
+
+  /**
+   * @brief Ring capacity in bytes for a channel (0 if the channel does not exist)
+   */
+  [[nodiscard]] auto channelBufferSize(ChannelId channelId) const -> qsizetype;
+
  private:
+  static constexpr int kChannelCount = static_cast<int>(ChannelId::MAX_CHANNELS);
+
   struct ChannelData {
-    ChannelConfig config;
-    QByteArray buffer;  // Buffered audio data
-    bool active{false};
+    ChannelConfig config;  // Fixed while present; volume and mute live in the atomics
+    std::atomic_bool present{false};
+    std::atomic<float> volume{1.0f};
+    std::atomic_bool muted{false};
+    std::unique_ptr<SpscByteRing> ring;  // Master format PCM, producer to mixer
+    QByteArray converted;                // Producer-side conversion scratch
+    QByteArray resampled;
+    std::atomic<quint64> overruns{0};
   };
 
-  QByteArray convertFormat(const QByteArray& input, const AudioFormat& inputFormat,
-                           const AudioFormat& outputFormat);
-  QByteArray resample(const QByteArray& input, int inputSampleRate, int outputSampleRate,
-                      int channels, int bitsPerSample);
+  /// Channel slot for an id, or nullptr if it is out of range or not present
+  auto presentChannel(ChannelId channelId) -> ChannelData*;
+  auto presentChannel(ChannelId channelId) const -> const ChannelData*;
+
+  void convertFormat(const QByteArray& input, const AudioFormat& inputFormat,
+                     const AudioFormat& outputFormat, QByteArray& output, QByteArray& scratch);
+  void resample(const QByteArray& input, int inputSampleRate, int outputSampleRate, int channels,
+                int bitsPerSample, QByteArray& output);
   void mixBuffers();
   auto applySaturation(float sample) -> float;
 
   AudioFormat m_masterFormat;
-  float m_masterVolume{0.75f};
-  bool m_isInitialized{false};
+  std::atomic<float> m_masterVolume{0.75f};
+  std::atomic_bool m_isInitialized{false};
 
-  QMap<ChannelId, ChannelData> m_channels;
-  mutable QMutex m_mutex;
+  std::array<ChannelData, kChannelCount> m_channels;
+  mutable QMutex m_mutex;  // Serialises channel setup; never taken on the audio path
+  std::atomic_flag m_mixing = ATOMIC_FLAG_INIT;
 
-  // Mix buffer
+  // Mix buffer (mixing producer only)
   QByteArray m_mixBuffer;
-  int m_mixBufferSamples{0};
 };
@@ -279,6 +279,8 @@ bool GStreamerVideoDecoder::decodeFrame(const QByteArray& encodedData) {
 }
 
 GstFlowReturn GStreamerVideoDecoder::onNewSample(GstAppSink* appsink, gpointer user_data) {
+  // Runs on the appsink streaming thread, which must never wait on logging
+  Logger::setRealtimeThread(true);
   GStreamerVideoDecoder* decoder = static_cast<GStreamerVideoDecoder*>(user_data);
   if (!decoder) {
     return GST_FLOW_ERROR;
@@ -351,7 +353,7 @@ gboolean GStreamerVideoDecoder::onBusMessage(GstBus* bus, GstMessage* message, g
 
       Logger::instance().error(QString("GStreamer error: %1").arg(err->message));
       if (debug) {
-        Logger::instance().debug(QString("Debug info: %1").arg(debug));
+        CRANKSHAFT_LOG_DEBUG(QString("Debug info: %1").arg(debug));
       }
 
       emit decoder->errorOccurred(QString::fromUtf8(err->message));
@@ -368,7 +370,7 @@ gboolean GStreamerVideoDecoder::onBusMessage(GstBus* bus, GstMessage* message, g
 
       Logger::instance().warning(QString("GStreamer warning: %1").arg(err->message));
       if (debug) {
-        Logger::instance().debug(QString("Debug info: %1").arg(debug));
+        CRANKSHAFT_LOG_DEBUG(QString("Debug info: %1").arg(debug));
       }
 
       g_error_free(err);
@@ -384,9 +386,9 @@ gboolean GStreamerVideoDecoder::onBusMessage(GstBus* bus, GstMessage* message, g
       if (GST_MESSAGE_SRC(message) == GST_OBJECT(decoder->m_pipeline)) {
         GstState oldState, newState, pending;
         gst_message_parse_state_changed(message, &oldState, &newState, &pending);
-        Logger::instance().debug(QString("GStreamer state changed: %1 -> %2")
-                                     .arg(gst_element_state_get_name(oldState))
-                                     .arg(gst_element_state_get_name(newState)));
+        CRANKSHAFT_LOG_DEBUG(QString("GStreamer state changed: %1 -> %2")
+                                 .arg(gst_element_state_get_name(oldState))
+                                 .arg(gst_element_state_get_name(newState)));
       }
       break;
     }
@@ -400,5 +402,5 @@ gboolean GStreamerVideoDecoder::onBusMessage(GstBus* bus, GstMessage* message, g
 
 void GStreamerVideoDecoder::onPadAdded(GstElement* element, GstPad* pad, gpointer data) {
   // This is for dynamic pad linking if needed
-  Logger::instance().debug("Pad added to decoder");
+  CRANKSHAFT_LOG_DEBUG("Pad added to decoder");
 }
@@ -53,6 +53,7 @@ class IAudioMixer : public QObject {
     bool muted{false};
     int priority{0};  // Higher = higher priority
     AudioFormat format;
+    int latencyMs{100};  // Input the channel buffers before it overruns (sizes its buffer)
   };
 
   explicit IAudioMixer(QObject* parent = nullptr) : QObject(parent) {}
@@ -0,0 +1,127 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <QtGlobal>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+/**
+ * @class SpscByteRing
+ * @brief Bounded wait-free single-producer / single-consumer byte ring
+ *
+ * A power-of-two byte array with a head index advanced by the producer
+ * and a tail index advanced by the consumer. Each side does one acquire
+ * load of the other's index and one release store of its own. Nothing is
+ * allocated after construction. Data is copied in and out with at most
+ * two memcpy calls (one at the wrap point), so the buffer never
+ * reallocates or memmoves. Used for per-channel audio in AudioMixer.
+ *
+ * THREAD SAFETY:
+ * - write() must only ever be called from one thread at a time
+ * - readable(), read() and clear() must only ever be called from one
+ *   (other) thread at a time
+ */
+class SpscByteRing {
+ public:
+  /**
+   * @param capacity Byte capacity, rounded up to a power of two (minimum 64)
+   */
+  explicit SpscByteRing(std::size_t capacity) {
+    std::size_t size = 64;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    m_mask = size - 1;
+    m_data = std::make_unique<char[]>(size);
+  }
+
+  SpscByteRing(const SpscByteRing&) = delete;
+  SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+  /**
+   * @brief Append size bytes unless they do not all fit (producer thread only)
+   * @return false, writing nothing, if the free space is smaller than size
+   */
+  auto write(const char* data, std::size_t size) -> bool {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    const std::size_t tail = m_tail.load(std::memory_order_acquire);
+    if (size > capacityBytes() - (head - tail)) {
+      return false;
+    }
+    const std::size_t offset = head & m_mask;
+    const std::size_t first = std::min(size, capacityBytes() - offset);
+    std::memcpy(m_data.get() + offset, data, first);
+    std::memcpy(m_data.get(), data + first, size - first);
+    m_head.store(head + size, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Bytes available to read (consumer thread only)
+   */
+  [[nodiscard]] auto readable() const -> std::size_t {
+    return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Consume size bytes, passing them to visit in place (consumer thread only)
+   *
+   * visit(const char* data, std::size_t length) is called once, or twice
+   * when the range wraps. The bytes are released to the producer afterwards.
+   * @param size Must not exceed readable()
+   */
+  template <typename Visitor>
+  void read(std::size_t size, Visitor&& visit) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    const std::size_t offset = tail & m_mask;
+    const std::size_t first = std::min(size, capacityBytes() - offset);
+    visit(static_cast<const char*>(m_data.get() + offset), first);
+    if (size > first) {
+      visit(static_cast<const char*>(m_data.get()), size - first);
+    }
+    m_tail.store(tail + size, std::memory_order_release);
+  }
+
+  /**
+   * @brief Discard everything readable (consumer thread only)
+   */
+  void clear() {
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+  [[nodiscard]] auto capacity() const -> qsizetype {
+    return static_cast<qsizetype>(capacityBytes());
+  }
+
+ private:
+  [[nodiscard]] auto capacityBytes() const -> std::size_t {
+    return m_mask + 1;
+  }
+
+  std::unique_ptr<char[]> m_data;
+  std::size_t m_mask{0};
+  alignas(64) std::atomic<std::size_t> m_head{0};  // Written by the producer only
+  alignas(64) std::atomic<std::size_t> m_tail{0};  // Written by the consumer only
+};
@@ -137,16 +137,110 @@ int main(int argc, char* argv[]) {
   Logger::instance().info(
       QString("[STARTUP] %1ms elapsed: Configuration loaded").arg(startupTimer.elapsed()));
 
+  // Logger: callers only queue records; the writer thread does the I/O
+  Logger::instance().setLevel(Logger::levelFromString(
+      ConfigService::instance().get("core.logging.level", "info").toString(),
+      Logger::Level::Info));
+  const QString logOverflow =
+      ConfigService::instance().get("core.logging.overflow", "drop").toString();
+  Logger::instance().setOverflowPolicy(logOverflow == QLatin1String("block")
+                                           ? Logger::OverflowPolicy::Block
+                                           : Logger::OverflowPolicy::Drop);
+  // "binary" keeps JSON on the console and writes the compact encoding to the file
+  const QString logFormat = ConfigService::instance().get("core.logging.format", "json").toString();
+  Logger::instance().setJsonFormat(logFormat != QLatin1String("text"));
+  Logger::instance().setBinaryFileFormat(logFormat == QLatin1String("binary"));
+  // Rotated segments are gzipped and expired in the background
+  Logger::instance().setMaxLogSize(
+      ConfigService::instance().get("core.logging.max_size_bytes", 10 * 1024 * 1024).toLongLong());
+  LogArchiver::Retention logRetention;
+  logRetention.maxFiles =
+      ConfigService::instance().get("core.logging.retention.max_files", 5).toInt();
+  logRetention.maxTotalBytes =
+      ConfigService::instance().get("core.logging.retention.max_total_bytes", 0).toLongLong();
+  logRetention.maxAgeDays =
+      ConfigService::instance().get("core.logging.retention.max_age_days", 0).toInt();
+  logRetention.compress =
+      ConfigService::instance().get("core.logging.retention.compress", true).toBool();
+  Logger::instance().setRetention(logRetention);
+  // Crash flight recorder: the last records survive a crash or OOM kill in a mapped ring
+  if (ConfigService::instance().get("core.logging.flight_recorder.enabled", true).toBool()) {
+    const QString flightPath =
+        ConfigService::instance()
+            .get("core.logging.flight_recorder.path", "/var/lib/crankshaft/flight-recorder.bin")
+            .toString();
+    const quint32 flightRecords =
+        ConfigService::instance()
+            .get("core.logging.flight_recorder.records", FlightRecorder::kDefaultSlotCount)
+            .toUInt();
+    QString flightError;
+    if (!Logger::instance().enableFlightRecorder(flightPath, flightRecords, flightError)) {
+      Logger::instance().warning(
+          QString("Flight recorder disabled (%1): %2").arg(flightError, flightPath));
+    } else if (!Logger::instance().previousFlightRecording().isEmpty()) {
+      Logger::instance().warning(
+          QString("Previous run ended abnormally; its last records are in %1 "
+                  "(crankshaft-logdecode --flight-recorder)")
+              .arg(Logger::instance().previousFlightRecording()));
+    }
+  }
+  const QString logFile = ConfigService::instance().get("core.logging.file", QString()).toString();
+  if (!logFile.isEmpty()) {
+    Logger::instance().setLogFile(logFile);
+  }
+  // Per-component levels, e.g. {"RealAndroidAutoService": "debug"}; levels can be
+  // changed at runtime through ConfigService::set() or the set_log_level command
+  Logger::instance().setComponentLevels(
+      ConfigService::instance().get("core.logging.components", QVariantMap()).toMap());
+  QObject::connect(&ConfigService::instance(), &ConfigService::configChanged,
+                   [](const QString& key, const QVariant& value) {
+                     if (key == QLatin1String("core.logging.level")) {
+                       Logger::instance().setLevel(
+                           Logger::levelFromString(value.toString(), Logger::instance().level()));
+                     } else if (key == QLatin1String("core.logging.components")) {
+                       Logger::instance().setComponentLevels(value.toMap());
+                     }
+                   });
+
   // Get port from config or command line
   quint16 port = parser.value(portOption).toUInt();
   if (port == 0) {
     port = ConfigService::instance().get("core.websocket.port", 8080).toUInt();
   }
+  // Local-only deployments can keep TCP closed and serve the UI over the Unix socket
+  if (!parser.isSet(portOption) &&
+      !ConfigService::instance().get("core.websocket.tcp_enabled", true).toBool()) {
+    port = 0;
+  }
 
   // Initialise services
   Logger::instance().info(
       QString("[STARTUP] %1ms elapsed: Initialising core services...").arg(startupTimer.elapsed()));
   EventBus::instance();  // Initialise event bus
+  // Queue events on the dispatcher thread so slow subscribers never stall publishers
+  const QString eventBusMode =
+      ConfigService::instance().get("core.eventbus.mode", "async").toString();
+  if (eventBusMode != QLatin1String("sync")) {
+    EventBus::instance().setDispatchMode(EventBus::DispatchMode::Asynchronous);
+  }
+  // High-rate state topics only ever need their latest value delivered
+  const QStringList conflatedTopics =
+      ConfigService::instance().get("core.eventbus.conflate", QStringList()).toStringList();
+  for (const QString& pattern : conflatedTopics) {
+    EventBus::instance().addConflationPattern(pattern);
+  }
+  // Safety and latency-critical topics overtake bulk traffic in the dispatcher
+  const QStringList criticalTopics =
+      ConfigService::instance().get("core.eventbus.critical", QStringList()).toStringList();
+  for (const QString& pattern : criticalTopics) {
+    EventBus::instance().addCriticalPattern(pattern);
+  }
+  // Only state topics are replayed to late subscribers
+  const QStringList retainedTopics =
+      ConfigService::instance().get("core.eventbus.retain", QStringList()).toStringList();
+  for (const QString& pattern : retainedTopics) {
+    EventBus::instance().addRetainPattern(pattern);
+  }
   Logger::instance().info(
       QString("[STARTUP] %1ms elapsed: Event bus initialised").arg(startupTimer.elapsed()));
 
@@ -171,6 +265,11 @@ int main(int argc, char* argv[]) {
   Logger::instance().info(
       QString("[STARTUP] %1ms elapsed: Creating WebSocket server...").arg(startupTimer.elapsed()));
   WebSocketServer server(port);
+  const QString localSocket =
+      ConfigService::instance().get("core.websocket.local_socket").toString();
+  if (!localSocket.isEmpty()) {
+    server.listenLocal(localSocket);
+  }
   if (!server.isListening()) {
     Logger::instance().error("Failed to start WebSocket server on port " + QString::number(port));
     return 1;
@@ -179,9 +278,52 @@ int main(int argc, char* argv[]) {
                               .arg(startupTimer.elapsed())
                               .arg(port));
 
+  // Bound per-client outbound buffering so a stalled client cannot grow memory
+  ConfigService& config = ConfigService::instance();
+  WebSocketServer::OutboundLimits outboundLimits = server.outboundLimits();
+  outboundLimits.maxMessages = config
+                                   .get("core.websocket.outbound.max_messages",
+                                        qlonglong(outboundLimits.maxMessages))
+                                   .toLongLong();
+  outboundLimits.maxBytes =
+      config.get("core.websocket.outbound.max_bytes", qlonglong(outboundLimits.maxBytes))
+          .toLongLong();
+  outboundLimits.socketBufferBytes =
+      config.get("core.websocket.outbound.socket_buffer_bytes", outboundLimits.socketBufferBytes)
+          .toLongLong();
+  outboundLimits.policy = WebSocketServer::policyFromString(
+      config.get("core.websocket.outbound.policy").toString(), outboundLimits.policy);
+  server.setOutboundLimits(outboundLimits);
+
+  // Keep one noisy client from flooding the EventBus through publish
+  WebSocketServer::InboundLimits inboundLimits = server.inboundLimits();
+  inboundLimits.messagesPerSecond =
+      config.get("core.websocket.inbound.messages_per_sec", inboundLimits.messagesPerSecond)
+          .toDouble();
+  inboundLimits.messageBurst =
+      config.get("core.websocket.inbound.message_burst", inboundLimits.messageBurst).toDouble();
+  inboundLimits.publishBytesPerSecond = config
+                                            .get("core.websocket.inbound.publish_bytes_per_sec",
+                                                 inboundLimits.publishBytesPerSecond)
+                                            .toDouble();
+  inboundLimits.publishByteBurst =
+      config.get("core.websocket.inbound.publish_byte_burst", inboundLimits.publishByteBurst)
+          .toDouble();
+  server.setInboundLimits(inboundLimits);
+  server.setDeltaResyncInterval(config.get("core.websocket.delta_resync_interval", 100).toInt());
+  server.setStatsInterval(config.get("core.websocket.stats_interval_ms", 5000).toInt());
+
+  // Reject malformed client messages against the published contract before acting on them
+  if (config.get("core.websocket.strict_validation", true).toBool()) {
+    QString schemaPath = config.get("core.websocket.message_schema").toString();
+    if (schemaPath.isEmpty()) {
+      schemaPath = MessageValidator::defaultSchemaPath();
+    }
+    server.loadMessageSchema(schemaPath);
+  }
+
   // Connect EventBus to WebSocket server (broadcasts all events)
-  QObject::connect(&EventBus::instance(), &EventBus::messagePublished, &server,
-                   &WebSocketServer::broadcastEvent);
+  server.relayEventBus(EventBus::instance());
 
   // Create ServiceManager and start services
   Logger::instance().info(QString("[STARTUP] %1ms elapsed: Initialising ServiceManager...")
@@ -199,13 +341,19 @@ int main(int argc, char* argv[]) {
   Logger::instance().info(QString("[STARTUP] %1ms elapsed: Service initialisation complete")
                               .arg(startupTimer.elapsed()));
 
-  // Initialize WebSocket connections to services (after services are started)
-  server.initializeServiceConnections();
+  // Keep client parsing and fan-out off the main event loop
+  if (config.get("core.websocket.io_thread", true).toBool()) {
+    server.startIoThread();
+  }
 
   Logger::instance().info(QString("[STARTUP] %1ms elapsed: Crankshaft Core started successfully")
                               .arg(startupTimer.elapsed()));
   Logger::instance().info(
       QString("[STARTUP] READY - Total startup time: %1ms").arg(startupTimer.elapsed()));
 
-  return app.exec();
+  const int exitCode = app.exec();
+  server.stopIoThread();
+  EventBus::instance().shutdown();
+  Logger::instance().shutdown();
+  return exitCode;
 }
@@ -26,6 +26,7 @@
 #include <QTimer>
 
 #include "../../hal/multimedia/MediaPipeline.h"
+#include "../eventbus/EventBus.h"
 #include "../logging/Logger.h"
 #include "../profile/ProfileManager.h"
 #include "MockAndroidAutoService.h"
@@ -191,7 +192,7 @@ class AndroidAutoServiceImpl : public AndroidAutoService {
     if (!isConnected()) {
       return false;
     }
-    Logger::instance().debug(
+    CRANKSHAFT_LOG_DEBUG(
         QString("[AndroidAuto] Touch input: (%1, %2) action=%3").arg(x).arg(y).arg(action));
     return true;
   }
@@ -200,7 +201,7 @@ class AndroidAutoServiceImpl : public AndroidAutoService {
     if (!isConnected()) {
       return false;
     }
-    Logger::instance().debug(
+    CRANKSHAFT_LOG_DEBUG(
         QString("[AndroidAuto] Key input: code=%1 action=%2").arg(key_code).arg(action));
     return true;
   }
@@ -273,7 +274,7 @@ class AndroidAutoServiceImpl : public AndroidAutoService {
       return;
     }
 
-    Logger::instance().debug(QString("[AndroidAuto] Found %1 USB devices").arg(device_count));
+    CRANKSHAFT_LOG_DEBUG(QString("[AndroidAuto] Found %1 USB devices").arg(device_count));
 
     libusb_free_device_list(devices, 1);
   }
@@ -291,8 +292,61 @@ class AndroidAutoServiceImpl : public AndroidAutoService {
   int latency_ms_;
 };
 
+/**
+ * @brief Publish a connection state on the service's status topic
+ */
+static void publishState(AndroidAutoService::ConnectionState state) {
+  static const QStringList stateNames = {"DISCONNECTED",   "SEARCHING", "CONNECTING",
+                                         "AUTHENTICATING", "SECURING",  "CONNECTED",
+                                         "DISCONNECTING",  "ERROR"};
+  QVariantMap payload;
+  const int index = static_cast<int>(state);
+  payload["state"] = index;
+  if (index >= 0 && index < stateNames.size()) {
+    payload["stateName"] = stateNames[index];
+  }
+  EventBus::instance().publish("android-auto/status/state-changed", payload);
+}
+
 // Base class constructor
-AndroidAutoService::AndroidAutoService(QObject* parent) : QObject(parent) {}
+AndroidAutoService::AndroidAutoService(QObject* parent) : QObject(parent) {
+  // Direct connections: publish() is thread-safe, and the AASDK implementation
+  // emits from its own thread
+  connect(this, &AndroidAutoService::connectionStateChanged, this, &publishState,
+          Qt::DirectConnection);
+  connect(
+      this, &AndroidAutoService::connected, this,
+      [](const AndroidDevice& device) {
+        QVariantMap deviceMap;
+        deviceMap["serial_number"] = device.serialNumber;
+        deviceMap["manufacturer"] = device.manufacturer;
+        deviceMap["model"] = device.model;
+        deviceMap["android_version"] = device.androidVersion;
+        deviceMap["connected"] = device.connected;
+
+        QVariantMap payload;
+        payload["device"] = deviceMap;
+        payload["connected"] = true;
+        EventBus::instance().publish("android-auto/status/connected", payload);
+      },
+      Qt::DirectConnection);
+  connect(
+      this, &AndroidAutoService::disconnected, this,
+      []() {
+        EventBus::instance().publish("android-auto/status/disconnected", {{"connected", false}});
+      },
+      Qt::DirectConnection);
+  connect(
+      this, &AndroidAutoService::errorOccurred, this,
+      [](const QString& error) {
+        EventBus::instance().publish("android-auto/status/error", {{"error", error}});
+      },
+      Qt::DirectConnection);
+}
+
+void AndroidAutoService::publishConnectionState() {
+  publishState(getConnectionState());
+}
 
 // Base class destructor
 AndroidAutoService::~AndroidAutoService() = default;
@@ -326,9 +380,12 @@ AndroidAutoService* AndroidAutoService::create(MediaPipeline* mediaPipeline,
     service = new MockAndroidAutoService(parent);
   } else {
     Logger::instance().info("Creating Real Android Auto service (AASDK)");
-    service = new RealAndroidAutoService(mediaPipeline, parent);
+    auto* real = new RealAndroidAutoService(mediaPipeline, parent);
+    real->setEventBus(&EventBus::instance());
+    service = real;
   }
 
+  service->publishConnectionState();
   return service;
 }
 
@@ -34,6 +34,15 @@ class ProfileManager;
  *
  * Handles USB connection, protocol negotiation, and screen projection
  * of Android devices using AASDK library.
+ *
+ * STATUS TOPICS:
+ *   The service owns the "android-auto/status/*" EventBus topics. The base
+ *   class publishes them from its own signals, so the mock and the AASDK
+ *   implementation share one payload schema:
+ *   - state-changed  {state: int, stateName: "CONNECTED", ...}
+ *   - connected      {device: {serial_number, manufacturer, ...}, connected: true}
+ *   - disconnected   {connected: false}
+ *   - error          {error: "..."}
  */
 class AndroidAutoService : public QObject {
   Q_OBJECT
@@ -77,6 +86,13 @@ class AndroidAutoService : public QObject {
   static AndroidAutoService* create(MediaPipeline* mediaPipeline, ProfileManager* profileManager,
                                     QObject* parent = nullptr);
 
+  /**
+   * @brief Publish the current state on "android-auto/status/state-changed"
+   *
+   * Called by create(), so the retained state exists before the first change.
+   */
+  void publishConnectionState();
+
   /**
    * @brief Configure transport settings from device configuration
    * @param settings Device settings map from ProfileManager
@@ -53,7 +53,7 @@ MockAndroidAutoService::~MockAndroidAutoService() {
 void MockAndroidAutoService::configureTransport(const QMap<QString, QVariant>& settings) {
   Q_UNUSED(settings);
   // Mock service doesn't use real transport
-  Logger::instance().debug("[MockAndroidAutoService] Transport configuration ignored (mock mode)");
+  CRANKSHAFT_LOG_DEBUG("[MockAndroidAutoService] Transport configuration ignored (mock mode)");
 }
 
 bool MockAndroidAutoService::initialise() {
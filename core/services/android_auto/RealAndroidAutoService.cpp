@@ -61,6 +61,9 @@
 #include <iomanip>
 #include <sstream>
 
+/// Per-packet audio debug logging keeps 1 record in this many
+static constexpr quint64 kAudioLogSampling = 100;
+
 /**
  * @brief Get current timestamp with millisecond precision
  * @return Timestamp string in format: YYYY-MM-DDTHH:MM:SS.mmm
@@ -152,6 +155,9 @@ void RealAndroidAutoService::configureTransport(const QMap<QString, QVariant>& s
     m_wirelessEnabled = settings.value("wireless.enabled", false).toBool();
   }
 
+  // Sizes the mixer's per-channel ring buffers
+  m_audioMixerLatencyMs = settings.value("audio.mixerLatencyMs", m_audioMixerLatencyMs).toInt();
+
   if (m_wirelessEnabled || m_transportMode == TransportMode::Wireless) {
     m_wirelessHost = settings.value("wireless.host", "").toString();
     m_wirelessPort = settings.value("wireless.port", 5277).toUInt();
@@ -452,6 +458,7 @@ void RealAndroidAutoService::setupChannels() {
           mediaConfig.volume = 0.8f;
           mediaConfig.priority = 1;
           mediaConfig.format = masterFormat;
+          mediaConfig.latencyMs = m_audioMixerLatencyMs;
           m_audioMixer->addChannel(mediaConfig);
         }
 
@@ -462,6 +469,7 @@ void RealAndroidAutoService::setupChannels() {
           systemConfig.volume = 1.0f;
           systemConfig.priority = 2;
           systemConfig.format = {16000, 1, 16};
+          systemConfig.latencyMs = m_audioMixerLatencyMs;
           m_audioMixer->addChannel(systemConfig);
         }
 
@@ -472,6 +480,7 @@ void RealAndroidAutoService::setupChannels() {
           speechConfig.volume = 1.0f;
           speechConfig.priority = 3;
           speechConfig.format = {16000, 1, 16};
+          speechConfig.latencyMs = m_audioMixerLatencyMs;
           m_audioMixer->addChannel(speechConfig);
         }
 
@@ -623,6 +632,7 @@ void RealAndroidAutoService::setupChannelsWithTransport() {
           mediaConfig.volume = 0.8f;
           mediaConfig.priority = 1;
           mediaConfig.format = masterFormat;
+          mediaConfig.latencyMs = m_audioMixerLatencyMs;
           m_audioMixer->addChannel(mediaConfig);
         }
 
@@ -633,6 +643,7 @@ void RealAndroidAutoService::setupChannelsWithTransport() {
           systemConfig.volume = 1.0f;
           systemConfig.priority = 2;
           systemConfig.format = {16000, 1, 16};
+          systemConfig.latencyMs = m_audioMixerLatencyMs;
           m_audioMixer->addChannel(systemConfig);
         }
 
@@ -643,6 +654,7 @@ void RealAndroidAutoService::setupChannelsWithTransport() {
           speechConfig.volume = 1.0f;
           speechConfig.priority = 3;
           speechConfig.format = {16000, 1, 16};
+          speechConfig.latencyMs = m_audioMixerLatencyMs;
           m_audioMixer->addChannel(speechConfig);
         }
 
@@ -990,10 +1002,10 @@ bool RealAndroidAutoService::sendTouchInput(int x, int y, int action) {
 
     m_inputChannel->sendInputReport(data, std::move(promise));
 
-    Logger::instance().debug(QString("Touch input sent: x=%1, y=%2, action=%3")
-                                 .arg(normalizedX)
-                                 .arg(normalizedY)
-                                 .arg(action));
+    CRANKSHAFT_LOG_DEBUG(QString("Touch input sent: x=%1, y=%2, action=%3")
+                             .arg(normalizedX)
+                             .arg(normalizedY)
+                             .arg(action));
 
     return true;
   } catch (const std::exception& e) {
@@ -1028,8 +1040,7 @@ bool RealAndroidAutoService::sendKeyInput(int key_code, int action) {
 
     m_inputChannel->sendInputReport(data, std::move(promise));
 
-    Logger::instance().debug(
-        QString("Key input sent: code=%1, action=%2").arg(key_code).arg(action));
+    CRANKSHAFT_LOG_DEBUG(QString("Key input sent: code=%1, action=%2").arg(key_code).arg(action));
 
     return true;
   } catch (const std::exception& e) {
@@ -1050,11 +1061,16 @@ bool RealAndroidAutoService::requestAudioFocus() {
     auto data = createAudioFocusNotification(AudioFocusState::GAIN);
 
     auto promise = aasdk::channel::SendPromise::defer(*m_strand);
-    promise->then([]() { Logger::instance().info("Audio focus granted to Android Auto"); },
-                  [](const aasdk::error::Error& error) {
-                    Logger::instance().warning(QString("Failed to request audio focus: %1")
-                                                   .arg(QString::fromStdString(error.what())));
-                  });
+    // Subscribers only see the new focus once the device has it
+    promise->then(
+        [this]() {
+          Logger::instance().info("Audio focus granted to Android Auto");
+          publishAudioFocus(true);
+        },
+        [](const aasdk::error::Error& error) {
+          Logger::instance().warning(QString("Failed to request audio focus: %1")
+                                         .arg(QString::fromStdString(error.what())));
+        });
 
     m_controlChannel->sendAudioFocusResponse(data, std::move(promise));
 
@@ -1077,11 +1093,15 @@ bool RealAndroidAutoService::abandonAudioFocus() {
     auto data = createAudioFocusNotification(AudioFocusState::LOSS);
 
     auto promise = aasdk::channel::SendPromise::defer(*m_strand);
-    promise->then([]() { Logger::instance().info("Audio focus removed from Android Auto"); },
-                  [](const aasdk::error::Error& error) {
-                    Logger::instance().warning(QString("Failed to abandon audio focus: %1")
-                                                   .arg(QString::fromStdString(error.what())));
-                  });
+    promise->then(
+        [this]() {
+          Logger::instance().info("Audio focus removed from Android Auto");
+          publishAudioFocus(false);
+        },
+        [](const aasdk::error::Error& error) {
+          Logger::instance().warning(QString("Failed to abandon audio focus: %1")
+                                         .arg(QString::fromStdString(error.what())));
+        });
 
     m_controlChannel->sendAudioFocusResponse(data, std::move(promise));
 
@@ -1092,6 +1112,16 @@ bool RealAndroidAutoService::abandonAudioFocus() {
   }
 }
 
+void RealAndroidAutoService::publishAudioFocus(bool granted) {
+  if (!m_eventBus) {
+    return;
+  }
+  // Dispatched in the bus's Critical lane (see core.eventbus.critical)
+  QVariantMap payload;
+  payload[QStringLiteral("focus")] = granted ? QStringLiteral("gain") : QStringLiteral("loss");
+  m_eventBus->publish(QStringLiteral("android-auto/audio/focus"), payload);
+}
+
 bool RealAndroidAutoService::setAudioEnabled(bool enabled) {
   m_audioEnabled = enabled;
   Logger::instance().info(QString("Audio %1").arg(enabled ? "enabled" : "disabled"));
@@ -1212,7 +1242,7 @@ void RealAndroidAutoService::checkForConnectedDevices() {
 
     if (count < 0 || !listHandle) {
       if (checkCount <= 5 || checkCount % 10 == 0) {  // Log first 5 times, then every 10th
-        Logger::instance().debug(
+        CRANKSHAFT_LOG_DEBUG(
             QString("[RealAndroidAutoService] USB device list error (check #%1)").arg(checkCount));
       }
       return;
@@ -1370,7 +1400,7 @@ void RealAndroidAutoService::checkForConnectedDevices() {
               }
               // Increment attempt counter and guard against too many attempts
               m_aoapAttempts++;
-              Logger::instance().debug(
+              CRANKSHAFT_LOG_DEBUG(
                   QString("[RealAndroidAutoService] AOAP attempt %1 started").arg(m_aoapAttempts));
             } else {
               Logger::instance().warning(
@@ -1404,8 +1434,7 @@ void RealAndroidAutoService::checkForConnectedDevices() {
       }
     }
   } catch (const std::exception& e) {
-    Logger::instance().debug(
-        QString("[RealAndroidAutoService] Device check error: %1").arg(e.what()));
+    CRANKSHAFT_LOG_DEBUG(QString("[RealAndroidAutoService] Device check error: %1").arg(e.what()));
   }
 }
 
@@ -1429,6 +1458,16 @@ void RealAndroidAutoService::onAudioData(const QByteArray& data) {
 void RealAndroidAutoService::updateStats() {
   // TODO: Implement proper stats tracking
   emit statsUpdated(m_fps, m_latency, m_droppedFrames);
+
+  // Stats are pure state: the bus conflates this topic, so only the newest
+  // sample reaches subscribers that fall behind the frame rate
+  if (m_eventBus) {
+    QVariantMap payload;
+    payload[QStringLiteral("fps")] = m_fps;
+    payload[QStringLiteral("latency")] = m_latency;
+    payload[QStringLiteral("dropped_frames")] = m_droppedFrames;
+    m_eventBus->publish(QStringLiteral("android-auto/status/stats"), payload);
+  }
 }
 
 void RealAndroidAutoService::transitionToState(ConnectionState newState) {
@@ -1483,7 +1522,8 @@ void RealAndroidAutoService::transitionToSessionState(SessionState newState) {
     }
   }
 
-  // Emit EventBus event for WebSocket subscribers
+  // Session state has its own topic; android-auto/status/* carries the
+  // connection state and is published by the base class from its signals
   if (m_eventBus) {
     QVariantMap payload;
     payload[QStringLiteral("session_id")] = m_currentSessionId;
@@ -1491,18 +1531,10 @@ void RealAndroidAutoService::transitionToSessionState(SessionState newState) {
     payload[QStringLiteral("device_id")] = m_currentDeviceId;
     payload[QStringLiteral("timestamp")] = QDateTime::currentSecsSinceEpoch();
 
-    m_eventBus->publish(QStringLiteral("android-auto/status/state-changed"), payload);
-
-    // Emit specific events for important state transitions
-    if (newState == SessionState::ACTIVE) {
-      m_eventBus->publish(QStringLiteral("android-auto/status/connected"), payload);
-      Logger::instance().info(
-          "[RealAndroidAutoService] Emitted android-auto/status/connected event");
-    } else if (newState == SessionState::ENDED || newState == SessionState::ERROR) {
-      m_eventBus->publish(QStringLiteral("android-auto/status/disconnected"), payload);
-      Logger::instance().info(
-          "[RealAndroidAutoService] Emitted android-auto/status/disconnected event");
-    }
+    m_eventBus->publish(QStringLiteral("android-auto/session/state-changed"), payload);
+    Logger::instance().info(
+        QString("[RealAndroidAutoService] Emitted android-auto/session/state-changed (%1)")
+            .arg(stateStr));
   }
 
   // Emit local signal
@@ -1590,7 +1622,7 @@ void RealAndroidAutoService::updateSessionHeartbeat() {
 
   if (m_sessionState == SessionState::ACTIVE) {
     if (!m_sessionStore->updateSessionHeartbeat(m_currentSessionId)) {
-      Logger::instance().debug(
+      CRANKSHAFT_LOG_DEBUG(
           QString("[RealAndroidAutoService] Failed to update heartbeat for session: %1")
               .arg(m_currentSessionId));
     }
@@ -1601,6 +1633,9 @@ void RealAndroidAutoService::onVideoChannelUpdate(const QByteArray& data, int wi
   if (!m_channelConfig.videoEnabled) {
     return;
   }
+  // Media callbacks run on the thread polling the io_service; drop log
+  // records rather than wait for the writer even under the Block policy
+  const Logger::RealtimeScope realtime;
 
   // H.264 video data from Android device
   if (m_videoDecoder && m_videoDecoder->isReady()) {
@@ -1627,6 +1662,7 @@ void RealAndroidAutoService::onMediaAudioChannelUpdate(const QByteArray& data) {
   if (!m_channelConfig.mediaAudioEnabled || !m_audioEnabled) {
     return;
   }
+  const Logger::RealtimeScope realtime;
 
   // PCM audio data from Android device (music playback)
   // Route to vehicle audio system via AudioRouter
@@ -1634,11 +1670,13 @@ void RealAndroidAutoService::onMediaAudioChannelUpdate(const QByteArray& data) {
 
   if (m_audioMixer) {
     m_audioMixer->mixAudioData(IAudioMixer::ChannelId::MEDIA, data);
-    Logger::instance().debug(QString("Media audio mixed: %1 bytes").arg(data.size()));
+    CRANKSHAFT_LOG_SAMPLED(Logger::Level::Debug, "RealAndroidAutoService", kAudioLogSampling,
+                           QString("Media audio mixed: %1 bytes").arg(data.size()));
   } else {
     // Fallback: emit raw audio
     emit audioDataReady(data);
-    Logger::instance().debug(QString("Media audio: %1 bytes").arg(data.size()));
+    CRANKSHAFT_LOG_SAMPLED(Logger::Level::Debug, "RealAndroidAutoService", kAudioLogSampling,
+                           QString("Media audio: %1 bytes").arg(data.size()));
   }
 }
 
@@ -1646,6 +1684,7 @@ void RealAndroidAutoService::onSystemAudioChannelUpdate(const QByteArray& data)
   if (!m_channelConfig.systemAudioEnabled || !m_audioEnabled) {
     return;
   }
+  const Logger::RealtimeScope realtime;
 
   // PCM audio data from Android device (system sounds, notifications)
   // Route to vehicle audio system via AudioRouter
@@ -1653,11 +1692,13 @@ void RealAndroidAutoService::onSystemAudioChannelUpdate(const QByteArray& data)
 
   if (m_audioMixer) {
     m_audioMixer->mixAudioData(IAudioMixer::ChannelId::SYSTEM, data);
-    Logger::instance().debug(QString("System audio mixed: %1 bytes").arg(data.size()));
+    CRANKSHAFT_LOG_SAMPLED(Logger::Level::Debug, "RealAndroidAutoService", kAudioLogSampling,
+                           QString("System audio mixed: %1 bytes").arg(data.size()));
   } else {
     // Fallback: emit raw audio
     emit audioDataReady(data);
-    Logger::instance().debug(QString("System audio: %1 bytes").arg(data.size()));
+    CRANKSHAFT_LOG_SAMPLED(Logger::Level::Debug, "RealAndroidAutoService", kAudioLogSampling,
+                           QString("System audio: %1 bytes").arg(data.size()));
   }
 }
 
@@ -1665,6 +1706,7 @@ void RealAndroidAutoService::onSpeechAudioChannelUpdate(const QByteArray& data)
   if (!m_channelConfig.speechAudioEnabled || !m_audioEnabled) {
     return;
   }
+  const Logger::RealtimeScope realtime;
 
   // PCM audio data from Android device (navigation guidance, voice assistant)
   // Route to vehicle audio system via AudioRouter with ducking support
@@ -1672,11 +1714,13 @@ void RealAndroidAutoService::onSpeechAudioChannelUpdate(const QByteArray& data)
 
   if (m_audioMixer) {
     m_audioMixer->mixAudioData(IAudioMixer::ChannelId::SPEECH, data);
-    Logger::instance().debug(QString("Speech audio mixed: %1 bytes").arg(data.size()));
+    CRANKSHAFT_LOG_SAMPLED(Logger::Level::Debug, "RealAndroidAutoService", kAudioLogSampling,
+                           QString("Speech audio mixed: %1 bytes").arg(data.size()));
   } else {
     // Fallback: emit raw audio
     emit audioDataReady(data);
-    Logger::instance().debug(QString("Speech audio: %1 bytes").arg(data.size()));
+    CRANKSHAFT_LOG_SAMPLED(Logger::Level::Debug, "RealAndroidAutoService", kAudioLogSampling,
+                           QString("Speech audio: %1 bytes").arg(data.size()));
   }
 }
 
@@ -1687,7 +1731,7 @@ void RealAndroidAutoService::onSensorRequest() {
 
   // Android device is requesting sensor data (GPS, speed, night mode, etc)
   // TODO: Implement sensor data collection and transmission
-  Logger::instance().debug("Sensor data requested by Android device");
+  CRANKSHAFT_LOG_DEBUG("Sensor data requested by Android device");
 }
 
 void RealAndroidAutoService::onBluetoothPairingRequest(const QString& deviceName) {
@@ -1707,7 +1751,7 @@ void RealAndroidAutoService::onChannelError(const QString& channelName, const QS
 
 void RealAndroidAutoService::routeMediaAudioToVehicle(const QByteArray& audioData) {
   if (!m_audioRouter) {
-    Logger::instance().debug(
+    CRANKSHAFT_LOG_DEBUG(
         "[RealAndroidAutoService] AudioRouter not initialised, skipping media audio routing");
     return;
   }
@@ -1719,7 +1763,7 @@ void RealAndroidAutoService::routeMediaAudioToVehicle(const QByteArray& audioDat
 
 void RealAndroidAutoService::routeGuidanceAudioToVehicle(const QByteArray& audioData) {
   if (!m_audioRouter) {
-    Logger::instance().debug(
+    CRANKSHAFT_LOG_DEBUG(
         "[RealAndroidAutoService] AudioRouter not initialised, skipping guidance audio routing");
     return;
   }
@@ -1734,7 +1778,7 @@ void RealAndroidAutoService::routeGuidanceAudioToVehicle(const QByteArray& audio
 
 void RealAndroidAutoService::routeSystemAudioToVehicle(const QByteArray& audioData) {
   if (!m_audioRouter) {
-    Logger::instance().debug(
+    CRANKSHAFT_LOG_DEBUG(
         "[RealAndroidAutoService] AudioRouter not initialised, skipping system audio routing");
     return;
   }
@@ -194,6 +194,7 @@ class RealAndroidAutoService : public AndroidAutoService {
   void handleConnectionEstablished();
   void handleConnectionLost();
   void updateStats();
+  void publishAudioFocus(bool granted);
   void transitionToState(ConnectionState newState);
   void startUSBHubDetection();
 
@@ -298,6 +299,7 @@ class RealAndroidAutoService : public AndroidAutoService {
   // Multimedia components
   IVideoDecoder* m_videoDecoder{nullptr};
   IAudioMixer* m_audioMixer{nullptr};
+  int m_audioMixerLatencyMs{100};  // Per-channel mixer buffering ("audio.mixerLatencyMs")
 
   bool m_isInitialised{false};
 };
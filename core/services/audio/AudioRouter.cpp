@@ -68,9 +68,9 @@ bool AudioRouter::initialize() {
       QString::asprintf("[AudioRouter] Found %lu audio output devices", devices.size()));
 
   for (const auto& device : devices) {
-    Logger::instance().debug(QStringLiteral("[AudioRouter] Device: %1 (%2 channels)")
-                                 .arg(device.description())
-                                 .arg(device.maximumChannelCount()));
+    CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] Device: %1 (%2 channels)")
+                             .arg(device.description())
+                             .arg(device.maximumChannelCount()));
   }
 
   m_initialized = true;
@@ -85,7 +85,7 @@ bool AudioRouter::initializePipeWire() {
   pwProcess.start();
 
   if (!pwProcess.waitForStarted(1000)) {
-    Logger::instance().debug(QStringLiteral("[AudioRouter] PipeWire not available"));
+    CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] PipeWire not available"));
     return false;
   }
 
@@ -93,7 +93,7 @@ bool AudioRouter::initializePipeWire() {
   const int exitCode = pwProcess.exitCode();
 
   if (!finished || exitCode != 0) {
-    Logger::instance().debug(QStringLiteral("[AudioRouter] PipeWire daemon not running"));
+    CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] PipeWire daemon not running"));
     return false;
   }
 
@@ -108,7 +108,7 @@ bool AudioRouter::initializePulseAudio() {
   paProcess.start();
 
   if (!paProcess.waitForStarted(1000)) {
-    Logger::instance().debug(QStringLiteral("[AudioRouter] PulseAudio not available"));
+    CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] PulseAudio not available"));
     return false;
   }
 
@@ -116,7 +116,7 @@ bool AudioRouter::initializePulseAudio() {
   const int exitCode = paProcess.exitCode();
 
   if (!finished || exitCode != 0) {
-    Logger::instance().debug(QStringLiteral("[AudioRouter] PulseAudio daemon not running"));
+    CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] PulseAudio daemon not running"));
     return false;
   }
 
@@ -130,7 +130,7 @@ bool AudioRouter::routeAudioFrame(AAudioStreamRole role, const QByteArray& audio
   }
 
   if (audioData.isEmpty()) {
-    Logger::instance().debug(QStringLiteral("[AudioRouter] Empty audio data"));
+    CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] Empty audio data"));
     return false;
   }
 
@@ -245,9 +245,9 @@ bool AudioRouter::setStreamVolume(AAudioStreamRole role, int volume) {
     m_mediaPipeline->audioHAL()->setVolume(volume);
   }
 
-  Logger::instance().debug(QStringLiteral("[AudioRouter] Set volume for role %1: %2%")
-                               .arg(static_cast<int>(role))
-                               .arg(volume));
+  CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] Set volume for role %1: %2%")
+                           .arg(static_cast<int>(role))
+                           .arg(volume));
 
   emit volumeChanged(role, volume);
   return true;
@@ -273,9 +273,9 @@ bool AudioRouter::setStreamMuted(AAudioStreamRole role, bool muted) {
     m_mediaPipeline->audioHAL()->setMute(muted);
   }
 
-  Logger::instance().debug(QStringLiteral("[AudioRouter] %1 audio for role %2")
-                               .arg(muted ? QStringLiteral("Muted") : QStringLiteral("Unmuted"))
-                               .arg(static_cast<int>(role)));
+  CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] %1 audio for role %2")
+                           .arg(muted ? QStringLiteral("Muted") : QStringLiteral("Unmuted"))
+                           .arg(static_cast<int>(role)));
 
   return true;
 }
@@ -337,9 +337,9 @@ void AudioRouter::onAudioDevicesChanged() {
 
 void AudioRouter::onPipelineStateChanged(bool isActive) {
   if (isActive) {
-    Logger::instance().debug(QStringLiteral("[AudioRouter] Media pipeline started"));
+    CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] Media pipeline started"));
   } else {
-    Logger::instance().debug(QStringLiteral("[AudioRouter] Media pipeline stopped"));
+    CRANKSHAFT_LOG_DEBUG(QStringLiteral("[AudioRouter] Media pipeline stopped"));
   }
 }
 
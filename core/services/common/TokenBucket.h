@@ -0,0 +1,85 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QtGlobal>
+#include <algorithm>
+
+/**
+ * @class TokenBucket
+ * @brief Rate limiter that allows bursts up to a fixed capacity
+ *
+ * The bucket refills continuously at rate() tokens per second up to
+ * burst(). tryConsume() takes the caller's monotonic time, so a bucket
+ * costs two doubles and a timestamp and never reads a clock itself.
+ * A rate of 0 disables limiting.
+ *
+ * A single cost larger than burst() can never be admitted, so the burst
+ * also acts as the largest accepted unit.
+ *
+ * THREAD SAFETY:
+ * - Not thread-safe; each bucket belongs to one owner thread
+ */
+class TokenBucket {
+ public:
+  TokenBucket() = default;
+
+  /**
+   * @param ratePerSecond Sustained refill rate; 0 or less disables limiting
+   * @param burst Capacity (tokens available after an idle period)
+   */
+  TokenBucket(double ratePerSecond, double burst)
+      : m_rate(ratePerSecond), m_burst(std::max(burst, 1.0)), m_tokens(m_burst) {}
+
+  /**
+   * @brief Take cost tokens if available
+   * @param cost Tokens to take (e.g. 1 per message, or a byte count)
+   * @param nowNs Monotonic time in nanoseconds
+   * @return false if the bucket holds fewer than cost tokens (nothing is taken)
+   */
+  auto tryConsume(double cost, qint64 nowNs) -> bool {
+    if (m_rate <= 0.0) {
+      return true;
+    }
+    if (m_lastNs >= 0 && nowNs > m_lastNs) {
+      m_tokens = std::min(m_burst, m_tokens + m_rate * static_cast<double>(nowNs - m_lastNs) / 1e9);
+    }
+    m_lastNs = nowNs;
+    if (m_tokens < cost) {
+      return false;
+    }
+    m_tokens -= cost;
+    return true;
+  }
+
+  [[nodiscard]] auto rate() const -> double {
+    return m_rate;
+  }
+
+  [[nodiscard]] auto burst() const -> double {
+    return m_burst;
+  }
+
+ private:
+  double m_rate{0.0};
+  double m_burst{1.0};
+  double m_tokens{1.0};
+  qint64 m_lastNs{-1};
+};
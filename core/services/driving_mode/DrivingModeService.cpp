@@ -22,8 +22,21 @@
 #include <QDebug>
 #include <algorithm>
 
+#include "../eventbus/EventBus.h"
+
 DrivingModeService::DrivingModeService(QObject *parent)
-    : QObject(parent), m_isDrivingMode(false), m_vehicleSpeedMph(0.0f), m_isRestricted(false) {}
+    : QObject(parent), m_isDrivingMode(false), m_vehicleSpeedMph(0.0f), m_isRestricted(false) {
+  // Mirror restriction state onto the bus; "driving-mode/#" is a critical lane topic
+  connect(this, &DrivingModeService::drivingModeChanged, this, [](bool isDriving) {
+    EventBus::instance().publish(QStringLiteral("driving-mode/state-changed"),
+                                 {{QStringLiteral("driving"), isDriving}});
+  });
+  connect(this, &DrivingModeService::restrictionChanged, this, [this](bool isRestricted) {
+    EventBus::instance().publish(QStringLiteral("driving-mode/restriction-changed"),
+                                 {{QStringLiteral("restricted"), isRestricted},
+                                  {QStringLiteral("reason"), m_restrictionReason}});
+  });
+}
 
 void DrivingModeService::onVehicleSpeedUpdated(float speedMph) {
   // Update speed
@@ -0,0 +1,119 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Event.h"
+
+#include <QCborMap>
+#include <QCborValue>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSharedData>
+#include <mutex>
+
+class EventData : public QSharedData {
+ public:
+  EventData(const QString& eventTopic, const QVariantMap& eventPayload)
+      : topic(eventTopic),
+        payload(eventPayload),
+        timestampMs(QDateTime::currentMSecsSinceEpoch()) {}
+
+  EventData(const EventData&) = delete;
+  EventData& operator=(const EventData&) = delete;
+
+  const QString topic;
+  const QVariantMap payload;
+  const qint64 timestampMs;
+
+  // Lazily encoded wire forms; logically const, hence mutable
+  mutable std::once_flag jsonOnce;
+  mutable QByteArray json;
+  mutable std::once_flag textOnce;
+  mutable QString text;
+  mutable std::once_flag cborOnce;
+  mutable QByteArray cbor;
+};
+
+Event::Event() = default;
+
+Event::Event(const QString& topic, const QVariantMap& payload)
+    : d(new EventData(topic, payload)) {}
+
+Event::~Event() = default;
+Event::Event(const Event& other) = default;
+Event::Event(Event&& other) noexcept = default;
+Event& Event::operator=(const Event& other) = default;
+Event& Event::operator=(Event&& other) noexcept = default;
+
+bool Event::isNull() const {
+  return !d;
+}
+
+QString Event::topic() const {
+  return d ? d->topic : QString();
+}
+
+QVariantMap Event::payload() const {
+  return d ? d->payload : QVariantMap();
+}
+
+qint64 Event::timestampMs() const {
+  return d ? d->timestampMs : 0;
+}
+
+QByteArray Event::toJson() const {
+  if (!d) {
+    return {};
+  }
+
+  std::call_once(d->jsonOnce, [this]() {
+    QJsonObject envelope;
+    envelope["type"] = QStringLiteral("event");
+    envelope["topic"] = d->topic;
+    envelope["payload"] = QJsonObject::fromVariantMap(d->payload);
+    envelope["timestamp"] = d->timestampMs / 1000;
+    d->json = QJsonDocument(envelope).toJson(QJsonDocument::Compact);
+  });
+  return d->json;
+}
+
+QString Event::toJsonText() const {
+  if (!d) {
+    return {};
+  }
+
+  std::call_once(d->textOnce, [this]() { d->text = QString::fromUtf8(toJson()); });
+  return d->text;
+}
+
+QByteArray Event::toCbor() const {
+  if (!d) {
+    return {};
+  }
+
+  std::call_once(d->cborOnce, [this]() {
+    QCborMap envelope;
+    envelope[QStringLiteral("type")] = QStringLiteral("event");
+    envelope[QStringLiteral("topic")] = d->topic;
+    envelope[QStringLiteral("payload")] = QCborMap::fromVariantMap(d->payload);
+    envelope[QStringLiteral("timestamp")] = d->timestampMs / 1000;
+    d->cbor = envelope.toCborValue().toCbor();
+  });
+  return d->cbor;
+}
@@ -0,0 +1,89 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QExplicitlySharedDataPointer>
+#include <QMetaType>
+#include <QString>
+#include <QVariantMap>
+
+class EventData;
+
+/**
+ * @class Event
+ * @brief Immutable, implicitly shared event published on the EventBus
+ *
+ * An Event is built once by EventBus::publish() and then handed to every
+ * subscriber by reference count rather than by copying the payload. The
+ * wire encodings used by the WebSocket relay are produced lazily, at most
+ * once per event, and cached inside the shared data, so N clients and M
+ * in-process consumers share a single QJsonObject/CBOR conversion.
+ *
+ * WIRE ENVELOPE (toJson / toCbor):
+ *   {"type":"event","topic":"<topic>","payload":{...},"timestamp":<secs>}
+ *
+ * THREAD SAFETY:
+ * - Copying and reading an Event is safe from any thread
+ * - toJson()/toJsonText()/toCbor() may race; the first caller encodes, others wait
+ */
+class Event {
+ public:
+  /// Construct a null event
+  Event();
+  /**
+   * @brief Construct an event stamped with the current time
+   * @param topic Event topic ("service/event_name")
+   * @param payload JSON-compatible event data
+   */
+  Event(const QString& topic, const QVariantMap& payload);
+  ~Event();
+
+  Event(const Event& other);
+  Event(Event&& other) noexcept;
+  auto operator=(const Event& other) -> Event&;
+  auto operator=(Event&& other) noexcept -> Event&;
+
+  [[nodiscard]] auto isNull() const -> bool;
+  [[nodiscard]] auto topic() const -> QString;
+  [[nodiscard]] auto payload() const -> QVariantMap;
+  /// Publish time in milliseconds since epoch
+  [[nodiscard]] auto timestampMs() const -> qint64;
+
+  /**
+   * @brief Compact UTF-8 JSON wire envelope (encoded once, then cached)
+   */
+  [[nodiscard]] auto toJson() const -> QByteArray;
+
+  /**
+   * @brief toJson() decoded to a QString for text frames (decoded once, then cached)
+   */
+  [[nodiscard]] auto toJsonText() const -> QString;
+
+  /**
+   * @brief CBOR wire envelope with the same schema as toJson() (cached)
+   */
+  [[nodiscard]] auto toCbor() const -> QByteArray;
+
+ private:
+  QExplicitlySharedDataPointer<const EventData> d;
+};
+
+Q_DECLARE_METATYPE(Event)
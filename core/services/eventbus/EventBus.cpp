@@ -19,7 +19,20 @@
 
 #include "EventBus.h"
 
+#include <QMetaObject>
 #include <QMutexLocker>
+#include <QThread>
+#include <QtDebug>
+#include <algorithm>
+#include <chrono>
+
+#include "ThreadMailbox.h"
+
+/// Two-lane mailbox drained in one subscriber thread
+class EventBus::ThreadInbox : public QObject {
+ public:
+  ThreadMailbox mailbox{this};
+};
 
 /**
  * @brief Get or create singleton instance (thread-safe)
@@ -38,18 +51,161 @@ EventBus& EventBus::instance() {
   return instance;
 }
 
+EventBus::~EventBus() {
+  shutdown();
+}
+
+/**
+ * @brief Switch between synchronous and queued delivery
+ *
+ * Asynchronous mode spins up a single "EventBusDispatcher" thread with a
+ * plain QObject living in it. publish() posts drainQueue() to that object, so
+ * all emission happens on the dispatcher thread in FIFO order. Subscribers
+ * whose objects live elsewhere are then reached via queued connections, i.e.
+ * on their own threads, without the publisher ever waiting for them.
+ *
+ * @param mode Requested dispatch mode
+ */
+void EventBus::setDispatchMode(DispatchMode mode) {
+  if (mode == m_mode.load()) {
+    return;
+  }
+
+  if (mode == DispatchMode::Asynchronous) {
+    m_dispatchThread = new QThread();
+    m_dispatchThread->setObjectName(QStringLiteral("EventBusDispatcher"));
+    auto* context = new QObject();
+    context->moveToThread(m_dispatchThread);
+    m_dispatchContext.store(context);
+    m_dispatchThread->start();
+    m_mode.store(DispatchMode::Asynchronous);
+    return;
+  }
+
+  shutdown();
+}
+
+EventBus::DispatchMode EventBus::dispatchMode() const {
+  return m_mode.load();
+}
+
+qsizetype EventBus::pendingEvents() const {
+  qsizetype pending = 0;
+  for (const Lane& lane : m_lanes) {
+    pending += lane.queue.sizeApprox();
+  }
+  return pending;
+}
+
+void EventBus::addCriticalPattern(const QString& pattern) {
+  QMutexLocker locker(&m_priorityMutex);
+  if (m_criticalPatterns.contains(pattern)) {
+    return;
+  }
+  if (!m_criticalIndex.insert(pattern, pattern)) {
+    qWarning() << "[EventBus] Invalid critical topic pattern:" << pattern;
+    return;
+  }
+  m_criticalPatterns.insert(pattern);
+  m_priorityCache.clear();
+  m_hasCriticalPatterns.store(true, std::memory_order_release);
+}
+
+void EventBus::removeCriticalPattern(const QString& pattern) {
+  QMutexLocker locker(&m_priorityMutex);
+  if (!m_criticalPatterns.remove(pattern)) {
+    return;
+  }
+  m_criticalIndex.remove(pattern, pattern);
+  m_priorityCache.clear();
+  m_hasCriticalPatterns.store(!m_criticalPatterns.isEmpty(), std::memory_order_release);
+}
+
+/**
+ * @brief Classify a topic into a lane
+ *
+ * Cached per topic like subscriber resolution, so steady-state cost is one
+ * short critical section and a hash lookup. Skipped entirely while no
+ * critical pattern is configured.
+ */
+EventBus::Priority EventBus::priorityFor(const QString& topic) const {
+  if (!m_hasCriticalPatterns.load(std::memory_order_acquire)) {
+    return Priority::Normal;
+  }
+
+  QMutexLocker locker(&m_priorityMutex);
+  const auto cached = m_priorityCache.constFind(topic);
+  if (cached != m_priorityCache.constEnd()) {
+    return cached.value();
+  }
+
+  Priority priority = Priority::Normal;
+  m_criticalIndex.match(topic, [&priority](const QString&) { priority = Priority::Critical; });
+  if (m_priorityCache.size() >= kMaxClassifiedTopics) {
+    m_priorityCache.clear();
+  }
+  m_priorityCache.insert(topic, priority);
+  return priority;
+}
+
+EventBus::LaneStats EventBus::laneStats(Priority priority) const {
+  const Lane& lane = m_lanes[static_cast<int>(priority)];
+  LaneStats stats;
+  stats.queueDepth = lane.queue.sizeApprox();
+  stats.dispatched = lane.dispatched.load(std::memory_order_acquire);
+  stats.delivered = lane.delivered.load(std::memory_order_relaxed);
+  stats.lastLatencyUs = lane.lastLatencyNs.load(std::memory_order_relaxed) / 1000;
+  stats.maxLatencyUs = lane.maxLatencyNs.load(std::memory_order_relaxed) / 1000;
+  if (stats.delivered > 0) {
+    stats.averageLatencyUs = lane.totalLatencyNs.load(std::memory_order_relaxed) /
+                             static_cast<qint64>(stats.delivered) / 1000;
+  }
+  return stats;
+}
+
+/**
+ * @brief Stop the dispatcher thread and deliver anything still queued
+ *
+ * The dispatcher is stopped before switching mode so the lanes never have
+ * two consumers. Events published concurrently with shutdown() are not
+ * lost: once the mode is Synchronous, the next synchronous publish()
+ * flushes leftovers first.
+ */
+void EventBus::shutdown() {
+  if (m_dispatchThread) {
+    QObject* context = m_dispatchContext.exchange(nullptr);
+    m_dispatchThread->quit();
+    m_dispatchThread->wait();
+    delete context;
+    delete m_dispatchThread;
+    m_dispatchThread = nullptr;
+  }
+  m_mode.store(DispatchMode::Synchronous);
+
+  QMutexLocker locker(&m_mutex);
+  m_drainScheduled.store(false);
+  flushLanes();
+}
+
 /**
  * @brief Publish an event to all subscribers (thread-safe)
  *
  * Acquires mutex lock, then emits signal to all connected subscribers.
  * Subscribers receive call via Qt signal/slot mechanism.
  *
- * IMPLEMENTATION DETAILS:
+ * IMPLEMENTATION DETAILS (Synchronous mode):
  * 1. Acquire QMutexLocker (RAII, exception-safe)
  * 2. Emit messagePublished signal
  * 3. All connected slots called (synchronously in this thread)
  * 4. Lock released when QMutexLocker goes out of scope
  *
+ * IMPLEMENTATION DETAILS (Asynchronous mode):
+ * 1. Classify the topic (Critical or Normal lane)
+ * 2. Push the Event onto that lane's lock-free MPSC queue
+ * 3. Post a drain request to the dispatcher thread if none is outstanding
+ * 4. Return; the dispatcher emits messagePublished later, Critical lane
+ *    first and FIFO within each lane
+ *
  * PERFORMANCE:
  * - Lock time: negligible (~1 microsecond)
  * - Signal emission: depends on number of subscribers
@@ -106,11 +262,463 @@ EventBus& EventBus::instance() {
  *                Should include context (IDs, names) for filtering
  *
  * @note Thread-safe: may be called from any thread without synchronisation
- * @note Blocks calling thread briefly (only lock/signal time)
- * @note All subscribers are called synchronously in the same thread
- *       If cross-thread notification needed, use Qt::QueuedConnection
+ * @note Synchronous mode: blocks calling thread for lock/signal time and all
+ *       direct subscribers are called in the same thread
+ * @note Asynchronous mode: never blocks; see setDispatchMode()
  */
 void EventBus::publish(const QString& topic, const QVariantMap& payload) {
+  publish(Event(topic, payload));
+}
+
+void EventBus::publish(const Event& event) {
+  if (event.isNull()) {
+    return;
+  }
+
+  Lane& lane = m_lanes[static_cast<int>(priorityFor(event.topic()))];
+  const QueuedEvent queued{event, monotonicNs()};
+
+  if (m_mode.load(std::memory_order_acquire) == DispatchMode::Asynchronous) {
+    lane.queue.push(queued);
+    scheduleDrain();
+    return;
+  }
+
   QMutexLocker locker(&m_mutex);
-  emit messagePublished(topic, payload);
+  // Deliver anything left behind by a mode switch first to keep FIFO order
+  flushLanes();
+  dispatchQueued(lane, queued);
+}
+
+/**
+ * @brief Wake the dispatcher thread (at most one outstanding request)
+ *
+ * Must be called after the push has completed: drainQueue() clears the flag
+ * before popping, so either it observes the new node or this call posts a
+ * fresh drain request.
+ */
+void EventBus::scheduleDrain() {
+  if (m_drainScheduled.exchange(true)) {
+    return;
+  }
+
+  QObject* context = m_dispatchContext.load();
+  if (!context) {
+    // Racing shutdown(); the next synchronous publish() flushes the queue
+    return;
+  }
+  QMetaObject::invokeMethod(context, [this]() { drainQueue(); }, Qt::QueuedConnection);
+}
+
+void EventBus::drainQueue() {
+  m_drainScheduled.store(false);
+  flushLanes();
+}
+
+void EventBus::flushLanes() {
+  QueuedEvent queued;
+  while (Lane* lane = popNext(queued)) {
+    dispatchQueued(*lane, queued);
+  }
+}
+
+/**
+ * @brief Take the next event, re-checking the Critical lane every time
+ *
+ * Looking at higher lanes before each pop (rather than draining a lane at a
+ * time) lets a critical event overtake a long Normal backlog.
+ */
+EventBus::Lane* EventBus::popNext(QueuedEvent& out) {
+  for (Lane& lane : m_lanes) {
+    if (lane.queue.tryPop(out)) {
+      return &lane;
+    }
+  }
+  return nullptr;
+}
+
+void EventBus::dispatchQueued(Lane& lane, const QueuedEvent& queued) {
+  dispatch(lane, queued);
+  // Counted once every delivery is handed over (or made, for same-thread ones)
+  lane.dispatched.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Record publish() → handler latency, taken as the handler starts
+ *
+ * Measured in the subscriber's thread rather than at dequeue, so time spent
+ * waiting in the receiver's own event queue is included.
+ */
+void EventBus::recordLatency(Lane* lane, qint64 enqueuedNs) {
+  if (!lane) {
+    return;
+  }
+  const qint64 latencyNs = monotonicNs() - enqueuedNs;
+  lane->delivered.fetch_add(1, std::memory_order_relaxed);
+  lane->totalLatencyNs.fetch_add(latencyNs, std::memory_order_relaxed);
+  lane->lastLatencyNs.store(latencyNs, std::memory_order_relaxed);
+  qint64 worst = lane->maxLatencyNs.load(std::memory_order_relaxed);
+  while (latencyNs > worst &&
+         !lane->maxLatencyNs.compare_exchange_weak(worst, latencyNs, std::memory_order_relaxed)) {
+  }
+}
+
+qint64 EventBus::monotonicNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Register a pattern subscription
+ *
+ * The pattern is validated and inserted into the topic trie here, once, so
+ * publishing never re-parses wildcards. The per-topic resolution cache is
+ * invalidated because any cached topic may now gain a subscriber.
+ */
+EventBus::SubscriptionId EventBus::subscribe(const QString& pattern, QObject* receiver,
+                                             Handler handler, Replay replay) {
+  if (!handler) {
+    return subscribe(pattern, receiver, EventHandler(), replay);
+  }
+  return subscribe(
+      pattern, receiver,
+      [handler = std::move(handler)](const Event& event) {
+        handler(event.topic(), event.payload());
+      },
+      replay);
+}
+
+EventBus::SubscriptionId EventBus::subscribe(const QString& pattern, QObject* receiver,
+                                             EventHandler handler, Replay replay) {
+  if (!receiver || !handler) {
+    qWarning() << "[EventBus] subscribe() requires a receiver and a handler";
+    return 0;
+  }
+
+  auto subscription = QSharedPointer<Subscription>::create();
+  subscription->pattern = pattern;
+  subscription->receiver = receiver;
+  subscription->handler = std::move(handler);
+  subscription->conflation = QSharedPointer<ConflationSlots>::create();
+
+  // Snapshot taken under the same lock that registers the subscription, so
+  // any later value is delivered live rather than missed. Replays to another
+  // thread are queued before the lock is released, so they reach the
+  // receiver ahead of any newer live value; same-thread replays run after it,
+  // since a live value can only reach this thread through a later queued call.
+  QList<Event> retained;
+  {
+    QMutexLocker locker(&m_registryMutex);
+    subscription->id = m_nextSubscriptionId;
+    if (!m_subscriptionIndex.insert(pattern, subscription->id)) {
+      qWarning() << "[EventBus] Invalid subscription pattern:" << pattern;
+      return 0;
+    }
+    ++m_nextSubscriptionId;
+    m_subscriptions.insert(subscription->id, subscription);
+    m_resolvedTopics.clear();
+    if (replay == Replay::Retained) {
+      retained = collectRetained(pattern);
+      if (receiver->thread() != QThread::currentThread()) {
+        for (const Event& event : std::as_const(retained)) {
+          deliver(subscription, event, false);
+        }
+        retained.clear();
+      }
+    }
+  }
+
+  const SubscriptionId id = subscription->id;
+  connect(receiver, &QObject::destroyed, this, [this, id]() { unsubscribe(id); },
+          Qt::DirectConnection);
+
+  for (const Event& event : std::as_const(retained)) {
+    deliver(subscription, event, false);
+  }
+  return id;
+}
+
+void EventBus::unsubscribe(SubscriptionId id) {
+  QMutexLocker locker(&m_registryMutex);
+  const SubscriptionPtr subscription = m_subscriptions.take(id);
+  if (!subscription) {
+    return;
+  }
+  m_subscriptionIndex.remove(subscription->pattern, id);
+  m_resolvedTopics.clear();
+}
+
+qsizetype EventBus::subscriptionCount() const {
+  QMutexLocker locker(&m_registryMutex);
+  return m_subscriptions.size();
+}
+
+void EventBus::dispatch(Lane& lane, const QueuedEvent& queued) {
+  const Event& event = queued.event;
+  const QString topic = event.topic();
+  emit messagePublished(topic, event.payload());
+  emit eventPublished(event);
+
+  const TopicRoute route = routeEvent(event);
+  for (const SubscriptionPtr& subscription : route.subscribers) {
+    deliver(subscription, event, route.conflated, &lane, queued.enqueuedNs);
+  }
+}
+
+/**
+ * @brief Retain an event and resolve its subscribers, using the per-topic cache
+ *
+ * Topics are a small, mostly static set, so after the first event on a topic
+ * dispatch is a single hash lookup returning an implicitly shared list.
+ * Retaining happens under the same lock so subscribe(Replay::Retained) sees
+ * each value either in its snapshot or as a live delivery.
+ */
+EventBus::TopicRoute EventBus::routeEvent(const Event& event) {
+  const QString topic = event.topic();
+  QMutexLocker locker(&m_registryMutex);
+
+  TopicRoute route;
+  const auto cached = m_resolvedTopics.constFind(topic);
+  if (cached != m_resolvedTopics.constEnd()) {
+    route = cached.value();
+  } else {
+    m_subscriptionIndex.match(topic, [this, &route](SubscriptionId id) {
+      route.subscribers.append(m_subscriptions.value(id));
+    });
+    m_conflationIndex.match(topic, [&route](const QString&) { route.conflated = true; });
+    m_retainIndex.match(topic, [&route](const QString&) { route.retained = true; });
+
+    if (m_resolvedTopics.size() >= kMaxResolvedTopics) {
+      m_resolvedTopics.clear();
+    }
+    m_resolvedTopics.insert(topic, route);
+  }
+
+  if (route.retained) {
+    auto retained = m_retained.find(topic);
+    if (retained != m_retained.end()) {
+      *retained = event;
+    } else if (m_retained.size() < kMaxRetainedTopics) {
+      m_retained.insert(topic, event);
+    } else if (!m_retainedOverflowReported) {
+      m_retainedOverflowReported = true;
+      qWarning() << "[EventBus] Retained topic limit reached; not retaining" << topic;
+    }
+  }
+  return route;
+}
+
+/**
+ * @brief Deliver an event to one subscriber on the subscriber's thread
+ *
+ * For conflated topics crossing threads, at most one invocation per topic is
+ * outstanding per subscriber: later events overwrite the pending value and
+ * the queued call picks up whatever is newest when it finally runs.
+ *
+ * Cross-thread calls go through the receiver thread's inbox rather than one
+ * posted event each. Critical-lane events take its high-priority queue, so
+ * they also overtake Normal deliveries already waiting in the receiver's
+ * thread, not just those still in the dispatcher's lanes.
+ *
+ * @param lane Lane the event came from; nullptr for retained replays
+ */
+void EventBus::deliver(const SubscriptionPtr& subscription, const Event& event, bool conflated,
+                       Lane* lane, qint64 enqueuedNs) {
+  QObject* receiver = subscription->receiver.data();
+  if (!receiver) {
+    return;
+  }
+
+  if (receiver->thread() == QThread::currentThread()) {
+    recordLatency(lane, enqueuedNs);
+    subscription->handler(event);
+    return;
+  }
+
+  // Replays take their topic's lane too, so a live Critical value queued
+  // after a replay cannot overtake it
+  const bool critical = lane ? lane == &m_lanes[static_cast<int>(Priority::Critical)]
+                             : priorityFor(event.topic()) == Priority::Critical;
+  const Qt::EventPriority priority = critical ? Qt::HighEventPriority : Qt::NormalEventPriority;
+
+  if (!conflated) {
+    // Only the shared Event handle is copied into the queued call
+    postToThread(
+        receiver->thread(),
+        [subscription, event, lane, enqueuedNs]() {
+          if (subscription->receiver) {
+            recordLatency(lane, enqueuedNs);
+            subscription->handler(event);
+          }
+        },
+        priority);
+    return;
+  }
+
+  const QString topic = event.topic();
+  ConflationSlots* slots = subscription->conflation.data();
+  {
+    QMutexLocker locker(&slots->mutex);
+    auto pending = slots->pending.find(topic);
+    if (pending != slots->pending.end()) {
+      *pending = event;
+      locker.unlock();
+      recordConflated(topic);
+      return;
+    }
+    slots->pending.insert(topic, event);
+  }
+
+  // Latency is that of the event which scheduled the call: it waited longest
+  postToThread(
+      receiver->thread(),
+      [subscription, topic, lane, enqueuedNs]() {
+        Event latest;
+        {
+          QMutexLocker locker(&subscription->conflation->mutex);
+          latest = subscription->conflation->pending.take(topic);
+        }
+        if (!latest.isNull() && subscription->receiver) {
+          recordLatency(lane, enqueuedNs);
+          subscription->handler(latest);
+        }
+      },
+      priority);
+}
+
+/**
+ * @brief Queue a call on the inbox of a subscriber thread
+ *
+ * One inbox per thread, created on first use. It is removed under the same
+ * lock when the thread finishes, so nothing is posted to a deleted inbox.
+ */
+void EventBus::postToThread(QThread* thread, std::function<void()> call,
+                            Qt::EventPriority priority) {
+  QMutexLocker locker(&m_inboxMutex);
+  ThreadInbox*& inbox = m_inboxes[thread];
+  if (!inbox) {
+    inbox = new ThreadInbox();
+    inbox->moveToThread(thread);
+    // Emitted in the finishing thread itself, before its deferred deletes run
+    connect(
+        thread, &QThread::finished, inbox,
+        [this, thread]() {
+          QMutexLocker lock(&m_inboxMutex);
+          m_inboxes.take(thread)->deleteLater();
+        },
+        Qt::DirectConnection);
+  }
+  inbox->mailbox.post(std::move(call), priority);
+}
+
+void EventBus::addConflationPattern(const QString& pattern) {
+  QMutexLocker locker(&m_registryMutex);
+  if (m_conflationPatterns.contains(pattern)) {
+    return;
+  }
+  if (!m_conflationIndex.insert(pattern, pattern)) {
+    qWarning() << "[EventBus] Invalid conflation pattern:" << pattern;
+    return;
+  }
+  m_conflationPatterns.insert(pattern);
+  m_resolvedTopics.clear();
+}
+
+void EventBus::removeConflationPattern(const QString& pattern) {
+  QMutexLocker locker(&m_registryMutex);
+  if (!m_conflationPatterns.remove(pattern)) {
+    return;
+  }
+  m_conflationIndex.remove(pattern, pattern);
+  m_resolvedTopics.clear();
+}
+
+quint64 EventBus::conflatedEventCount() const {
+  return m_conflatedTotal.load(std::memory_order_relaxed);
+}
+
+QHash<QString, quint64> EventBus::conflatedEventCounts() const {
+  QMutexLocker locker(&m_statsMutex);
+  return m_conflatedByTopic;
+}
+
+void EventBus::addRetainPattern(const QString& pattern) {
+  QMutexLocker locker(&m_registryMutex);
+  if (m_retainPatterns.contains(pattern)) {
+    return;
+  }
+  if (!m_retainIndex.insert(pattern, pattern)) {
+    qWarning() << "[EventBus] Invalid retain pattern:" << pattern;
+    return;
+  }
+  m_retainPatterns.insert(pattern);
+  m_resolvedTopics.clear();
+}
+
+void EventBus::removeRetainPattern(const QString& pattern) {
+  QMutexLocker locker(&m_registryMutex);
+  if (!m_retainPatterns.remove(pattern)) {
+    return;
+  }
+  m_retainIndex.remove(pattern, pattern);
+  m_resolvedTopics.clear();
+}
+
+Event EventBus::retainedEvent(const QString& topic) const {
+  QMutexLocker locker(&m_registryMutex);
+  return m_retained.value(topic);
+}
+
+QList<Event> EventBus::retainedEvents(const QString& pattern) const {
+  QMutexLocker locker(&m_registryMutex);
+  return collectRetained(pattern);
+}
+
+void EventBus::clearRetained(const QString& pattern) {
+  QMutexLocker locker(&m_registryMutex);
+  const QList<Event> matching = collectRetained(pattern);
+  for (const Event& event : matching) {
+    m_retained.remove(event.topic());
+  }
+  m_retainedOverflowReported = false;
+}
+
+qsizetype EventBus::retainedTopicCount() const {
+  QMutexLocker locker(&m_registryMutex);
+  return m_retained.size();
+}
+
+/**
+ * @brief Match retained topics against a pattern
+ *
+ * Runs on subscribe and on client bootstrap only, so a linear scan over the
+ * retained topics is acceptable; the pattern is parsed once into a one-entry
+ * trie rather than per topic.
+ */
+QList<Event> EventBus::collectRetained(const QString& pattern) const {
+  TopicTrie<bool> filter;
+  if (!filter.insert(pattern, true)) {
+    return {};
+  }
+
+  QList<Event> matching;
+  for (auto it = m_retained.constBegin(); it != m_retained.constEnd(); ++it) {
+    bool matched = false;
+    filter.match(it.key(), [&matched](bool) { matched = true; });
+    if (matched) {
+      matching.append(it.value());
+    }
+  }
+
+  std::stable_sort(matching.begin(), matching.end(), [](const Event& a, const Event& b) {
+    return a.timestampMs() < b.timestampMs();
+  });
+  return matching;
+}
+
+void EventBus::recordConflated(const QString& topic) {
+  m_conflatedTotal.fetch_add(1, std::memory_order_relaxed);
+  QMutexLocker locker(&m_statsMutex);
+  ++m_conflatedByTopic[topic];
 }
@@ -19,9 +19,22 @@
 
 #pragma once
 
+#include <QHash>
 #include <QMutex>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QSharedPointer>
 #include <QVariantMap>
+#include <array>
+#include <atomic>
+#include <functional>
+
+#include "Event.h"
+#include "MpscQueue.h"
+#include "TopicTrie.h"
+
+class QThread;
 
 /**
  * @class EventBus
@@ -44,13 +57,45 @@
  *   payload["timestamp"] = QDateTime::currentMSecsSinceEpoch();
  *   EventBus::instance().publish("android_auto/device_connected", payload);
  *
- *   // Subscriber receives event
- *   connect(&EventBus::instance(), &EventBus::messagePublished,
- *           this, [](const QString& topic, const QVariantMap& payload) {
- *       if (topic == "android_auto/device_connected") {
+ *   // Subscriber receives only matching events
+ *   EventBus::instance().subscribe("android_auto/device_connected", this,
+ *       [](const QString& topic, const QVariantMap& payload) {
  *           qInfo() << "Device connected:" << payload["device_id"];
- *       }
- *   });
+ *       });
+ *
+ * SUBSCRIPTION REGISTRY:
+ *   subscribe() indexes patterns in a TopicTrie when they are registered, so
+ *   wildcards are parsed once and each publish only invokes subscribers whose
+ *   pattern matches. Resolved subscriber lists are cached per topic. The
+ *   legacy messagePublished signal is still emitted for every event.
+ *
+ * CONFLATION (latest-value topics):
+ *   Pure state topics (stats, GPS fixes, sensor readings) can be marked with
+ *   addConflationPattern(). A subscriber that has not yet consumed the
+ *   previous value of such a topic gets that pending value replaced rather
+ *   than a second event queued, so a slow consumer sees only the newest
+ *   state and its backlog is bounded to one event per topic.
+ *
+ * PRIORITY LANES:
+ *   Topics matching addCriticalPattern() (driving-mode restrictions, audio
+ *   focus, input) are queued in the Critical lane, everything else in the
+ *   Normal lane. The dispatcher always empties the Critical lane before
+ *   taking the next Normal event, so a burst of status traffic cannot delay
+ *   a safety-relevant change by more than one in-flight dispatch.
+ *   Subscribers in other threads are reached through a two-lane inbox per
+ *   thread, so Critical deliveries also overtake Normal ones already queued
+ *   in the receiver's thread. Ordering is FIFO within a lane only.
+ *   laneStats() reports depth and publish() → handler latency. Receivers of
+ *   the messagePublished/eventPublished signals get plain FIFO delivery and
+ *   must forward the lane themselves (see WebSocketServer::relayEventBus()).
+ *
+ * RETAINED VALUES:
+ *   State topics marked with addRetainPattern() keep their last event (up
+ *   to kMaxRetainedTopics topics). A subscriber registered with
+ *   Replay::Retained, or a relay calling retainedEvents(), gets current
+ *   state immediately instead of waiting for the next change or querying the
+ *   owning service. One-off events (errors, job results, statistics) are
+ *   not retained, so a late subscriber never sees them as if they were live.
  *
  * TOPIC NAMING CONVENTION:
  *   Format: "service/event_name"
@@ -103,17 +148,27 @@
  *    25ms   UI                     shows "Playing on: Speaker"
  *    30ms   (playback continues)   uninterrupted audio on speaker
  *
+ * DISPATCH MODES:
+ * - Synchronous (default): publish() emits in the calling thread under a
+ *   QMutex. Deterministic, used by unit tests.
+ * - Asynchronous: publish() pushes onto a lock-free MPSC queue and returns
+ *   immediately. A dedicated dispatcher thread drains the queue in FIFO
+ *   order and emits messagePublished; subscribers living in other threads
+ *   receive the event through their thread's inbox, on their own thread,
+ *   so a slow subscriber never stalls a publisher (AASDK, decoder, HAL).
+ *
  * THREAD SAFETY:
- * - publish() is protected by QMutex
- * - Safe to call from any thread
- * - Signals emitted in calling thread (Qt default behaviour)
+ * - Safe to call publish() from any thread in either mode
+ * - Synchronous: signals emitted in calling thread (Qt default behaviour)
+ * - Asynchronous: signals emitted in the dispatcher thread, per-publisher
+ *   ordering is preserved
  * - Subscribers should use Qt::QueuedConnection if cross-thread
  *
  * PERFORMANCE CONSIDERATIONS:
- * - Each publish() is synchronous in calling thread
- * - For many subscribers, consider batching events
- * - EventBus itself has minimal overhead (<1ms per publish)
- * - Payload copy is shallow (QVariantMap is copy-on-write)
+ * - Synchronous publish() costs the sum of all direct subscribers
+ * - Asynchronous publish() costs one allocation plus two atomic operations
+ * - Each publish() builds one immutable Event; subscribers share it by
+ *   reference count and reuse its cached JSON/CBOR encodings
  *
  * @see WebSocketServer for event relay to remote UI clients
  * @see ServiceManager for service orchestration
@@ -129,6 +184,91 @@ class EventBus : public QObject {
    */
   static EventBus& instance();
 
+  /// Handle returned by subscribe(); 0 means the subscription was rejected
+  using SubscriptionId = quint64;
+  /// Callback invoked for each matching event
+  using Handler = std::function<void(const QString& topic, const QVariantMap& payload)>;
+  /// Callback receiving the shared Event (avoids payload copies and re-encoding)
+  using EventHandler = std::function<void(const Event& event)>;
+
+  /// How publish() delivers events to subscribers
+  enum class DispatchMode {
+    Synchronous,  ///< Emit in the publishing thread (tests, tooling)
+    Asynchronous  ///< Queue and emit from the dispatcher thread
+  };
+
+  /// Dispatch lane; Critical events overtake queued Normal ones
+  enum class Priority {
+    Critical,  ///< Safety/latency-critical state (driving mode, audio focus, input)
+    Normal     ///< Status, telemetry and other bulk traffic
+  };
+  static constexpr int kPriorityCount = 2;
+
+  /// Snapshot of one lane's queue and latency counters
+  struct LaneStats {
+    qsizetype queueDepth{0};     ///< Events waiting for the dispatcher (approximate)
+    quint64 dispatched{0};       ///< Events dispatched since startup
+    quint64 delivered{0};        ///< Subscriber handler calls (latency samples)
+    qint64 lastLatencyUs{0};     ///< publish() → start of the latest handler call
+    qint64 averageLatencyUs{0};  ///< Mean publish() → handler latency
+    qint64 maxLatencyUs{0};      ///< Worst publish() → handler latency
+  };
+
+  /// Whether subscribe() first delivers the retained values of matching topics
+  enum class Replay {
+    None,     ///< Only events published after subscribing
+    Retained  ///< Current value of every matching topic, then live events
+  };
+
+  /**
+   * @brief Select the dispatch mode
+   *
+   * Switching to Asynchronous starts the dispatcher thread. Switching back to
+   * Synchronous flushes any queued events (in order) before returning.
+   *
+   * @param mode New dispatch mode
+   * @note Call from the thread that owns the application event loop
+   */
+  void setDispatchMode(DispatchMode mode);
+
+  /**
+   * @brief Current dispatch mode
+   */
+  [[nodiscard]] auto dispatchMode() const -> DispatchMode;
+
+  /**
+   * @brief Number of events waiting for the dispatcher across all lanes
+   * @return 0 in Synchronous mode
+   */
+  [[nodiscard]] auto pendingEvents() const -> qsizetype;
+
+  /**
+   * @brief Dispatch topics matching pattern in the Critical lane
+   * @param pattern Topic or wildcard pattern (e.g. "driving-mode/#")
+   */
+  void addCriticalPattern(const QString& pattern);
+
+  /**
+   * @brief Return topics matching a previously added pattern to the Normal lane
+   */
+  void removeCriticalPattern(const QString& pattern);
+
+  /**
+   * @brief Lane a topic is dispatched in
+   */
+  [[nodiscard]] auto priorityFor(const QString& topic) const -> Priority;
+
+  /**
+   * @brief Queue depth and publish() → handler latency of one lane
+   */
+  [[nodiscard]] auto laneStats(Priority priority) const -> LaneStats;
+
+  /**
+   * @brief Flush queued events and stop the dispatcher thread
+   * @note Leaves the bus in Synchronous mode; called on destruction
+   */
+  void shutdown();
+
   /**
    * @brief Publish event to all subscribers
    *
@@ -151,17 +291,144 @@ class EventBus : public QObject {
    *                - Context (IDs, names) helps subscribers filter
    *
    * @note Is thread-safe; may be called from any thread
-   * @note Emits are synchronous; consider async if many subscribers
+   * @note Non-blocking in Asynchronous mode; see DispatchMode
    * @see TOPIC NAMING CONVENTION section above for topic examples
    */
   void publish(const QString& topic, const QVariantMap& payload);
 
+  /**
+   * @brief Publish a pre-built event
+   * @param event Shared immutable event; ignored if null
+   */
+  void publish(const Event& event);
+
+  /**
+   * @brief Subscribe to events whose topic matches pattern
+   *
+   * The handler runs in receiver's thread: directly when the event is
+   * dispatched on that thread, otherwise through a queued invocation. The
+   * subscription is removed automatically when receiver is destroyed.
+   *
+   * EXAMPLE:
+   *   EventBus::instance().subscribe("android-auto/+/state-changed", this,
+   *       [this](const QString& topic, const QVariantMap& payload) { ... });
+   *
+   * @param pattern Topic or wildcard pattern (see TopicTrie for syntax)
+   * @param receiver Context object providing thread affinity and lifetime
+   * @param handler Callback invoked with (topic, payload)
+   * @param replay Replay::Retained to receive the current value of every
+   *               matching topic first (directly if called on receiver's thread)
+   * @return Subscription handle, or 0 if pattern/receiver are invalid
+   */
+  auto subscribe(const QString& pattern, QObject* receiver, Handler handler,
+                 Replay replay = Replay::None) -> SubscriptionId;
+
+  /**
+   * @brief Subscribe with a handler that receives the shared Event
+   *
+   * Preferred for relays and serialising consumers: the handler can use
+   * Event::toJson()/toCbor() which are encoded once per event for all
+   * subscribers.
+   */
+  auto subscribe(const QString& pattern, QObject* receiver, EventHandler handler,
+                 Replay replay = Replay::None) -> SubscriptionId;
+
+  /**
+   * @brief Subscribe a member function slot (convenience overload)
+   */
+  template <typename Receiver>
+  auto subscribe(const QString& pattern, Receiver* receiver,
+                 void (Receiver::*slot)(const QString&, const QVariantMap&),
+                 Replay replay = Replay::None) -> SubscriptionId {
+    return subscribe(
+        pattern, static_cast<QObject*>(receiver),
+        [receiver, slot](const QString& topic, const QVariantMap& payload) {
+          (receiver->*slot)(topic, payload);
+        },
+        replay);
+  }
+
+  /**
+   * @brief Remove a subscription
+   * @param id Handle returned by subscribe()
+   */
+  void unsubscribe(SubscriptionId id);
+
+  /**
+   * @brief Number of active subscribe() registrations
+   */
+  [[nodiscard]] auto subscriptionCount() const -> qsizetype;
+
+  /**
+   * @brief Treat topics matching pattern as latest-value state
+   *
+   * Applies to subscribe() deliveries that cross threads; subscribers called
+   * directly in the dispatching thread have no backlog to conflate.
+   *
+   * @param pattern Topic or wildcard pattern (e.g. "android-auto/status/stats")
+   */
+  void addConflationPattern(const QString& pattern);
+
+  /**
+   * @brief Stop conflating topics matching a previously added pattern
+   */
+  void removeConflationPattern(const QString& pattern);
+
+  /**
+   * @brief Total number of events replaced by a newer value before delivery
+   */
+  [[nodiscard]] auto conflatedEventCount() const -> quint64;
+
+  /**
+   * @brief Conflated event counts keyed by topic
+   */
+  [[nodiscard]] auto conflatedEventCounts() const -> QHash<QString, quint64>;
+
+  /**
+   * @brief Keep the last event of topics matching pattern for replay
+   *
+   * Only state topics should be retained: a late subscriber receives the
+   * retained value as current state.
+   *
+   * @param pattern Topic or wildcard pattern (e.g. "driving-mode/#")
+   */
+  void addRetainPattern(const QString& pattern);
+
+  /**
+   * @brief Stop retaining topics matching a previously added pattern
+   *
+   * Values already retained are kept until clearRetained().
+   */
+  void removeRetainPattern(const QString& pattern);
+
+  /**
+   * @brief Last event published on a retained topic
+   * @return Retained event, or a null Event if none was published
+   */
+  [[nodiscard]] auto retainedEvent(const QString& topic) const -> Event;
+
+  /**
+   * @brief Last events of all topics matching pattern, oldest first
+   * @param pattern Topic or wildcard pattern (see TopicTrie for syntax)
+   */
+  [[nodiscard]] auto retainedEvents(const QString& pattern) const -> QList<Event>;
+
+  /**
+   * @brief Forget retained values of topics matching pattern
+   */
+  void clearRetained(const QString& pattern);
+
+  /**
+   * @brief Number of topics currently holding a retained value
+   */
+  [[nodiscard]] auto retainedTopicCount() const -> qsizetype;
+
  signals:
   /**
    * @brief Emitted whenever an event is published
    *
-   * All subscribers connect to this signal to receive events.
-   * Typically filtered by topic name.
+   * Legacy broadcast path: every event reaches every connected slot, which
+   * then filters by topic name. Prefer subscribe() for new code.
    *
    * Example subscriber:
    *   connect(&EventBus::instance(), &EventBus::messagePublished,
@@ -176,16 +443,138 @@ class EventBus : public QObject {
    */
   void messagePublished(const QString& topic, const QVariantMap& payload);
 
+  /**
+   * @brief Emitted whenever an event is published (shared Event form)
+   * @param event Immutable event carrying topic, payload and cached encodings
+   */
+  void eventPublished(const Event& event);
+
  private:
   /// Private constructor (singleton pattern)
   EventBus() = default;
-  /// Private destructor (singleton pattern)
-  ~EventBus() = default;
+  /// Private destructor (singleton pattern); stops the dispatcher thread
+  ~EventBus() override;
   /// Deleted copy constructor (singleton pattern)
   EventBus(const EventBus&) = delete;
   /// Deleted assignment operator (singleton pattern)
   EventBus& operator=(const EventBus&) = delete;
 
-  /// Mutex for thread-safe publish() calls
+  /// Latest undelivered value per conflated topic for one subscriber
+  struct ConflationSlots {
+    QMutex mutex;
+    QHash<QString, Event> pending;
+  };
+
+  /// Registered subscriber; shared so in-flight deliveries outlive unsubscribe()
+  struct Subscription {
+    SubscriptionId id{0};
+    QString pattern;
+    QPointer<QObject> receiver;
+    EventHandler handler;
+    QSharedPointer<ConflationSlots> conflation;
+  };
+  using SubscriptionPtr = QSharedPointer<const Subscription>;
+
+  /// Dispatch plan for one topic, cached after the first event on it
+  struct TopicRoute {
+    QList<SubscriptionPtr> subscribers;
+    bool conflated{false};
+    bool retained{false};
+  };
+
+  /// Upper bound on cached topic → subscribers resolutions
+  static constexpr qsizetype kMaxResolvedTopics = 1024;
+  /// Upper bound on distinct topics holding a retained value
+  static constexpr qsizetype kMaxRetainedTopics = 4096;
+
+  /// Event waiting in a lane, stamped for latency accounting
+  struct QueuedEvent {
+    Event event;
+    qint64 enqueuedNs{0};
+  };
+
+  /// One priority class: its queue plus lock-free statistics
+  struct Lane {
+    MpscQueue<QueuedEvent> queue;
+    std::atomic<quint64> dispatched{0};
+    std::atomic<quint64> delivered{0};
+    std::atomic<qint64> totalLatencyNs{0};
+    std::atomic<qint64> lastLatencyNs{0};
+    std::atomic<qint64> maxLatencyNs{0};
+  };
+
+  /// Upper bound on cached topic → lane classifications
+  static constexpr qsizetype kMaxClassifiedTopics = 1024;
+
+  /// Monotonic clock used for lane latency
+  static auto monotonicNs() -> qint64;
+  /// Pop the oldest event of the highest non-empty lane (consumer side)
+  auto popNext(QueuedEvent& out) -> Lane*;
+  /// Dispatch a queued event, then count it
+  void dispatchQueued(Lane& lane, const QueuedEvent& queued);
+  /// Add one handler call to a lane's latency statistics (no-op without a lane)
+  static void recordLatency(Lane* lane, qint64 enqueuedNs);
+  /// Deliver every queued event, Critical lane first (consumer side)
+  void flushLanes();
+  /// Emit the legacy signal and invoke matching subscribers
+  void dispatch(Lane& lane, const QueuedEvent& queued);
+  /// Retain event and look up (and cache) subscribers and policy for its topic
+  auto routeEvent(const Event& event) -> TopicRoute;
+  /// Retained events matching pattern, oldest first (registry lock held)
+  auto collectRetained(const QString& pattern) const -> QList<Event>;
+  /// Invoke one subscriber in its receiver's thread, at the lane's priority
+  void deliver(const SubscriptionPtr& subscription, const Event& event, bool conflated,
+               Lane* lane = nullptr, qint64 enqueuedNs = 0);
+  /// Count an event that was superseded before delivery
+  void recordConflated(const QString& topic);
+  /// Run call in thread via its inbox; Qt::HighEventPriority for Critical
+  void postToThread(QThread* thread, std::function<void()> call, Qt::EventPriority priority);
+
+  /// Post a drain request to the dispatcher unless one is already pending
+  void scheduleDrain();
+  /// Dispatcher thread: deliver all queued events in FIFO order
+  void drainQueue();
+
+  /// Mutex for thread-safe synchronous publish() calls
   QMutex m_mutex;
+
+  /// Lock-free queues feeding the dispatcher thread, indexed by Priority
+  std::array<Lane, kPriorityCount> m_lanes;
+  std::atomic<DispatchMode> m_mode{DispatchMode::Synchronous};
+  std::atomic_bool m_drainScheduled{false};
+
+  /// Guards the subscription registry, resolution cache and retained values
+  mutable QMutex m_registryMutex;
+  QHash<SubscriptionId, SubscriptionPtr> m_subscriptions;
+  TopicTrie<SubscriptionId> m_subscriptionIndex;
+  QHash<QString, TopicRoute> m_resolvedTopics;
+  SubscriptionId m_nextSubscriptionId{1};
+  QSet<QString> m_conflationPatterns;
+  TopicTrie<QString> m_conflationIndex;
+  QSet<QString> m_retainPatterns;
+  TopicTrie<QString> m_retainIndex;
+  QHash<QString, Event> m_retained;
+  bool m_retainedOverflowReported{false};
+
+  /// Guards topic → lane classification
+  mutable QMutex m_priorityMutex;
+  QSet<QString> m_criticalPatterns;
+  TopicTrie<QString> m_criticalIndex;
+  mutable QHash<QString, Priority> m_priorityCache;
+  /// Lets publish() skip classification entirely when no pattern is set
+  std::atomic_bool m_hasCriticalPatterns{false};
+
+  /// Per-thread inboxes for cross-thread deliveries
+  class ThreadInbox;
+  QMutex m_inboxMutex;
+  QHash<QThread*, ThreadInbox*> m_inboxes;
+
+  /// Guards per-topic statistics
+  mutable QMutex m_statsMutex;
+  QHash<QString, quint64> m_conflatedByTopic;
+  std::atomic<quint64> m_conflatedTotal{0};
+
+  QThread* m_dispatchThread{nullptr};
+  /// Context object living in m_dispatchThread; target of drain requests
+  std::atomic<QObject*> m_dispatchContext{nullptr};
 };
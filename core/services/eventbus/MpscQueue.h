@@ -0,0 +1,138 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+#include <utility>
+
+/**
+ * @class MpscQueue
+ * @brief Unbounded lock-free multi-producer / single-consumer FIFO queue
+ *
+ * Intrusive node-based queue (Dmitry Vyukov's MPSC algorithm). Producers
+ * never block each other: push() is a single atomic exchange plus a release
+ * store. The consumer side is wait-free except for the short window where a
+ * producer has swapped the head but not yet linked its node, in which case
+ * tryPop() reports "empty" and the consumer retries on its next wake-up.
+ *
+ * THREAD SAFETY:
+ * - push() may be called concurrently from any number of threads
+ * - tryPop() must only ever be called from one thread at a time
+ *
+ * @tparam T Element type (must be default-constructible and movable)
+ */
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+  ~MpscQueue() {
+    T discarded;
+    while (tryPop(discarded)) {
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  /**
+   * @brief Append an element (lock-free, any thread)
+   * @param value Element to enqueue
+   */
+  void push(T value) {
+    auto* node = new Node;
+    node->value = std::move(value);
+    m_size.fetch_add(1, std::memory_order_relaxed);
+    pushNode(node);
+  }
+
+  /**
+   * @brief Remove the oldest element (consumer thread only)
+   * @param out Receives the element when one is available
+   * @return true if an element was dequeued
+   */
+  auto tryPop(T& out) -> bool {
+    Node* tail = m_tail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &m_stub) {
+      if (next == nullptr) {
+        return false;
+      }
+      m_tail = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr) {
+      m_tail = next;
+      return release(tail, out);
+    }
+
+    // A producer has exchanged the head but not yet linked its node
+    if (tail != m_head.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    // Single element left: re-insert the stub so the last node can be detached
+    m_stub.next.store(nullptr, std::memory_order_relaxed);
+    pushNode(&m_stub);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      m_tail = next;
+      return release(tail, out);
+    }
+    return false;
+  }
+
+  /**
+   * @brief Approximate number of queued elements
+   * @note Relaxed counter; only suitable for statistics
+   */
+  [[nodiscard]] auto sizeApprox() const -> qsizetype {
+    return m_size.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+    T value{};
+  };
+
+  void pushNode(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  auto release(Node* node, T& out) -> bool {
+    out = std::move(node->value);
+    delete node;
+    m_size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  Node m_stub;
+  std::atomic<Node*> m_head;
+  Node* m_tail;  // Consumer-owned
+  std::atomic<qsizetype> m_size{0};
+};
@@ -0,0 +1,122 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QHash>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <functional>
+#include <utility>
+
+/**
+ * @class PriorityInvoker
+ * @brief Queued call into another thread at a chosen event priority
+ *
+ * QMetaObject::invokeMethod() always posts at Qt::NormalEventPriority, so a
+ * queued call waits behind everything already queued for the target thread.
+ * post() with Qt::HighEventPriority instead sends the call as an event to a
+ * relay object living in the context's thread; Qt orders a thread's posted
+ * events by priority, so the call overtakes queued normal-priority work,
+ * including earlier invokeMethod() calls.
+ *
+ * As with invokeMethod(), the call is dropped if the context is destroyed
+ * before it runs. Relays are created on first use, one per thread, and are
+ * deleted when their thread finishes.
+ *
+ * THREAD SAFETY:
+ * - post() may be called from any thread
+ */
+class PriorityInvoker {
+ public:
+  using Call = std::function<void()>;
+
+  /**
+   * @brief Run call in the context's thread
+   * @param context Object whose thread runs the call; also bounds its lifetime
+   * @param priority Qt::NormalEventPriority behaves exactly like invokeMethod()
+   */
+  static void post(QObject* context, Call call, Qt::EventPriority priority) {
+    if (priority == Qt::NormalEventPriority) {
+      QMetaObject::invokeMethod(context, std::move(call), Qt::QueuedConnection);
+      return;
+    }
+    Relay* relay = relayFor(context->thread());
+    if (!relay) {
+      return;
+    }
+    QCoreApplication::postEvent(relay, new CallEvent(context, std::move(call)), priority);
+  }
+
+ private:
+  class CallEvent : public QEvent {
+   public:
+    CallEvent(QObject* context, Call call)
+        : QEvent(eventType()), m_context(context), m_call(std::move(call)) {}
+
+    static auto eventType() -> QEvent::Type {
+      static const auto type = static_cast<QEvent::Type>(QEvent::registerEventType());
+      return type;
+    }
+
+    void run() const {
+      if (m_context) {
+        m_call();
+      }
+    }
+
+   private:
+    QPointer<QObject> m_context;
+    Call m_call;
+  };
+
+  class Relay : public QObject {
+   public:
+    auto event(QEvent* event) -> bool override {
+      if (event->type() == CallEvent::eventType()) {
+        static_cast<CallEvent*>(event)->run();
+        return true;
+      }
+      return QObject::event(event);
+    }
+  };
+
+  static auto relayFor(QThread* thread) -> Relay* {
+    if (!thread) {
+      return nullptr;
+    }
+    static QMutex mutex;
+    static QHash<QThread*, QPointer<Relay>> relays;
+
+    QMutexLocker locker(&mutex);
+    QPointer<Relay>& relay = relays[thread];
+    if (!relay) {
+      relay = new Relay();
+      relay->moveToThread(thread);
+      QObject::connect(thread, &QThread::finished, relay, &QObject::deleteLater);
+    }
+    return relay;
+  }
+};
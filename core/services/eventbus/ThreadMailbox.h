@@ -0,0 +1,99 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <atomic>
+#include <functional>
+
+#include "MpscQueue.h"
+#include "PriorityInvoker.h"
+
+/**
+ * @class ThreadMailbox
+ * @brief Lock-free task handoff into the thread of a context object
+ *
+ * post() pushes onto an MpscQueue and wakes the target thread with a single
+ * queued invocation per burst (same drain-flag scheme as the EventBus
+ * dispatcher), so producers never take a lock and a flood of tasks costs
+ * one event-loop wake-up rather than one posted event each.
+ *
+ * Tasks posted at Qt::HighEventPriority go into a second queue that drain()
+ * empties before each normal task, and their wake-up is posted at high
+ * priority too, so they overtake both the mailbox backlog and other
+ * normal-priority events queued for the context's thread.
+ *
+ * The mailbox must be owned by (or outlive) its context object: queued
+ * wake-ups are bound to the context and discarded if it is destroyed.
+ *
+ * THREAD SAFETY:
+ * - post() may be called from any thread
+ * - Tasks run in the context object's thread, in FIFO order per priority
+ */
+class ThreadMailbox {
+ public:
+  using Task = std::function<void()>;
+
+  explicit ThreadMailbox(QObject* context) : m_context(context) {}
+
+  ThreadMailbox(const ThreadMailbox&) = delete;
+  ThreadMailbox& operator=(const ThreadMailbox&) = delete;
+
+  /**
+   * @brief Queue a task for the context's thread (lock-free, any thread)
+   * @param priority Qt::HighEventPriority runs the task ahead of normal ones
+   */
+  void post(Task task, Qt::EventPriority priority = Qt::NormalEventPriority) {
+    const bool urgent = priority > Qt::NormalEventPriority;
+    (urgent ? m_urgentTasks : m_tasks).push(std::move(task));
+    if ((urgent ? m_urgentDrainScheduled : m_drainScheduled).exchange(true)) {
+      return;
+    }
+    PriorityInvoker::post(
+        m_context, [this]() { drain(); },
+        urgent ? Qt::HighEventPriority : Qt::NormalEventPriority);
+  }
+
+  /**
+   * @brief Tasks waiting to run (approximate)
+   */
+  [[nodiscard]] auto pending() const -> qsizetype {
+    return m_urgentTasks.sizeApprox() + m_tasks.sizeApprox();
+  }
+
+  /**
+   * @brief Run every queued task now (must be called in the context's thread)
+   */
+  void drain() {
+    m_urgentDrainScheduled.store(false);
+    m_drainScheduled.store(false);
+    Task task;
+    while (m_urgentTasks.tryPop(task) || m_tasks.tryPop(task)) {
+      task();
+    }
+  }
+
+ private:
+  QObject* m_context;
+  MpscQueue<Task> m_urgentTasks;
+  MpscQueue<Task> m_tasks;
+  std::atomic_bool m_urgentDrainScheduled{false};
+  std::atomic_bool m_drainScheduled{false};
+};
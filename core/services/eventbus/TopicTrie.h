@@ -0,0 +1,309 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include <QVarLengthArray>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @class TopicTrie
+ * @brief Segment trie mapping topic patterns to values
+ *
+ * Patterns are split on '/' once, at insert time, and stored as a path of
+ * trie nodes. Matching a concrete topic walks the trie segment by segment,
+ * comparing QStringViews into the topic, so the cost depends on topic depth
+ * rather than on the number of patterns and nothing is allocated for topics
+ * up to kInlineSegments levels deep.
+ *
+ * PATTERN SYNTAX:
+ * - "service/event"      exact topic
+ * - "+" or "*"           exactly one level ("android-auto/+/state-changed")
+ * - "#" or "**" (inner)  zero or more levels ("vehicle/#/speed" matches
+ *                        "vehicle/speed" and "vehicle/can/0/speed")
+ * - "#" or "**" (last)   zero or more further levels, as in MQTT ("media/#"
+ *                        matches "media" and "media/track/title")
+ * - trailing "*"         one or more further levels (legacy "media/*" form
+ *                        documented in docs/API.md; does not match "media")
+ * - "#", "*" or "**"     on their own match every topic
+ *
+ * @tparam T Value type stored per pattern (must be equality-comparable)
+ * @note Not thread-safe; callers serialise access
+ */
+template <typename T>
+class TopicTrie {
+ public:
+  /// Maximum topic depth matched without heap allocation
+  static constexpr int kInlineSegments = 16;
+  using Segments = QVarLengthArray<QStringView, kInlineSegments>;
+
+  /**
+   * @brief Split a topic on '/' into views (empty levels are kept)
+   */
+  static auto split(QStringView topic) -> Segments {
+    Segments segments;
+    qsizetype start = 0;
+    for (;;) {
+      const qsizetype slash = topic.indexOf(u'/', start);
+      if (slash < 0) {
+        segments.append(topic.mid(start));
+        return segments;
+      }
+      segments.append(topic.mid(start, slash - start));
+      start = slash + 1;
+    }
+  }
+
+  /**
+   * @brief Check pattern syntax
+   *
+   * Wildcards are accepted in any position; only the empty pattern is
+   * rejected.
+   */
+  static auto isValidPattern(QStringView pattern) -> bool {
+    return !pattern.isEmpty();
+  }
+
+  /**
+   * @brief Register a value under a pattern
+   * @return false if the pattern is invalid
+   */
+  auto insert(QStringView pattern, const T& value) -> bool {
+    if (!isValidPattern(pattern)) {
+      return false;
+    }
+
+    const Segments segments = split(pattern);
+    Node* node = &m_root;
+    for (qsizetype i = 0; i < segments.size(); ++i) {
+      const QStringView segment = segments[i];
+      const bool last = (i + 1 == segments.size());
+      if (isMultiLevel(segment, last)) {
+        node->multiLevel.append(value);
+        return true;
+      }
+      if (isSubLevels(segment, last)) {
+        node->subLevels.append(value);
+        return true;
+      }
+      if (isInnerMultiLevel(segment, last)) {
+        if (!node->anyLevels) {
+          node->anyLevels = std::make_unique<Node>();
+        }
+        node = node->anyLevels.get();
+        ++m_innerMultiLevelPatterns;
+        continue;
+      }
+      node = childFor(node, segment, true);
+    }
+    node->values.append(value);
+    return true;
+  }
+
+  /**
+   * @brief Unregister a value previously inserted under pattern
+   * @return true if the value was found and removed
+   */
+  auto remove(QStringView pattern, const T& value) -> bool {
+    if (!isValidPattern(pattern)) {
+      return false;
+    }
+    const Segments segments = split(pattern);
+    if (!removeFrom(&m_root, segments, 0, value)) {
+      return false;
+    }
+    for (qsizetype i = 0; i + 1 < segments.size(); ++i) {
+      if (isInnerMultiLevel(segments[i], false)) {
+        --m_innerMultiLevelPatterns;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Invoke visitor(value) for every pattern matching topic
+   *
+   * Each registered (pattern, value) pair is visited at most once. Inner
+   * "#"/"**" can match a topic in several ways, so values reached through
+   * them are de-duplicated before visiting; without such patterns values are
+   * visited directly.
+   */
+  template <typename Visitor>
+  void match(QStringView topic, Visitor&& visitor) const {
+    const Segments segments = split(topic);
+    if (m_innerMultiLevelPatterns == 0) {
+      matchFrom(&m_root, segments, 0, visitor);
+      return;
+    }
+
+    QVarLengthArray<const T*, kInlineSegments> matched;
+    auto collect = [&matched](const T& value) {
+      for (const T* seen : matched) {
+        if (*seen == value) {
+          return;
+        }
+      }
+      matched.append(&value);
+    };
+    matchFrom(&m_root, segments, 0, collect);
+    for (const T* value : matched) {
+      visitor(*value);
+    }
+  }
+
+  void clear() {
+    m_root = Node();
+    m_innerMultiLevelPatterns = 0;
+  }
+
+ private:
+  struct Node {
+    std::vector<std::pair<QString, std::unique_ptr<Node>>> children;
+    std::unique_ptr<Node> singleLevel;  ///< "+" / "*"
+    std::unique_ptr<Node> anyLevels;    ///< Inner "#" / "**"
+    QList<T> values;                    ///< Patterns ending exactly here
+    QList<T> multiLevel;                ///< Patterns ending with "#" / "**" here
+    QList<T> subLevels;                 ///< Patterns ending with "*" here
+
+    [[nodiscard]] auto isEmpty() const -> bool {
+      return children.empty() && !singleLevel && !anyLevels && values.isEmpty() &&
+             multiLevel.isEmpty() && subLevels.isEmpty();
+    }
+  };
+
+  static auto isMultiLevel(QStringView segment, bool last) -> bool {
+    return last && (segment == u"#" || segment == u"**");
+  }
+
+  static auto isSubLevels(QStringView segment, bool last) -> bool {
+    return last && segment == u"*";
+  }
+
+  static auto isInnerMultiLevel(QStringView segment, bool last) -> bool {
+    return !last && (segment == u"#" || segment == u"**");
+  }
+
+  static auto isSingleLevel(QStringView segment) -> bool {
+    return segment == u"+" || segment == u"*";
+  }
+
+  static auto childFor(Node* node, QStringView segment, bool create) -> Node* {
+    if (isSingleLevel(segment)) {
+      if (!node->singleLevel && create) {
+        node->singleLevel = std::make_unique<Node>();
+      }
+      return node->singleLevel.get();
+    }
+    for (auto& child : node->children) {
+      if (child.first == segment) {
+        return child.second.get();
+      }
+    }
+    if (!create) {
+      return nullptr;
+    }
+    node->children.emplace_back(segment.toString(), std::make_unique<Node>());
+    return node->children.back().second.get();
+  }
+
+  static auto removeFrom(Node* node, const Segments& segments, qsizetype index, const T& value)
+      -> bool {
+    const QStringView segment = segments[index];
+    const bool last = (index + 1 == segments.size());
+    if (isMultiLevel(segment, last)) {
+      return node->multiLevel.removeOne(value);
+    }
+    if (isSubLevels(segment, last)) {
+      return node->subLevels.removeOne(value);
+    }
+
+    const bool inner = isInnerMultiLevel(segment, last);
+    Node* child = inner ? node->anyLevels.get() : childFor(node, segment, false);
+    if (!child) {
+      return false;
+    }
+    const bool removed =
+        last ? child->values.removeOne(value) : removeFrom(child, segments, index + 1, value);
+
+    // Prune branches that no longer carry any pattern
+    if (removed && child->isEmpty()) {
+      if (inner) {
+        node->anyLevels.reset();
+      } else if (isSingleLevel(segment)) {
+        node->singleLevel.reset();
+      } else {
+        for (auto it = node->children.begin(); it != node->children.end(); ++it) {
+          if (it->second.get() == child) {
+            node->children.erase(it);
+            break;
+          }
+        }
+      }
+    }
+    return removed;
+  }
+
+  template <typename Visitor>
+  static void matchFrom(const Node* node, const Segments& segments, qsizetype index,
+                        Visitor& visitor) {
+    // Inner "#" / "**" may absorb any number of the remaining levels
+    if (node->anyLevels) {
+      for (qsizetype next = index; next <= segments.size(); ++next) {
+        matchFrom(node->anyLevels.get(), segments, next, visitor);
+      }
+    }
+
+    // A trailing "#" / "**" also matches its parent level ("a/#" matches "a")
+    for (const T& value : node->multiLevel) {
+      visitor(value);
+    }
+
+    if (index == segments.size()) {
+      for (const T& value : node->values) {
+        visitor(value);
+      }
+      return;
+    }
+
+    // At least one level remains, so a trailing "*" anchored here matches
+    for (const T& value : node->subLevels) {
+      visitor(value);
+    }
+
+    const QStringView segment = segments[index];
+    for (const auto& child : node->children) {
+      if (child.first == segment) {
+        matchFrom(child.second.get(), segments, index + 1, visitor);
+        break;
+      }
+    }
+    if (node->singleLevel) {
+      matchFrom(node->singleLevel.get(), segments, index + 1, visitor);
+    }
+  }
+
+  Node m_root;
+  /// Patterns containing inner "#" / "**" (counted once per such segment)
+  qsizetype m_innerMultiLevelPatterns{0};
+};
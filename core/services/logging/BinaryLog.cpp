@@ -0,0 +1,305 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "BinaryLog.h"
+
+#include <QCborMap>
+#include <QCborValue>
+#include <utility>
+
+namespace {
+constexpr char kMagic[] = {'C', 'S', 'B', 'L'};
+
+enum Tag : quint8 { TagString = 0x01, TagThread = 0x02, TagRecord = 0x03, TagReset = 0x04 };
+
+void writeVarint(QByteArray& out, quint64 value) {
+  while (value >= 0x80) {
+    out.append(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.append(static_cast<char>(value));
+}
+
+auto zigzag(qint64 value) -> quint64 {
+  return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+auto unzigzag(quint64 value) -> qint64 {
+  return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+}  // namespace
+
+QByteArray BinaryLogEncoder::fileHeader() {
+  QByteArray header(kMagic, sizeof(kMagic));
+  header.append(static_cast<char>(kVersion));
+  return header;
+}
+
+void BinaryLogEncoder::reset() {
+  m_needsReset = true;
+}
+
+void BinaryLogEncoder::append(QByteArray& out, qint64 timestampMs, int level, quint64 threadId,
+                              const QString& component, const QString& message,
+                              const QJsonObject& context) {
+  if (m_needsReset || m_strings.size() >= kMaxInternedStrings) {
+    m_strings.clear();
+    m_threads.clear();
+    m_seenMessages.clear();
+    m_lastTimestampMs = timestampMs;
+    m_needsReset = false;
+    out.append(static_cast<char>(TagReset));
+    writeVarint(out, static_cast<quint64>(timestampMs));
+  }
+
+  // Table entries go before the record that first uses them
+  const quint64 componentId = internString(out, component);
+  const quint64 threadIndex = internThread(out, threadId);
+
+  quint64 messageRef = 0;
+  QByteArray inlineMessage;
+  const auto interned = m_strings.constFind(message);
+  if (interned != m_strings.constEnd()) {
+    messageRef = interned.value() << 1;
+  } else {
+    const size_t hash = qHash(message);
+    if (m_seenMessages.contains(hash)) {
+      messageRef = internString(out, message) << 1;
+    } else {
+      if (m_seenMessages.size() >= kMaxSeenMessages) {
+        m_seenMessages.clear();
+      }
+      m_seenMessages.insert(hash);
+      inlineMessage = message.toUtf8();
+      messageRef = (static_cast<quint64>(inlineMessage.size()) << 1) | 1;
+    }
+  }
+
+  out.append(static_cast<char>(TagRecord));
+  writeVarint(out, zigzag(timestampMs - m_lastTimestampMs));
+  m_lastTimestampMs = timestampMs;
+  out.append(static_cast<char>(level));
+  writeVarint(out, componentId);
+  writeVarint(out, threadIndex);
+  writeVarint(out, messageRef);
+  out.append(inlineMessage);
+  if (context.isEmpty()) {
+    writeVarint(out, 0);
+  } else {
+    const QByteArray cbor = QCborMap::fromJsonObject(context).toCborValue().toCbor();
+    writeVarint(out, static_cast<quint64>(cbor.size()));
+    out.append(cbor);
+  }
+}
+
+quint64 BinaryLogEncoder::internString(QByteArray& out, const QString& text) {
+  const auto found = m_strings.constFind(text);
+  if (found != m_strings.constEnd()) {
+    return found.value();
+  }
+  const auto id = static_cast<quint64>(m_strings.size());
+  m_strings.insert(text, id);
+
+  const QByteArray utf8 = text.toUtf8();
+  out.append(static_cast<char>(TagString));
+  writeVarint(out, id);
+  writeVarint(out, static_cast<quint64>(utf8.size()));
+  out.append(utf8);
+  return id;
+}
+
+quint64 BinaryLogEncoder::internThread(QByteArray& out, quint64 threadId) {
+  const auto found = m_threads.constFind(threadId);
+  if (found != m_threads.constEnd()) {
+    return found.value();
+  }
+  const auto id = static_cast<quint64>(m_threads.size());
+  m_threads.insert(threadId, id);
+
+  out.append(static_cast<char>(TagThread));
+  writeVarint(out, id);
+  writeVarint(out, threadId);
+  return id;
+}
+
+BinaryLogDecoder::BinaryLogDecoder(QByteArray data) : m_data(std::move(data)) {}
+
+bool BinaryLogDecoder::readHeader(QString& error) {
+  const qsizetype headerSize = static_cast<qsizetype>(sizeof(kMagic)) + 1;
+  if (m_data.size() < headerSize || !m_data.startsWith(QByteArray(kMagic, sizeof(kMagic)))) {
+    error = "bad_magic";
+    return false;
+  }
+  if (static_cast<quint8>(m_data.at(sizeof(kMagic))) != BinaryLogEncoder::kVersion) {
+    error = "unsupported_version";
+    return false;
+  }
+  m_pos = headerSize;
+  return true;
+}
+
+bool BinaryLogDecoder::next(BinaryLogEntry& entry, QString& error) {
+  error.clear();
+  while (m_pos < m_data.size()) {
+    const auto tag = static_cast<quint8>(m_data.at(m_pos++));
+    switch (tag) {
+      case TagReset: {
+        quint64 base = 0;
+        if (!readVarint(base)) {
+          error = "truncated";
+          return false;
+        }
+        m_strings.clear();
+        m_threads.clear();
+        m_lastTimestampMs = static_cast<qint64>(base);
+        break;
+      }
+      case TagString: {
+        quint64 id = 0;
+        quint64 length = 0;
+        QByteArray utf8;
+        if (!readVarint(id) || !readVarint(length) ||
+            !readBytes(static_cast<qsizetype>(length), utf8)) {
+          error = "truncated";
+          return false;
+        }
+        m_strings.insert(id, QString::fromUtf8(utf8));
+        break;
+      }
+      case TagThread: {
+        quint64 id = 0;
+        quint64 threadId = 0;
+        if (!readVarint(id) || !readVarint(threadId)) {
+          error = "truncated";
+          return false;
+        }
+        m_threads.insert(id, threadId);
+        break;
+      }
+      case TagRecord: {
+        quint64 delta = 0;
+        quint64 componentId = 0;
+        quint64 threadIndex = 0;
+        quint64 messageRef = 0;
+        quint64 contextLength = 0;
+        if (!readVarint(delta) || m_pos >= m_data.size()) {
+          error = "truncated";
+          return false;
+        }
+        const int level = static_cast<quint8>(m_data.at(m_pos++));
+        if (!readVarint(componentId) || !readVarint(threadIndex) || !readVarint(messageRef)) {
+          error = "truncated";
+          return false;
+        }
+
+        QString message;
+        if (messageRef & 1) {
+          QByteArray utf8;
+          if (!readBytes(static_cast<qsizetype>(messageRef >> 1), utf8)) {
+            error = "truncated";
+            return false;
+          }
+          message = QString::fromUtf8(utf8);
+        } else if (m_strings.contains(messageRef >> 1)) {
+          message = m_strings.value(messageRef >> 1);
+        } else {
+          error = "unknown_string";
+          return false;
+        }
+
+        QByteArray cbor;
+        if (!readVarint(contextLength) || !readBytes(static_cast<qsizetype>(contextLength), cbor)) {
+          error = "truncated";
+          return false;
+        }
+        if (!m_strings.contains(componentId)) {
+          error = "unknown_string";
+          return false;
+        }
+        if (!m_threads.contains(threadIndex)) {
+          error = "unknown_thread";
+          return false;
+        }
+
+        QJsonObject context;
+        if (!cbor.isEmpty()) {
+          const QCborValue value = QCborValue::fromCbor(cbor);
+          if (!value.isMap()) {
+            error = "bad_context";
+            return false;
+          }
+          context = value.toMap().toJsonObject();
+        }
+
+        m_lastTimestampMs += unzigzag(delta);
+        entry.timestampMs = m_lastTimestampMs;
+        entry.level = level;
+        entry.threadId = m_threads.value(threadIndex);
+        entry.component = m_strings.value(componentId);
+        entry.message = message;
+        entry.context = context;
+        return true;
+      }
+      default:
+        error = "unknown_frame";
+        return false;
+    }
+  }
+  return false;
+}
+
+qsizetype BinaryLogDecoder::intactLength(const QByteArray& data) {
+  BinaryLogDecoder decoder(data);
+  QString error;
+  if (!decoder.readHeader(error)) {
+    return 0;
+  }
+  qsizetype intact = decoder.position();
+  BinaryLogEntry entry;
+  while (decoder.next(entry, error)) {
+    intact = decoder.position();
+  }
+  // A clean end may still trail string/thread/reset frames; those are complete too
+  return error.isEmpty() ? data.size() : intact;
+}
+
+bool BinaryLogDecoder::readVarint(quint64& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (m_pos >= m_data.size()) {
+      return false;
+    }
+    const auto byte = static_cast<quint8>(m_data.at(m_pos++));
+    value |= static_cast<quint64>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BinaryLogDecoder::readBytes(qsizetype length, QByteArray& out) {
+  if (length < 0 || length > m_data.size() - m_pos) {
+    return false;
+  }
+  out = m_data.mid(m_pos, length);
+  m_pos += length;
+  return true;
+}
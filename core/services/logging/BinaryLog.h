@@ -0,0 +1,139 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
+#include <QString>
+
+/**
+ * @brief One decoded log record
+ */
+struct BinaryLogEntry {
+  qint64 timestampMs{0};
+  int level{0};
+  quint64 threadId{0};
+  QString component;
+  QString message;
+  QJsonObject context;
+};
+
+/**
+ * @brief Compact binary encoding for log files (alternative to JSON lines)
+ *
+ * A file starts with the magic "CSBL" and a version byte, followed by
+ * frames. Each frame starts with a tag byte. Integers are unsigned LEB128
+ * varints.
+ *
+ *   0x01 STRING  id, length, UTF-8 bytes            (intern table entry)
+ *   0x02 THREAD  id, native thread id               (thread table entry)
+ *   0x03 RECORD  timestamp delta (zigzag ms), level byte, component id,
+ *                thread id, message, context length, context as a CBOR map
+ *   0x04 RESET   base timestamp (ms since epoch); clears both tables
+ *
+ * A message is either an interned string (id << 1) or inline text
+ * (length << 1 | 1, then UTF-8). Components are always interned. Messages
+ * go inline the first time and are interned when they repeat, so constant
+ * messages cost a few bytes. Each writer session begins with RESET, so a
+ * file appended to by several runs decodes without outside state.
+ *
+ * Decode with crankshaft-logdecode, which prints the same JSON lines that
+ * the JSON format writes.
+ */
+class BinaryLogEncoder {
+ public:
+  static constexpr quint8 kVersion = 1;
+
+  /// Bytes that start every binary log file
+  static auto fileHeader() -> QByteArray;
+
+  /**
+   * @brief Start a new session: the next append() writes a RESET frame first
+   */
+  void reset();
+
+  /**
+   * @brief Append one record (and any table entries it needs) to out
+   */
+  void append(QByteArray& out, qint64 timestampMs, int level, quint64 threadId,
+              const QString& component, const QString& message, const QJsonObject& context);
+
+ private:
+  auto internString(QByteArray& out, const QString& text) -> quint64;
+  auto internThread(QByteArray& out, quint64 threadId) -> quint64;
+
+  /// Table sizes that trigger a RESET, bounding encoder memory
+  static constexpr int kMaxInternedStrings = 8192;
+  static constexpr int kMaxSeenMessages = 4096;
+
+  QHash<QString, quint64> m_strings;
+  QHash<quint64, quint64> m_threads;
+  QSet<size_t> m_seenMessages;  // Hashes of messages sent inline once
+  qint64 m_lastTimestampMs{0};
+  bool m_needsReset{true};
+};
+
+/**
+ * @brief Reads records back from a binary log
+ */
+class BinaryLogDecoder {
+ public:
+  explicit BinaryLogDecoder(QByteArray data);
+
+  /**
+   * @brief Check the file header
+   * @param error Set to "bad_magic" or "unsupported_version" on failure
+   */
+  auto readHeader(QString& error) -> bool;
+
+  /**
+   * @brief Decode the next record
+   * @param error Empty at a clean end of data; otherwise "truncated",
+   *              "unknown_frame", "unknown_string", "unknown_thread" or "bad_context"
+   * @return false when no record was decoded
+   */
+  auto next(BinaryLogEntry& entry, QString& error) -> bool;
+
+  /**
+   * @brief Length of the prefix of a log file that ends on its last complete record
+   *
+   * A writer killed mid-batch leaves a partial frame at the tail; appending after it
+   * would make every later record undecodable. Returns 0 when the header is bad.
+   */
+  static auto intactLength(const QByteArray& data) -> qsizetype;
+
+  /// Offset of the next unread byte (for error reports)
+  [[nodiscard]] auto position() const -> qsizetype {
+    return m_pos;
+  }
+
+ private:
+  auto readVarint(quint64& value) -> bool;
+  auto readBytes(qsizetype length, QByteArray& out) -> bool;
+
+  QByteArray m_data;
+  qsizetype m_pos{0};
+  QHash<quint64, QString> m_strings;
+  QHash<quint64, quint64> m_threads;
+  qint64 m_lastTimestampMs{0};
+};
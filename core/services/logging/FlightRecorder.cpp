@@ -0,0 +1,191 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FlightRecorder.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+constexpr char kMagic[4] = {'C', 'S', 'F', 'R'};
+constexpr std::size_t kHeaderBytes = 64;
+
+const QString kCrashSuffix = QStringLiteral(".crash");
+
+template <typename T>
+auto readField(const QByteArray& data, std::size_t offset) -> T {
+  T value;
+  std::memcpy(&value, data.constData() + offset, sizeof(T));
+  return value;
+}
+}  // namespace
+
+bool FlightRecorder::open(const QString& path, quint32 slotCount, QString& error) {
+  if (isOpen()) {
+    return true;
+  }
+  slotCount = std::max<quint32>(slotCount, 16);
+
+  // Keep the ring of a run that ended abnormally before it is overwritten
+  QFile previous(path);
+  if (previous.open(QIODevice::ReadOnly)) {
+    const QByteArray data = previous.read(kHeaderBytes);
+    previous.close();
+    if (data.size() == static_cast<qsizetype>(kHeaderBytes) &&
+        std::memcmp(data.constData(), kMagic, sizeof(kMagic)) == 0 && !wasClean(data)) {
+      m_crashDump = path + kCrashSuffix;
+      QFile::remove(m_crashDump);
+      if (!QFile::rename(path, m_crashDump)) {
+        m_crashDump.clear();
+      }
+    }
+  }
+
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+    error = QStringLiteral("open_failed");
+    return false;
+  }
+  const qint64 size = static_cast<qint64>(kHeaderBytes) + qint64(slotCount) * kSlotSize;
+  if (!m_file.resize(size)) {
+    error = QStringLiteral("resize_failed");
+    m_file.close();
+    return false;
+  }
+  // Pages fault in as they are first written; the zero-filled file reads as an empty ring
+  uchar* base = m_file.map(0, size);
+  if (base == nullptr) {
+    error = QStringLiteral("map_failed");
+    m_file.close();
+    return false;
+  }
+
+  auto* header = reinterpret_cast<Header*>(base);
+  std::memcpy(header->magic, kMagic, sizeof(kMagic));
+  header->version = kVersion;
+  header->slotCount = slotCount;
+  header->slotSize = kSlotSize;
+  header->pid = QCoreApplication::applicationPid();
+  header->startedMs = QDateTime::currentMSecsSinceEpoch();
+  header->nextSequence.store(0, std::memory_order_relaxed);
+  header->clean.store(0, std::memory_order_release);
+
+  m_slotCount = slotCount;
+  m_header = header;
+  m_slots = reinterpret_cast<Slot*>(base + kHeaderBytes);
+  return true;
+}
+
+void FlightRecorder::record(qint64 timestampMs, int level, quint64 threadId,
+                            const QString& component, const QString& message) {
+  if (m_slots == nullptr) {
+    return;
+  }
+  const quint64 sequence = m_header->nextSequence.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = m_slots[sequence % m_slotCount];
+
+  // Cleared first and published last: a crash part-way leaves the slot unreadable, not torn
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const auto componentLength =
+      static_cast<quint8>(std::min<qsizetype>(component.size(), 64));
+  const auto messageLength = static_cast<quint16>(
+      std::min<qsizetype>(message.size(), qsizetype(kTextUnits) - componentLength));
+  slot.timestampMs = timestampMs;
+  slot.threadId = threadId;
+  slot.level = static_cast<quint8>(level);
+  slot.componentLength = componentLength;
+  slot.messageLength = messageLength;
+  std::memcpy(slot.text, component.utf16(), componentLength * sizeof(char16_t));
+  std::memcpy(slot.text + componentLength, message.utf16(), messageLength * sizeof(char16_t));
+
+  slot.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+void FlightRecorder::markClean() {
+  if (m_header != nullptr) {
+    m_header->clean.store(1, std::memory_order_release);
+  }
+}
+
+bool FlightRecorder::wasClean(const QByteArray& data) {
+  if (data.size() < static_cast<qsizetype>(kHeaderBytes)) {
+    return false;
+  }
+  return readField<quint32>(data, offsetof(Header, clean)) != 0;
+}
+
+bool FlightRecorder::readRecords(const QByteArray& data, std::vector<BinaryLogEntry>& records,
+                                 QString& error) {
+  records.clear();
+  if (data.size() < static_cast<qsizetype>(kHeaderBytes)) {
+    error = QStringLiteral("truncated");
+    return false;
+  }
+  if (std::memcmp(data.constData(), kMagic, sizeof(kMagic)) != 0) {
+    error = QStringLiteral("bad_magic");
+    return false;
+  }
+  const auto version = readField<quint32>(data, offsetof(Header, version));
+  const auto slotSize = readField<quint32>(data, offsetof(Header, slotSize));
+  if (version != kVersion || slotSize != kSlotSize) {
+    error = QStringLiteral("unsupported_version");
+    return false;
+  }
+  const auto slotCount = readField<quint32>(data, offsetof(Header, slotCount));
+  if (data.size() < static_cast<qsizetype>(kHeaderBytes + std::size_t(slotCount) * kSlotSize)) {
+    error = QStringLiteral("truncated");
+    return false;
+  }
+
+  std::vector<std::pair<quint64, BinaryLogEntry>> ordered;
+  for (quint32 i = 0; i < slotCount; ++i) {
+    const std::size_t offset = kHeaderBytes + std::size_t(i) * kSlotSize;
+    const auto sequence = readField<quint64>(data, offset + offsetof(Slot, sequence));
+    const auto componentLength = readField<quint8>(data, offset + offsetof(Slot, componentLength));
+    const auto messageLength = readField<quint16>(data, offset + offsetof(Slot, messageLength));
+    if (sequence == 0 || std::size_t(componentLength) + messageLength > kTextUnits) {
+      continue;  // Empty, or torn by a crash mid-write
+    }
+    const auto* text =
+        reinterpret_cast<const char16_t*>(data.constData() + offset + offsetof(Slot, text));
+    BinaryLogEntry entry;
+    entry.timestampMs = readField<qint64>(data, offset + offsetof(Slot, timestampMs));
+    entry.level = readField<quint8>(data, offset + offsetof(Slot, level));
+    entry.threadId = readField<quint64>(data, offset + offsetof(Slot, threadId));
+    entry.component = QString::fromUtf16(text, componentLength);
+    entry.message = QString::fromUtf16(text + componentLength, messageLength);
+    ordered.emplace_back(sequence, std::move(entry));
+  }
+
+  std::sort(ordered.begin(), ordered.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  records.reserve(ordered.size());
+  for (auto& item : ordered) {
+    records.push_back(std::move(item.second));
+  }
+  return true;
+}
@@ -0,0 +1,145 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "BinaryLog.h"
+
+/**
+ * @class FlightRecorder
+ * @brief Crash flight recorder: the last N log records in a memory-mapped ring
+ *
+ * The ring lives in a file mapped with QFile::map() (MAP_SHARED). Writing a
+ * record is one atomic increment and a memcpy into the page cache. There
+ * is no syscall, no allocation and no lock. If the process crashes or is
+ * OOM-killed, the kernel still writes the dirty pages back, so the ring
+ * holds the records from just before the end. This includes records the
+ * asynchronous Logger had queued but not yet written. Power loss can lose
+ * the pages not yet written back.
+ *
+ * open() checks the previous ring. If it was not closed cleanly
+ * (markClean()), it is renamed to "<path>.crash" before a fresh ring is
+ * created. "crankshaft-logdecode --flight-recorder <file>" dumps either file.
+ *
+ * LAYOUT:
+ * ───────
+ * A 64-byte Header is followed by slotCount fixed-size Slots. Text is
+ * stored as raw UTF-16 (component, then message), truncated to the slot,
+ * so recording never converts or allocates. A slot's sequence is cleared
+ * while it is written and set last, so a record torn by a crash is
+ * skipped by the reader.
+ *
+ * THREAD SAFETY:
+ * - record() may be called from any thread. Two writers share a slot only
+ *   if one is a full lap of the ring behind the other; that slot may then
+ *   hold either record.
+ */
+class FlightRecorder {
+ public:
+  static constexpr quint32 kVersion = 1;
+  static constexpr quint32 kSlotSize = 512;
+  static constexpr quint32 kDefaultSlotCount = 4096;
+
+  FlightRecorder() = default;
+
+  FlightRecorder(const FlightRecorder&) = delete;
+  FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+  /**
+   * @brief Map a fresh ring at path, preserving an uncleanly closed one as "<path>.crash"
+   * @param error Set to "open_failed", "resize_failed" or "map_failed" on failure
+   */
+  auto open(const QString& path, quint32 slotCount, QString& error) -> bool;
+
+  /// Path of the preserved ring if open() found the previous run ended abnormally
+  [[nodiscard]] auto previousCrashDump() const -> QString {
+    return m_crashDump;
+  }
+
+  [[nodiscard]] auto isOpen() const -> bool {
+    return m_slots != nullptr;
+  }
+
+  /**
+   * @brief Copy one record into the ring (lock-free, no syscalls, any thread)
+   */
+  void record(qint64 timestampMs, int level, quint64 threadId, const QString& component,
+              const QString& message);
+
+  /// Flag the ring as closed cleanly (normal shutdown); recording may continue
+  void markClean();
+
+  /**
+   * @brief Decode a ring file's contents, oldest record first
+   * @param error Set to "bad_magic", "unsupported_version" or "truncated" on failure
+   */
+  static auto readRecords(const QByteArray& data, std::vector<BinaryLogEntry>& records,
+                          QString& error) -> bool;
+
+  /**
+   * @brief Whether the ring in data was marked clean
+   */
+  static auto wasClean(const QByteArray& data) -> bool;
+
+ private:
+  struct Header {
+    char magic[4];
+    quint32 version;
+    quint32 slotCount;
+    quint32 slotSize;
+    qint64 pid;
+    qint64 startedMs;
+    std::atomic<quint64> nextSequence;
+    std::atomic<quint32> clean;
+    char reserved[20];
+  };
+
+  static constexpr std::size_t kSlotFixedBytes = 32;
+  static constexpr std::size_t kTextUnits = (kSlotSize - kSlotFixedBytes) / sizeof(char16_t);
+
+  struct Slot {
+    std::atomic<quint64> sequence;  // 0 while empty or being written, else record number + 1
+    qint64 timestampMs;
+    quint64 threadId;
+    quint8 level;
+    quint8 componentLength;  // UTF-16 units
+    quint16 messageLength;   // UTF-16 units
+    quint32 reserved;
+    char16_t text[kTextUnits];
+  };
+
+  static_assert(sizeof(Header) == 64, "FlightRecorder header must stay 64 bytes");
+  static_assert(sizeof(Slot) == kSlotSize, "FlightRecorder slot size mismatch");
+  static_assert(std::atomic<quint64>::is_always_lock_free,
+                "FlightRecorder needs lock-free 64-bit atomics in shared memory");
+
+  QFile m_file;
+  Header* m_header{nullptr};
+  Slot* m_slots{nullptr};
+  quint32 m_slotCount{0};
+  QString m_crashDump;
+};
@@ -0,0 +1,213 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "LogArchiver.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef CRANKSHAFT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+/// Read size per compression step; the stop flag is checked between steps
+constexpr qint64 kCompressChunkBytes = 64 * 1024;
+/// Nice value for the worker: compression must never compete with audio/video
+constexpr int kWorkerNice = 10;
+
+const QString kCompressedSuffix = QStringLiteral(".gz");
+const QString kTempSuffix = QStringLiteral(".tmp");
+}  // namespace
+
+LogArchiver::LogArchiver() {
+  m_worker = std::thread([this]() { run(); });
+}
+
+LogArchiver::~LogArchiver() {
+  shutdown();
+}
+
+void LogArchiver::setRetention(const Retention& retention) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_retention = retention;
+}
+
+LogArchiver::Retention LogArchiver::retention() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_retention;
+}
+
+void LogArchiver::schedule(const QString& logFile) {
+  if (logFile.isEmpty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_pending.contains(logFile)) {
+      m_pending.append(logFile);
+    }
+  }
+  m_wake.notify_one();
+}
+
+void LogArchiver::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping.store(true);
+  }
+  m_wake.notify_one();
+  if (m_worker.joinable()) {
+    m_worker.join();
+  }
+}
+
+bool LogArchiver::compressionAvailable() {
+#ifdef CRANKSHAFT_HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+void LogArchiver::run() {
+#ifdef Q_OS_LINUX
+  pthread_setname_np(pthread_self(), "crankshaft-logz");
+  setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), kWorkerNice);
+#endif
+
+  for (;;) {
+    QString logFile;
+    Retention retention;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this]() { return m_stopping.load() || !m_pending.isEmpty(); });
+      if (m_stopping.load()) {
+        return;
+      }
+      logFile = m_pending.takeFirst();
+      retention = m_retention;
+    }
+    sweep(logFile, retention);
+  }
+}
+
+void LogArchiver::sweep(const QString& logFile, const Retention& retention) {
+  const QFileInfo active(logFile);
+  const QString prefix = active.fileName() + QLatin1Char('.');
+  QDir dir = active.dir();
+
+  // Compress first so retention counts the compressed sizes
+  const QStringList names = dir.entryList({prefix + QLatin1Char('*')}, QDir::Files);
+  for (const QString& name : names) {
+    if (m_stopping.load()) {
+      return;
+    }
+    if (name.endsWith(kTempSuffix)) {
+      dir.remove(name);  // Left behind by an interrupted compression
+    } else if (retention.compress && compressionAvailable() &&
+               !name.endsWith(kCompressedSuffix)) {
+      compress(dir.filePath(name));
+    }
+  }
+
+  // Newest first: keep segments until a limit is reached, delete the rest
+  QFileInfoList segments =
+      dir.entryInfoList({prefix + QLatin1Char('*')}, QDir::Files, QDir::Time);
+  const QDateTime oldest = retention.maxAgeDays > 0
+                               ? QDateTime::currentDateTime().addDays(-retention.maxAgeDays)
+                               : QDateTime();
+  qint64 totalBytes = 0;
+  int kept = 0;
+  for (const QFileInfo& segment : segments) {
+    if (segment.fileName().endsWith(kTempSuffix)) {
+      continue;
+    }
+    totalBytes += segment.size();
+    const bool tooMany = retention.maxFiles > 0 && kept >= retention.maxFiles;
+    const bool tooLarge = retention.maxTotalBytes > 0 && totalBytes > retention.maxTotalBytes;
+    const bool tooOld = oldest.isValid() && segment.lastModified() < oldest;
+    if (tooMany || tooLarge || tooOld) {
+      QFile::remove(segment.filePath());
+    } else {
+      ++kept;
+    }
+  }
+}
+
+bool LogArchiver::compress(const QString& source) {
+#ifdef CRANKSHAFT_HAVE_ZLIB
+  QFile input(source);
+  if (!input.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  const QString target = source + kCompressedSuffix;
+  const QString temp = target + kTempSuffix;
+  gzFile output = gzopen(QFile::encodeName(temp).constData(), "wb6");
+  if (output == nullptr) {
+    return false;
+  }
+
+  bool ok = true;
+  QByteArray chunk;
+  while (ok && !input.atEnd()) {
+    if (m_stopping.load()) {
+      ok = false;
+      break;
+    }
+    chunk = input.read(kCompressChunkBytes);
+    ok = !chunk.isEmpty() &&
+         gzwrite(output, chunk.constData(), static_cast<unsigned>(chunk.size())) == chunk.size();
+  }
+  ok = gzclose(output) == Z_OK && ok;
+  input.close();
+
+  if (!ok) {
+    QFile::remove(temp);
+    return false;
+  }
+  // Keep the segment's time so age-based retention still applies to the archive
+  const QDateTime modified = QFileInfo(source).lastModified();
+  QFile::remove(target);
+  if (!QFile::rename(temp, target)) {
+    QFile::remove(temp);
+    return false;
+  }
+  QFile archive(target);
+  if (archive.open(QIODevice::ReadWrite)) {
+    archive.setFileTime(modified, QFileDevice::FileModificationTime);
+  }
+  QFile::remove(source);
+  return true;
+#else
+  Q_UNUSED(source);
+  return false;
+#endif
+}
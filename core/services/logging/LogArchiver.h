@@ -0,0 +1,97 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Background compression and retention for rotated log segments
+ *
+ * The Logger's writer thread only renames the full log file to
+ * "<file>.<yyyyMMdd_hhmmss>" and calls schedule(). Everything slow happens
+ * here, on a low-priority thread:
+ * - Each uncompressed segment of that log is gzipped to "<segment>.gz".
+ *   It is written to a ".tmp" file first and renamed into place, then the
+ *   original is removed.
+ * - Old segments are deleted until the retention limits hold: file count,
+ *   total bytes and age.
+ *
+ * Only the segments of the scheduled log file are touched. The active file
+ * is never compressed or deleted. A sweep also picks up segments left
+ * uncompressed by an earlier run that stopped mid-way.
+ *
+ * Compression needs zlib (CRANKSHAFT_HAVE_ZLIB). Without it, segments stay
+ * uncompressed and only retention applies.
+ *
+ * THREAD SAFETY:
+ * - setRetention() and schedule() may be called from any thread
+ */
+class LogArchiver {
+ public:
+  /// Limits for rotated segments; a value of 0 disables that limit
+  struct Retention {
+    int maxFiles{5};
+    qint64 maxTotalBytes{0};
+    int maxAgeDays{0};
+    bool compress{true};
+  };
+
+  LogArchiver();
+  ~LogArchiver();
+
+  LogArchiver(const LogArchiver&) = delete;
+  LogArchiver& operator=(const LogArchiver&) = delete;
+
+  void setRetention(const Retention& retention);
+  [[nodiscard]] auto retention() const -> Retention;
+
+  /**
+   * @brief Queue a compression and retention sweep of one log file's rotated segments
+   * @param logFile Path of the active log file (its segments are "<logFile>.*")
+   */
+  void schedule(const QString& logFile);
+
+  /**
+   * @brief Stop the worker; an unfinished compression is abandoned and redone by a later sweep
+   */
+  void shutdown();
+
+  /// Whether gzip compression is built in
+  static auto compressionAvailable() -> bool;
+
+ private:
+  void run();
+  void sweep(const QString& logFile, const Retention& retention);
+  /// gzip source into source + ".gz"; false if stopped or on error
+  auto compress(const QString& source) -> bool;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  QStringList m_pending;
+  Retention m_retention;
+  std::atomic_bool m_stopping{false};
+  std::thread m_worker;
+};
@@ -20,26 +20,147 @@
 #include "Logger.h"
 
 #include <QDateTime>
-#include <QDebug>
-#include <QDir>
-#include <QFile>
 #include <QFileInfo>
 #include <QJsonDocument>
-#include <QTextStream>
 #include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#endif
+
+#include "MpscRingBuffer.h"
+
+namespace {
+/// Records written per batch before the writer checks its other duties
+constexpr std::size_t kMaxBatchRecords = 512;
+/// Writer wake-up period when nobody signals it (bounds unflushed time)
+constexpr auto kWriterTick = std::chrono::milliseconds(20);
+
+/// Component used by debug()/info()/... and CRANKSHAFT_LOG_DEBUG
+auto defaultComponent() -> const QString& {
+  static const QString component = QStringLiteral("Crankshaft");
+  return component;
+}
+/// Longest "[Name]" message prefix treated as a component
+constexpr qsizetype kMaxPrefixLength = 64;
+
+thread_local bool t_realtimeThread = false;
+
+/// "Name" from a message starting with "[Name]", or an empty view
+auto messagePrefix(const QString& message) -> QStringView {
+  if (!message.startsWith(QLatin1Char('['))) {
+    return {};
+  }
+  const qsizetype end = message.indexOf(QLatin1Char(']'));
+  if (end < 2 || end > kMaxPrefixLength) {
+    return {};
+  }
+  return QStringView(message).mid(1, end - 1);
+}
+}  // namespace
 
 Logger& Logger::instance() {
   static Logger instance;
   return instance;
 }
 
+Logger::Logger()
+    : m_queue(std::make_unique<MpscRingBuffer<Record>>(kQueueCapacity)),
+      m_archiver(std::make_unique<LogArchiver>()) {
+  m_running.store(true);
+  m_writer = std::thread([this]() { writerLoop(); });
+}
+
+Logger::~Logger() {
+  shutdown();
+}
+
 void Logger::setLevel(Level level) {
-  m_level = level;
+  QWriteLocker locker(&m_componentLock);
+  m_level.store(level, std::memory_order_relaxed);
+  updateFloorLevel();
+}
+
+Logger::Level Logger::level() const {
+  return m_level.load(std::memory_order_relaxed);
+}
+
+void Logger::setComponentLevel(const QString& component, Level level) {
+  QWriteLocker locker(&m_componentLock);
+  m_componentLevels.insert(component, level);
+  updateFloorLevel();
+}
+
+void Logger::clearComponentLevel(const QString& component) {
+  QWriteLocker locker(&m_componentLock);
+  m_componentLevels.remove(component);
+  updateFloorLevel();
+}
+
+void Logger::setComponentLevels(const QVariantMap& levels) {
+  QWriteLocker locker(&m_componentLock);
+  m_componentLevels.clear();
+  for (auto it = levels.constBegin(); it != levels.constEnd(); ++it) {
+    const QString name = it.value().toString();
+    const Level level = levelFromString(name, Level::Debug);
+    if (level == Level::Debug && name.compare(QLatin1String("debug"), Qt::CaseInsensitive) != 0) {
+      continue;  // Unknown level name
+    }
+    m_componentLevels.insert(it.key(), level);
+  }
+  updateFloorLevel();
+}
+
+QVariantMap Logger::componentLevels() const {
+  QReadLocker locker(&m_componentLock);
+  QVariantMap levels;
+  for (auto it = m_componentLevels.constBegin(); it != m_componentLevels.constEnd(); ++it) {
+    levels.insert(it.key(), levelName(it.value()));
+  }
+  return levels;
+}
+
+void Logger::updateFloorLevel() {
+  Level floor = m_level.load(std::memory_order_relaxed);
+  for (const Level level : std::as_const(m_componentLevels)) {
+    floor = std::min(floor, level);
+  }
+  m_hasComponentLevels.store(!m_componentLevels.isEmpty(), std::memory_order_relaxed);
+  m_floorLevel.store(floor, std::memory_order_relaxed);
+}
+
+bool Logger::componentAllows(Level level, const QString& component,
+                             const QString& message) const {
+  QReadLocker locker(&m_componentLock);
+  Level threshold = m_level.load(std::memory_order_relaxed);
+  const auto found = m_componentLevels.constFind(component);
+  if (found != m_componentLevels.constEnd()) {
+    threshold = found.value();
+  } else if (component == defaultComponent()) {
+    if (message.isEmpty()) {
+      return true;  // Not formatted yet: the "[Name]" prefix is checked in logStructured()
+    }
+    const QStringView prefix = messagePrefix(message);
+    for (auto it = m_componentLevels.constBegin();
+         !prefix.isEmpty() && it != m_componentLevels.constEnd(); ++it) {
+      if (prefix == it.key()) {
+        threshold = it.value();
+        break;
+      }
+    }
+  }
+  return level >= threshold;
 }
 
 void Logger::setLogFile(const QString& filePath) {
+  std::lock_guard<std::mutex> lock(m_sinkMutex);
+  m_file.close();
   m_logFile = filePath;
   m_currentLogSize = 0;
+  m_openFailureReported = false;
 
   // Check initial log file size
   if (!m_logFile.isEmpty()) {
@@ -47,17 +168,163 @@ void Logger::setLogFile(const QString& filePath) {
     if (fileInfo.exists()) {
       m_currentLogSize = fileInfo.size();
     }
+    // Finish segments an earlier run rotated but did not compress or expire
+    m_archiver->schedule(m_logFile);
   }
 }
 
+void Logger::setRetention(const LogArchiver::Retention& retention) {
+  m_archiver->setRetention(retention);
+  std::lock_guard<std::mutex> lock(m_sinkMutex);
+  m_archiver->schedule(m_logFile);
+}
+
 void Logger::setJsonFormat(bool enabled) {
+  std::lock_guard<std::mutex> lock(m_sinkMutex);
   m_jsonFormat = enabled;
 }
 
+void Logger::setBinaryFileFormat(bool enabled) {
+  std::lock_guard<std::mutex> lock(m_sinkMutex);
+  if (m_binaryFile != enabled) {
+    // Reopen so a binary session always starts with a RESET frame
+    m_file.close();
+    m_binaryFile = enabled;
+  }
+}
+
 void Logger::setMaxLogSize(qint64 bytes) {
+  std::lock_guard<std::mutex> lock(m_sinkMutex);
   m_maxLogSize = bytes;
 }
 
+void Logger::setConsoleOutput(bool enabled) {
+  std::lock_guard<std::mutex> lock(m_sinkMutex);
+  m_consoleOutput = enabled;
+}
+
+void Logger::setOverflowPolicy(OverflowPolicy policy) {
+  m_overflowPolicy.store(policy, std::memory_order_relaxed);
+}
+
+Logger::OverflowPolicy Logger::overflowPolicy() const {
+  return m_overflowPolicy.load(std::memory_order_relaxed);
+}
+
+bool Logger::enableFlightRecorder(const QString& path, quint32 slotCount, QString& error) {
+  std::lock_guard<std::mutex> lock(m_sinkMutex);
+  if (m_flightRecording.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  if (!m_flightRecorder.open(path, slotCount, error)) {
+    return false;
+  }
+  m_flightRecording.store(true, std::memory_order_release);
+  return true;
+}
+
+QString Logger::previousFlightRecording() const {
+  std::lock_guard<std::mutex> lock(m_sinkMutex);
+  return m_flightRecorder.previousCrashDump();
+}
+
+void Logger::flightTrace(const QString& component, const QString& message) {
+  if (m_flightRecording.load(std::memory_order_acquire)) {
+    m_flightRecorder.record(QDateTime::currentMSecsSinceEpoch(), static_cast<int>(Level::Debug),
+                            reinterpret_cast<quintptr>(QThread::currentThreadId()), component,
+                            message);
+  }
+}
+
+Logger::Level Logger::levelFromString(const QString& name, Level fallback) {
+  const QString lower = name.toLower();
+  if (lower == QLatin1String("debug")) {
+    return Level::Debug;
+  }
+  if (lower == QLatin1String("info")) {
+    return Level::Info;
+  }
+  if (lower == QLatin1String("warning") || lower == QLatin1String("warn")) {
+    return Level::Warning;
+  }
+  if (lower == QLatin1String("error")) {
+    return Level::Error;
+  }
+  if (lower == QLatin1String("fatal")) {
+    return Level::Fatal;
+  }
+  return fallback;
+}
+
+QString Logger::levelName(Level level) {
+  switch (level) {
+    case Level::Debug:
+      return QStringLiteral("debug");
+    case Level::Info:
+      return QStringLiteral("info");
+    case Level::Warning:
+      return QStringLiteral("warning");
+    case Level::Error:
+      return QStringLiteral("error");
+    case Level::Fatal:
+      return QStringLiteral("fatal");
+  }
+  return QStringLiteral("unknown");
+}
+
+void Logger::setRealtimeThread(bool realtime) {
+  t_realtimeThread = realtime;
+}
+
+bool Logger::isRealtimeThread() {
+  return t_realtimeThread;
+}
+
+quint64 Logger::droppedRecords() const {
+  return m_dropped.load(std::memory_order_relaxed);
+}
+
+quint64 Logger::suppressedRecords() const {
+  return m_suppressed.load(std::memory_order_relaxed);
+}
+
+bool Logger::CallSite::sample(quint64 n) {
+  const quint64 call = m_calls.fetch_add(1, std::memory_order_relaxed);
+  if (n <= 1 || call % n == 0) {
+    return true;
+  }
+  suppress();
+  return false;
+}
+
+bool Logger::CallSite::rateLimit(double perSecond, double burst) {
+  // Never wait on another thread logging from the same site: count it as suppressed
+  std::unique_lock<std::mutex> lock(m_bucketMutex, std::try_to_lock);
+  if (lock.owns_lock()) {
+    if (!m_bucketConfigured) {
+      m_bucket = TokenBucket(perSecond, burst);
+      m_bucketConfigured = true;
+    }
+    const qint64 nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch())
+                             .count();
+    if (m_bucket.tryConsume(1.0, nowNs)) {
+      return true;
+    }
+  }
+  suppress();
+  return false;
+}
+
+quint64 Logger::CallSite::takeSuppressed() {
+  return m_suppressed.exchange(0, std::memory_order_relaxed);
+}
+
+void Logger::CallSite::suppress() {
+  m_suppressed.fetch_add(1, std::memory_order_relaxed);
+  Logger::instance().m_suppressed.fetch_add(1, std::memory_order_relaxed);
+}
+
 void Logger::debug(const QString& message) {
   log(Level::Debug, message);
 }
@@ -80,35 +347,301 @@ void Logger::fatal(const QString& message) {
 
 void Logger::logStructured(Level level, const QString& component, const QString& message,
                            const QJsonObject& context) {
-  if (level < m_level) return;
+  if (!isEnabled(level)) return;
+  if (m_hasComponentLevels.load(std::memory_order_relaxed) &&
+      !componentAllows(level, component, message)) {
+    return;
+  }
 
-  QJsonObject logEntry = createLogEntry(level, component, message, context);
-  QJsonDocument doc(logEntry);
+  // Only cheap captures here; formatting and I/O happen on the writer thread
+  Record record;
+  record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+  record.level = level;
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  record.component = component;
+  record.message = message;
+  record.context = context;
+  if (m_flightRecording.load(std::memory_order_acquire)) {
+    m_flightRecorder.record(record.timestampMs, static_cast<int>(level), record.threadId,
+                            component, message);
+  }
+  enqueue(record);
 
-  QString logMessage;
-  if (m_jsonFormat) {
-    logMessage = QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
-  } else {
-    // Fallback to readable format
-    logMessage =
-        QString("[%1] %2 (%3): %4")
-            .arg(logEntry["timestamp"].toString(), levelToString(level), component, message);
+  if (level == Level::Fatal) {
+    flush();
+  }
+}
+
+void Logger::enqueue(Record& record) {
+  if (!m_running.load(std::memory_order_acquire)) {
+    // Writer stopped (shutdown or static destruction): write synchronously
+    writeRecords({std::move(record)});
+    return;
+  }
+
+  const bool urgent = record.level >= Level::Warning;
+  while (!m_queue->tryPush(record)) {
+    if (m_overflowPolicy.load(std::memory_order_relaxed) == OverflowPolicy::Drop ||
+        t_realtimeThread || std::this_thread::get_id() == m_writer.get_id()) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    m_wake.notify_one();
+    std::this_thread::yield();
+  }
+  m_enqueued.fetch_add(1, std::memory_order_release);
+
+  // Routine records wait for the next tick so writes batch up; wake early
+  // for warnings and when the buffer is filling
+  if (m_writerIdle.load(std::memory_order_relaxed) &&
+      (urgent || m_queue->sizeApprox() >= m_queue->capacity() / 4)) {
+    m_wake.notify_one();
+  }
+}
+
+bool Logger::flush(int timeoutMs) {
+  const quint64 target = m_enqueued.load(std::memory_order_acquire);
+  if (!m_running.load(std::memory_order_acquire) ||
+      std::this_thread::get_id() == m_writer.get_id()) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lock(m_wakeMutex);
+  m_wake.notify_one();
+  return m_flushed.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, target]() {
+    return m_processed.load(std::memory_order_acquire) >= target ||
+           !m_running.load(std::memory_order_acquire);
+  });
+}
+
+void Logger::shutdown() {
+  // A ring without this flag is kept as "<path>.crash" by the next run
+  if (m_flightRecording.load(std::memory_order_acquire)) {
+    m_flightRecorder.markClean();
+  }
+  if (!m_running.load(std::memory_order_acquire)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_stopping.store(true, std::memory_order_release);
+  }
+  m_wake.notify_one();
+  if (m_writer.joinable()) {
+    m_writer.join();
+  }
+  m_running.store(false, std::memory_order_release);
+  m_flushed.notify_all();
+  // Pending compression is picked up again by the next run's first sweep
+  m_archiver->shutdown();
+}
+
+void Logger::writerLoop() {
+#ifdef Q_OS_LINUX
+  pthread_setname_np(pthread_self(), "crankshaft-log");
+#endif
+  std::vector<Record> batch;
+  batch.reserve(kMaxBatchRecords);
+  Record record;
+
+  for (;;) {
+    while (batch.size() < kMaxBatchRecords && m_queue->tryPop(record)) {
+      batch.push_back(std::move(record));
+    }
+    if (!batch.empty()) {
+      writeRecords(batch);
+      {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_processed.fetch_add(batch.size(), std::memory_order_release);
+      }
+      m_flushed.notify_all();
+      batch.clear();
+      continue;
+    }
+
+    reportDropped();
+    if (m_stopping.load(std::memory_order_acquire)) {
+      // Producers that raced the stop flag have published by now; take their records too
+      if (m_queue->sizeApprox() == 0) {
+        return;
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_writerIdle.store(true, std::memory_order_relaxed);
+    m_wake.wait_for(lock, kWriterTick, [this]() {
+      return m_stopping.load(std::memory_order_acquire) || m_queue->sizeApprox() > 0;
+    });
+    m_writerIdle.store(false, std::memory_order_relaxed);
+  }
+}
+
+void Logger::reportDropped() {
+  const quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+  if (dropped == m_droppedReported) {
+    return;
+  }
+  Record record;
+  record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+  record.level = Level::Warning;
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  record.component = QStringLiteral("Logger");
+  record.message = QString("%1 log records dropped (buffer full)").arg(dropped - m_droppedReported);
+  record.context["dropped_total"] = static_cast<qint64>(dropped);
+  m_droppedReported = dropped;
+  writeRecords({std::move(record)});
+}
+
+void Logger::writeRecords(const std::vector<Record>& records) {
+  std::lock_guard<std::mutex> lock(m_sinkMutex);
+
+  const bool fileEnabled = !m_logFile.isEmpty();
+  const bool binaryFile = fileEnabled && m_binaryFile;
+
+  QByteArray lines;
+  if (m_consoleOutput || (fileEnabled && !binaryFile)) {
+    for (const Record& record : records) {
+      lines += formatRecord(record);
+      lines += '\n';
+    }
   }
 
   // Console output
-  qDebug().noquote() << logMessage;
+  if (m_consoleOutput) {
+    std::fwrite(lines.constData(), 1, static_cast<std::size_t>(lines.size()), stderr);
+    std::fflush(stderr);
+  }
 
-  // File output
-  if (!m_logFile.isEmpty()) {
-    rotateLogIfNeeded();
-    QFile file(m_logFile);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
-      QTextStream stream(&file);
-      stream << logMessage << "\n";
-      m_currentLogSize += logMessage.length() + 1;  // +1 for newline
-      file.close();
+  // File output: kept open between batches
+  if (!fileEnabled || !openLogFile()) {
+    return;
+  }
+  QByteArray payload = filePayload(records, lines);
+  // Rotate before the file would pass the limit; payload is the exact encoded size
+  if (m_maxLogSize > 0 && m_currentLogSize > 0 &&
+      m_currentLogSize + payload.size() > m_maxLogSize) {
+    rotateLog();
+    if (!openLogFile()) {
+      return;
+    }
+    payload = filePayload(records, lines);  // Binary: re-encode against the new file's tables
+  }
+  m_file.write(payload);
+  m_file.flush();
+  m_currentLogSize += payload.size();
+}
+
+bool Logger::openLogFile() {
+  if (m_file.isOpen()) {
+    return true;
+  }
+  m_file.setFileName(m_logFile);
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    reportOpenFailure();
+    return false;
+  }
+  m_currentLogSize = m_file.size();
+  if (m_currentLogSize > 0 && (!logFileMatchesFormat() || !trimIncompleteTail())) {
+    // core.logging.format changed, or a damaged tail could not be cut off: appending
+    // would leave a file nothing can decode
+    rotateLog();
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+      reportOpenFailure();
+      return false;
     }
+    m_currentLogSize = m_file.size();
+  }
+  m_openFailureReported = false;
+  if (m_binaryFile) {
+    // New session: fresh intern tables, header only at the start of a file
+    m_encoder.reset();
+    m_binaryHeaderPending = m_currentLogSize == 0;
+  }
+  return true;
+}
+
+bool Logger::logFileMatchesFormat() const {
+  QFile probe(m_logFile);
+  if (!probe.open(QIODevice::ReadOnly)) {
+    return true;
+  }
+  const QByteArray header = BinaryLogEncoder::fileHeader();
+  const QByteArray head = probe.read(header.size());
+  return m_binaryFile ? head == header : !head.startsWith(header.left(4));
+}
+
+bool Logger::trimIncompleteTail() {
+  if (!m_binaryFile) {
+    return true;
+  }
+  QFile probe(m_logFile);
+  if (!probe.open(QIODevice::ReadOnly)) {
+    return true;
+  }
+  // A previous run killed mid-write leaves a partial frame; records appended after it
+  // could never be decoded, so cut back to the last complete one
+  const qsizetype intact = BinaryLogDecoder::intactLength(probe.readAll());
+  probe.close();
+  if (intact >= m_currentLogSize) {
+    return true;
   }
+  if (intact == 0 || !m_file.resize(intact)) {
+    return false;
+  }
+  warnOnStderr(QString("Dropped %1 bytes of incomplete data at the end of log file %2")
+                   .arg(m_currentLogSize - intact)
+                   .arg(m_logFile));
+  m_currentLogSize = intact;
+  return true;
+}
+
+void Logger::reportOpenFailure() {
+  if (m_openFailureReported) {
+    return;
+  }
+  m_openFailureReported = true;
+  warnOnStderr(QString("Cannot open log file %1 (%2); file logging is off until it opens")
+                   .arg(m_logFile, m_file.errorString()));
+}
+
+void Logger::warnOnStderr(const QString& message) const {
+  // The file is the sink in trouble, so this goes to stderr even without console output
+  Record record;
+  record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+  record.level = Level::Warning;
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  record.component = QStringLiteral("Logger");
+  record.message = message;
+  const QByteArray line = formatRecord(record) + '\n';
+  std::fwrite(line.constData(), 1, static_cast<std::size_t>(line.size()), stderr);
+  std::fflush(stderr);
+}
+
+QByteArray Logger::filePayload(const std::vector<Record>& records, const QByteArray& lines) {
+  if (!m_binaryFile) {
+    return lines;
+  }
+  QByteArray payload;
+  if (m_binaryHeaderPending) {
+    payload = BinaryLogEncoder::fileHeader();
+    m_binaryHeaderPending = false;
+  }
+  for (const Record& record : records) {
+    m_encoder.append(payload, record.timestampMs, static_cast<int>(record.level), record.threadId,
+                     record.component, record.message, record.context);
+  }
+  return payload;
+}
+
+QByteArray Logger::formatRecord(const Record& record) const {
+  if (m_jsonFormat) {
+    return QJsonDocument(createLogEntry(record)).toJson(QJsonDocument::Compact);
+  }
+  // Fallback to readable format
+  return QString("[%1] %2 (%3): %4")
+      .arg(QDateTime::fromMSecsSinceEpoch(record.timestampMs).toString(Qt::ISODate),
+           levelToString(record.level), record.component, record.message)
+      .toUtf8();
 }
 
 void Logger::debugContext(const QString& component, const QString& message,
@@ -132,46 +665,46 @@ void Logger::errorContext(const QString& component, const QString& message,
 }
 
 void Logger::log(Level level, const QString& message) {
-  if (level < m_level) return;
+  if (!isEnabled(level)) return;
 
-  logStructured(level, "Crankshaft", message, QJsonObject());
+  logStructured(level, defaultComponent(), message, QJsonObject());
 }
 
-void Logger::rotateLogIfNeeded() {
-  if (m_currentLogSize >= m_maxLogSize && !m_logFile.isEmpty()) {
-    QString rotatedFile =
-        m_logFile + "." + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
-    QFile::rename(m_logFile, rotatedFile);
-    m_currentLogSize = 0;
+void Logger::logFromSite(Level level, const QString& component, const QString& message,
+                         CallSite& site) {
+  QJsonObject context;
+  const quint64 suppressed = site.takeSuppressed();
+  if (suppressed > 0) {
+    context["suppressed"] = static_cast<qint64>(suppressed);
+  }
+  logStructured(level, component, message, context);
+}
 
-    // Clean up old rotated logs (keep last 5)
-    QFileInfo fileInfo(m_logFile);
-    QDir dir = fileInfo.dir();
-    QStringList filters;
-    filters << (fileInfo.baseName() + "*");
-    dir.setFilter(QDir::Files);
-    dir.setSorting(QDir::Time);
-
-    QFileInfoList logs = dir.entryInfoList(filters);
-    while (logs.count() > 5) {
-      QFile::remove(logs.last().filePath());
-      logs.removeLast();
-    }
+void Logger::rotateLog() {
+  m_file.close();
+  // The rename is a metadata update; compression and retention run on the archiver thread
+  const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+  QString rotatedFile = m_logFile + "." + stamp;
+  for (int suffix = 1; QFile::exists(rotatedFile) || QFile::exists(rotatedFile + ".gz");
+       ++suffix) {
+    rotatedFile = QString("%1.%2_%3").arg(m_logFile, stamp).arg(suffix);
   }
+  QFile::rename(m_logFile, rotatedFile);
+  m_currentLogSize = 0;
+  m_archiver->schedule(m_logFile);
 }
 
-QJsonObject Logger::createLogEntry(Level level, const QString& component, const QString& message,
-                                   const QJsonObject& context) const {
+QJsonObject Logger::createLogEntry(const Record& record) const {
   QJsonObject entry;
 
-  entry["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-  entry["level"] = levelToString(level);
-  entry["component"] = component;
-  entry["message"] = message;
-  entry["thread"] = QString::number(reinterpret_cast<qint64>(QThread::currentThread()));
+  entry["timestamp"] = QDateTime::fromMSecsSinceEpoch(record.timestampMs).toString(Qt::ISODate);
+  entry["level"] = levelToString(record.level);
+  entry["component"] = record.component;
+  entry["message"] = record.message;
+  entry["thread"] = QString::number(record.threadId);
 
   // Merge context if provided
-  for (auto it = context.constBegin(); it != context.constEnd(); ++it) {
+  for (auto it = record.context.constBegin(); it != record.context.constEnd(); ++it) {
     entry[it.key()] = it.value();
   }
 
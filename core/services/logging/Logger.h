@@ -19,23 +19,269 @@
 
 #pragma once
 
+#include <QFile>
+#include <QHash>
 #include <QJsonObject>
 #include <QObject>
+#include <QReadWriteLock>
 #include <QString>
+#include <QVariantMap>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
+#include "../common/TokenBucket.h"
+#include "BinaryLog.h"
+#include "FlightRecorder.h"
+#include "LogArchiver.h"
+
+template <typename T>
+class MpscRingBuffer;
+
+/// Compile-time log floor (0=Debug .. 4=Fatal); statements below it compile to nothing.
+/// Set by CMake: Release and MinSizeRel builds default to 1 (Info).
+#ifndef CRANKSHAFT_LOG_MIN_LEVEL
+#define CRANKSHAFT_LOG_MIN_LEVEL 0
+#endif
+
+/**
+ * @brief Process-wide logger with an asynchronous writer thread
+ *
+ * Callers only check the level and push a record (timestamp, level,
+ * thread, component, message, context) into a lock-free MpscRingBuffer.
+ * A dedicated "crankshaft-log" writer thread formats the records, keeps
+ * the log file open, and writes each batch with one call per sink. Nothing
+ * on the calling thread opens files, formats JSON or takes a lock. The
+ * file sink can use the compact BinaryLog encoding instead of JSON lines.
+ *
+ * ROTATION:
+ * ─────────
+ * Before a batch would take the file past setMaxLogSize() (counted in
+ * encoded bytes), the writer renames the file aside and reopens it. A
+ * LogArchiver thread then compresses the segment and applies the
+ * retention limits (setRetention()), so no directory scan or compression
+ * runs on the writer thread.
+ *
+ * OVERFLOW:
+ * ─────────
+ * When the buffer is full, OverflowPolicy::Drop discards the record and
+ * counts it. The writer reports the count as a warning once it catches up.
+ * OverflowPolicy::Block waits for space instead, except on threads marked
+ * with setRealtimeThread() or inside a RealtimeScope (audio/video
+ * callbacks), which always drop.
+ *
+ * LAZY FORMATTING:
+ * ────────────────
+ * debug()/info() take a finished QString, so the caller pays for arg()
+ * formatting even when the level is disabled. The CRANKSHAFT_LOG_* macros
+ * check isEnabled() first and only evaluate the message expression when
+ * the record will be kept. Levels below CRANKSHAFT_LOG_MIN_LEVEL fail a
+ * constant check and are removed by the compiler. Use the macros on hot
+ * paths (per packet, per frame, per buffer).
+ *
+ * COMPONENT LEVELS:
+ * ─────────────────
+ * setComponentLevel() overrides the global level for one component, so
+ * one subsystem can log at Debug while the others stay at Info. The name
+ * matches the logStructured() component, or the "[Name]" prefix of
+ * messages logged under the default "Crankshaft" component (debug(),
+ * info(), CRANKSHAFT_LOG_DEBUG). While an override is lower than the
+ * global level, prefixed messages at that level are formatted before the
+ * prefix is checked; named components are still filtered up front.
+ *
+ * SAMPLING AND RATE LIMITS:
+ * ─────────────────────────
+ * CRANKSHAFT_LOG_SAMPLED keeps 1 in N records from one call site.
+ * CRANKSHAFT_LOG_RATE_LIMITED keeps records from one call site within a
+ * token bucket. A suppressed record is never formatted. The next record
+ * kept from that call site carries "suppressed": <count> in its context,
+ * and suppressedRecords() totals them.
+ *
+ * FLIGHT RECORDER:
+ * ────────────────
+ * After enableFlightRecorder(), every kept record is also copied into a
+ * memory-mapped FlightRecorder ring on the calling thread, before it is
+ * queued. That copy does not depend on the writer or the log file, so
+ * the ring still holds the last records after a crash, an OOM kill, or
+ * an overflow drop. flightTrace() writes to the ring only, for
+ * breadcrumbs too frequent for the log.
+ *
+ * THREAD SAFETY:
+ * - All logging methods may be called from any thread
+ * - Configuration setters may be called at any time
+ * - Fatal records and flush() wait until the writer has written everything
+ *   queued before them
+ */
 class Logger : public QObject {
   Q_OBJECT
 
  public:
   enum class Level { Debug = 0, Info = 1, Warning = 2, Error = 3, Fatal = 4 };
 
+  /**
+   * @brief Suppression state for one sampled or rate-limited call site
+   *
+   * Declared as a function-local static by the CRANKSHAFT_LOG_SAMPLED and
+   * CRANKSHAFT_LOG_RATE_LIMITED macros; not used directly.
+   */
+  class CallSite {
+   public:
+    /// Admit the first record of every n (n <= 1 admits all)
+    auto sample(quint64 n) -> bool;
+    /// Admit records within a token bucket of perSecond, burst
+    auto rateLimit(double perSecond, double burst) -> bool;
+    /// Records suppressed since the last admitted one (resets the count)
+    auto takeSuppressed() -> quint64;
+
+   private:
+    void suppress();
+
+    std::atomic<quint64> m_calls{0};
+    std::atomic<quint64> m_suppressed{0};
+    std::mutex m_bucketMutex;
+    TokenBucket m_bucket;
+    bool m_bucketConfigured{false};
+  };
+
+  /// What a caller does when the record buffer is full
+  enum class OverflowPolicy {
+    Drop,  ///< Discard the record and count it (never waits)
+    Block  ///< Wait for the writer to make room (real-time threads still drop)
+  };
+
   [[nodiscard]] static Logger& instance();
 
   // Configuration
   void setLevel(Level level);
+  [[nodiscard]] auto level() const -> Level;
+
+  /**
+   * @brief Override the level for one component (see COMPONENT LEVELS)
+   */
+  void setComponentLevel(const QString& component, Level level);
+  void clearComponentLevel(const QString& component);
+
+  /**
+   * @brief Replace every component override
+   * @param levels Component name to level name ("debug" ... "fatal"), e.g.
+   *               the core.logging.components config object; unknown level
+   *               names are ignored
+   */
+  void setComponentLevels(const QVariantMap& levels);
+
+  /// Current overrides as component name to level name
+  [[nodiscard]] auto componentLevels() const -> QVariantMap;
   void setLogFile(const QString& filePath);
   void setJsonFormat(bool enabled);
-  void setMaxLogSize(qint64 bytes);  // For log rotation
+  void setMaxLogSize(qint64 bytes);  // For log rotation (encoded bytes; 0 disables)
+  /// Limits and compression for rotated segments (see LogArchiver)
+  void setRetention(const LogArchiver::Retention& retention);
+  /// Write the log file in the compact binary format (decode with crankshaft-logdecode);
+  /// console output keeps the JSON/text format
+  void setBinaryFileFormat(bool enabled);
+  void setConsoleOutput(bool enabled);
+  void setOverflowPolicy(OverflowPolicy policy);
+  [[nodiscard]] auto overflowPolicy() const -> OverflowPolicy;
+
+  /**
+   * @brief Start copying kept records into a crash flight recorder ring (see FLIGHT RECORDER)
+   * @param path Ring file; an uncleanly closed previous ring is kept as "<path>.crash"
+   * @param slotCount Records the ring holds
+   * @param error Set to the FlightRecorder::open() error code on failure
+   * @note Call once at startup; later calls are ignored
+   */
+  auto enableFlightRecorder(const QString& path, quint32 slotCount, QString& error) -> bool;
+
+  /// The previous run's ring if it ended abnormally (empty otherwise)
+  [[nodiscard]] auto previousFlightRecording() const -> QString;
+
+  /**
+   * @brief Record a trace point in the flight recorder only (no level check, no log output)
+   */
+  void flightTrace(const QString& component, const QString& message);
+
+  /**
+   * @brief Parse a level name ("debug", "info", "warning", "error", "fatal")
+   * @return Parsed level, or fallback for unknown names
+   */
+  static auto levelFromString(const QString& name, Level fallback) -> Level;
+
+  /// Lower-case level name, the inverse of levelFromString()
+  static auto levelName(Level level) -> QString;
+
+  /**
+   * @brief Mark the calling thread as real-time: its records are dropped rather than waited on
+   */
+  static void setRealtimeThread(bool realtime);
+  [[nodiscard]] static auto isRealtimeThread() -> bool;
+
+  /**
+   * @brief Marks the calling thread real-time for the lifetime of the guard
+   *
+   * For audio/video callbacks that run on a shared thread (e.g. the Qt
+   * thread polling the AASDK io_service) rather than a dedicated one.
+   */
+  class RealtimeScope {
+   public:
+    RealtimeScope() : m_previous(isRealtimeThread()) { setRealtimeThread(true); }
+    ~RealtimeScope() { setRealtimeThread(m_previous); }
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+
+   private:
+    bool m_previous;
+  };
+
+  /**
+   * @brief Wait until every record queued so far has been written
+   * @param timeoutMs Give up after this long
+   * @return false on timeout
+   */
+  auto flush(int timeoutMs = 2000) -> bool;
+
+  /**
+   * @brief Drain the buffer and stop the writer thread; later records are written synchronously
+   */
+  void shutdown();
+
+  /**
+   * @brief Whether a record at this level could be kept for some component
+   *
+   * Checks the compile-time floor and the lowest runtime level (global or
+   * any component override). Cheap enough to guard every hot-path log
+   * statement (see CRANKSHAFT_LOG).
+   */
+  [[nodiscard]] auto isEnabled(Level level) const -> bool {
+    return static_cast<int>(level) >= CRANKSHAFT_LOG_MIN_LEVEL &&
+           level >= m_floorLevel.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Whether a record at this level would be kept for this component
+   *
+   * Only builds a QString from component while an override is active.
+   */
+  template <typename Component>
+  [[nodiscard]] auto isEnabled(Level level, const Component& component) const -> bool {
+    if (!isEnabled(level)) {
+      return false;
+    }
+    return !m_hasComponentLevels.load(std::memory_order_relaxed) ||
+           componentAllows(level, QString(component), QString());
+  }
+
+  /// Records suppressed by sampling or rate limits
+  [[nodiscard]] auto suppressedRecords() const -> quint64;
+
+  /// Records discarded because the buffer was full
+  [[nodiscard]] auto droppedRecords() const -> quint64;
+
+  /// Record buffer capacity (records)
+  static constexpr std::size_t kQueueCapacity = 16384;
 
   // Simple logging (backward compatible)
   void debug(const QString& message);
@@ -48,6 +294,10 @@ class Logger : public QObject {
   void logStructured(Level level, const QString& component, const QString& message,
                      const QJsonObject& context = QJsonObject());
 
+  /// logStructured() for a sampled/rate-limited call site: adds its suppressed count
+  void logFromSite(Level level, const QString& component, const QString& message,
+                   CallSite& site);
+
   // Contextual logging helpers
   void debugContext(const QString& component, const QString& message,
                     const QJsonObject& context = QJsonObject());
@@ -59,21 +309,157 @@ class Logger : public QObject {
                     const QJsonObject& context = QJsonObject());
 
  private:
-  Logger() = default;
-  ~Logger() = default;
+  Logger();
+  ~Logger() override;
   Logger(const Logger&) = delete;
   Logger& operator=(const Logger&) = delete;
 
+  /// One log call, captured on the caller's thread
+  struct Record {
+    qint64 timestampMs{0};
+    Level level{Level::Info};
+    quint64 threadId{0};
+    QString component;
+    QString message;
+    QJsonObject context;
+  };
+
   void log(Level level, const QString& message);
-  void rotateLogIfNeeded();
+  /**
+   * @brief Level check against the component overrides
+   * @param message Used for the "[Name]" prefix of the default component;
+   *                empty when not formatted yet (prefixed records then pass)
+   */
+  [[nodiscard]] auto componentAllows(Level level, const QString& component,
+                                     const QString& message) const -> bool;
+  /// Recompute m_floorLevel after a level change (caller holds m_componentLock for writing)
+  void updateFloorLevel();
+  /// Queue a record under the overflow policy
+  void enqueue(Record& record);
+  /// Writer thread body
+  void writerLoop();
+  /// Format and write a batch to the sinks (writer thread, or caller after shutdown)
+  void writeRecords(const std::vector<Record>& records);
+  /// Emit a warning for records dropped since the last report
+  void reportDropped();
+  /// Open the log file if needed (sink mutex held); false if it cannot be opened
+  auto openLogFile() -> bool;
+  /// Whether the existing log file was written in the current file format (sink mutex held)
+  [[nodiscard]] auto logFileMatchesFormat() const -> bool;
+  /// Cut a binary log back to its last complete record; false if it must be rotated aside
+  auto trimIncompleteTail() -> bool;
+  /// Warn on stderr, once per log file, that it cannot be opened (sink mutex held)
+  void reportOpenFailure();
+  /// Write a Logger warning straight to stderr, bypassing the sinks
+  void warnOnStderr(const QString& message) const;
+  /// Bytes to append to the file for this batch (binary: encoded against the open file)
+  auto filePayload(const std::vector<Record>& records, const QByteArray& lines) -> QByteArray;
+  /// Rename the full file aside and hand it to the archiver (sink mutex held)
+  void rotateLog();
+  [[nodiscard]] auto formatRecord(const Record& record) const -> QByteArray;
   [[nodiscard]] auto levelToString(Level level) const -> QString;
-  [[nodiscard]] QJsonObject createLogEntry(Level level, const QString& component,
-                                           const QString& message,
-                                           const QJsonObject& context) const;
+  [[nodiscard]] QJsonObject createLogEntry(const Record& record) const;
+
+  std::atomic<Level> m_level{Level::Info};
+  /// Lowest of m_level and every component override (fast-path filter)
+  std::atomic<Level> m_floorLevel{Level::Info};
+  std::atomic_bool m_hasComponentLevels{false};
+  mutable QReadWriteLock m_componentLock;
+  QHash<QString, Level> m_componentLevels;
+  std::atomic<quint64> m_suppressed{0};
+  std::atomic<OverflowPolicy> m_overflowPolicy{OverflowPolicy::Drop};
+
+  std::unique_ptr<MpscRingBuffer<Record>> m_queue;
+  std::thread m_writer;
+  std::atomic_bool m_running{false};
+  std::atomic_bool m_stopping{false};
+  std::atomic_bool m_writerIdle{false};
+  std::atomic<quint64> m_enqueued{0};
+  std::atomic<quint64> m_processed{0};
+  std::atomic<quint64> m_dropped{0};
+  quint64 m_droppedReported{0};  // Writer thread only
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_flushed;
 
-  Level m_level{Level::Info};
+  /// Sink state, shared by the writer and the configuration setters
+  mutable std::mutex m_sinkMutex;
   QString m_logFile;
+  QFile m_file;
   bool m_jsonFormat{true};                // Default to JSON format
+  bool m_consoleOutput{true};
+  bool m_binaryFile{false};
+  bool m_binaryHeaderPending{false};
+  bool m_openFailureReported{false};
+  BinaryLogEncoder m_encoder;
+  std::unique_ptr<LogArchiver> m_archiver;
+
+  // Crash ring; written on the calling thread, never by the writer
+  FlightRecorder m_flightRecorder;
+  std::atomic_bool m_flightRecording{false};
   qint64 m_maxLogSize{10 * 1024 * 1024};  // 10 MB default
   qint64 m_currentLogSize{0};
 };
+
+/**
+ * @brief Log a message only if its level is enabled, without evaluating it otherwise
+ *
+ * The message (any expression yielding a QString) is not evaluated when the
+ * level is below CRANKSHAFT_LOG_MIN_LEVEL or the runtime level.
+ *
+ * @code
+ * CRANKSHAFT_LOG_DEBUG(QString("Media audio: %1 bytes").arg(data.size()));
+ * CRANKSHAFT_LOG(Logger::Level::Info, "AudioMixer", QString("Added %1").arg(name));
+ * @endcode
+ */
+#define CRANKSHAFT_LOG(level, component, ...)                             \
+  do {                                                                    \
+    if (static_cast<int>(level) >= CRANKSHAFT_LOG_MIN_LEVEL &&            \
+        Logger::instance().isEnabled(level, component)) {                 \
+      Logger::instance().logStructured(level, component, (__VA_ARGS__));  \
+    }                                                                     \
+  } while (false)
+
+/**
+ * @brief Keep 1 in n records from this call site (the first, then every n-th)
+ *
+ * @code
+ * CRANKSHAFT_LOG_SAMPLED(Logger::Level::Debug, "AudioMixer", 100,
+ *                        QString("Mixed %1 frames").arg(frames));
+ * @endcode
+ */
+#define CRANKSHAFT_LOG_SAMPLED(level, component, n, ...)                                    \
+  do {                                                                                      \
+    if (static_cast<int>(level) >= CRANKSHAFT_LOG_MIN_LEVEL &&                              \
+        Logger::instance().isEnabled(level, component)) {                                   \
+      static Logger::CallSite crankshaftLogSite;                                            \
+      if (crankshaftLogSite.sample(n)) {                                                    \
+        Logger::instance().logFromSite(level, component, (__VA_ARGS__), crankshaftLogSite); \
+      }                                                                                     \
+    }                                                                                       \
+  } while (false)
+
+/**
+ * @brief Keep records from this call site within a token bucket
+ *
+ * @code
+ * CRANKSHAFT_LOG_RATE_LIMITED(Logger::Level::Warning, "CANDevice", 1.0, 5.0,
+ *                             QString("Bus error on %1").arg(iface));
+ * @endcode
+ */
+#define CRANKSHAFT_LOG_RATE_LIMITED(level, component, perSecond, burst, ...)                \
+  do {                                                                                      \
+    if (static_cast<int>(level) >= CRANKSHAFT_LOG_MIN_LEVEL &&                              \
+        Logger::instance().isEnabled(level, component)) {                                   \
+      static Logger::CallSite crankshaftLogSite;                                            \
+      if (crankshaftLogSite.rateLimit(perSecond, burst)) {                                  \
+        Logger::instance().logFromSite(level, component, (__VA_ARGS__), crankshaftLogSite); \
+      }                                                                                     \
+    }                                                                                       \
+  } while (false)
+
+#define CRANKSHAFT_LOG_DEBUG(...) CRANKSHAFT_LOG(Logger::Level::Debug, "Crankshaft", __VA_ARGS__)
+#define CRANKSHAFT_LOG_INFO(...) CRANKSHAFT_LOG(Logger::Level::Info, "Crankshaft", __VA_ARGS__)
+#define CRANKSHAFT_LOG_WARNING(...) \
+  CRANKSHAFT_LOG(Logger::Level::Warning, "Crankshaft", __VA_ARGS__)
+#define CRANKSHAFT_LOG_ERROR(...) CRANKSHAFT_LOG(Logger::Level::Error, "Crankshaft", __VA_ARGS__)
@@ -0,0 +1,137 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * @class MpscRingBuffer
+ * @brief Bounded lock-free multi-producer / single-consumer ring buffer
+ *
+ * Fixed array of slots, each with its own sequence number (Dmitry Vyukov's
+ * bounded queue). A producer claims a slot with one CAS on the head and
+ * publishes it with a release store; nothing is allocated after
+ * construction, and a full buffer is reported to the producer instead of
+ * growing, so the caller picks the overflow policy. Unlike MpscQueue the
+ * memory footprint is fixed, which suits high-rate producers such as the
+ * Logger.
+ *
+ * THREAD SAFETY:
+ * - tryPush() may be called concurrently from any number of threads
+ * - tryPop() must only ever be called from one thread at a time
+ *
+ * @tparam T Element type (must be default-constructible and movable)
+ */
+template <typename T>
+class MpscRingBuffer {
+ public:
+  /**
+   * @param capacity Slot count, rounded up to a power of two (minimum 2)
+   */
+  explicit MpscRingBuffer(std::size_t capacity) {
+    std::size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    m_mask = size - 1;
+    m_slots = std::make_unique<Slot[]>(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscRingBuffer(const MpscRingBuffer&) = delete;
+  MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+  /**
+   * @brief Append an element unless the buffer is full (lock-free, any thread)
+   * @param value Moved from only on success
+   * @return false if every slot is occupied
+   */
+  auto tryPush(T& value) -> bool {
+    std::size_t position = m_head.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+      slot = &m_slots[position & m_mask];
+      const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const auto difference =
+          static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (difference == 0) {
+        if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = m_head.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = std::move(value);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Remove the oldest element (consumer thread only)
+   * @return true if an element was dequeued
+   */
+  auto tryPop(T& out) -> bool {
+    const std::size_t position = m_tail.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[position & m_mask];
+    const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != position + 1) {
+      return false;
+    }
+    out = std::move(slot.value);
+    slot.value = T();
+    slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+    m_tail.store(position + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief Approximate number of queued elements
+   * @note Only suitable for statistics and wake-up heuristics
+   */
+  [[nodiscard]] auto sizeApprox() const -> qsizetype {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    return head > tail ? static_cast<qsizetype>(head - tail) : 0;
+  }
+
+  [[nodiscard]] auto capacity() const -> qsizetype {
+    return static_cast<qsizetype>(m_mask + 1);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<std::size_t> sequence{0};
+    T value{};
+  };
+
+  std::unique_ptr<Slot[]> m_slots;
+  std::size_t m_mask{0};
+  alignas(64) std::atomic<std::size_t> m_head{0};
+  alignas(64) std::atomic<std::size_t> m_tail{0};  // Written by the consumer only
+};
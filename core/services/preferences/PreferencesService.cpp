@@ -127,7 +127,7 @@ bool PreferencesService::loadPreferences() {
     }
 
     m_cache[key] = cachedValue;
-    Logger::instance().debug(QString("[PreferencesService] Loaded preference: %1").arg(key));
+    CRANKSHAFT_LOG_DEBUG(QString("[PreferencesService] Loaded preference: %1").arg(key));
   }
 
   return true;
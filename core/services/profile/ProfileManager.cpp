@@ -100,6 +100,8 @@ void ProfileManager::initializeDefaultProfiles() {
   androidAutoDevice.settings["channels.input"] = true;
   androidAutoDevice.settings["channels.sensor"] = true;
   androidAutoDevice.settings["channels.bluetooth"] = false;  // Disabled by default
+  // Audio buffered per mixer channel before chunks are dropped
+  androidAutoDevice.settings["audio.mixerLatencyMs"] = 100;
 
   // Connection mode: "auto", "usb", "wireless"
   // auto = try USB first, fallback to wireless if configured
@@ -560,8 +562,8 @@ bool ProfileManager::setDeviceEnabled(const QString& profileId, const QString& d
   if (it != profile.devices.end()) {
     it->enabled = enabled;
     m_hostProfiles[profileId] = profile;
-    Logger::instance().debug(QString("ProfileManager: Device %1 in profile %2 set to %3")
-                                 .arg(deviceName, profileId, enabled ? "enabled" : "disabled"));
+    CRANKSHAFT_LOG_DEBUG(QString("ProfileManager: Device %1 in profile %2 set to %3")
+                             .arg(deviceName, profileId, enabled ? "enabled" : "disabled"));
     emit deviceConfigChanged(profileId, deviceName);
     return saveProfiles();
   }
@@ -582,8 +584,8 @@ bool ProfileManager::setDeviceUseMock(const QString& profileId, const QString& d
   if (it != profile.devices.end()) {
     it->useMock = useMock;
     m_hostProfiles[profileId] = profile;
-    Logger::instance().debug(QString("ProfileManager: Device %1 in profile %2 set to use %3")
-                                 .arg(deviceName, profileId, useMock ? "mock" : "real"));
+    CRANKSHAFT_LOG_DEBUG(QString("ProfileManager: Device %1 in profile %2 set to use %3")
+                             .arg(deviceName, profileId, useMock ? "mock" : "real"));
     emit deviceConfigChanged(profileId, deviceName);
     return saveProfiles();
   }
@@ -639,12 +641,12 @@ bool ProfileManager::loadProfiles() {
           validator.validate(instance);  // Exception thrown if invalid
           wholeDocValid = true;          // Only reached if validation passes
         } else {
-          Logger::instance().debug(
+          CRANKSHAFT_LOG_DEBUG(
               QString("ProfileManager: Schema file not found: %1").arg(schemaPath));
         }
 #else
         Q_UNUSED(f);
-        Logger::instance().debug(
+        CRANKSHAFT_LOG_DEBUG(
             QString("ProfileManager: json-schema-validator not available; skipping "
                     "whole-host_profiles.json validation"));
 #endif
@@ -697,8 +699,8 @@ bool ProfileManager::loadProfiles() {
             Q_UNUSED(f);
 #endif
           } catch (const std::exception& ex) {
-            Logger::instance().debug(QString("ProfileManager: Item validation failed: %1")
-                                         .arg(QString::fromLatin1(ex.what())));
+            CRANKSHAFT_LOG_DEBUG(QString("ProfileManager: Item validation failed: %1")
+                                     .arg(QString::fromLatin1(ex.what())));
             itemValid = false;
           }
 
@@ -742,12 +744,12 @@ bool ProfileManager::loadProfiles() {
           validator.validate(instance);  // Exception thrown if invalid
           wholeDocValid = true;          // Only reached if validation passes
         } else {
-          Logger::instance().debug(
+          CRANKSHAFT_LOG_DEBUG(
               QString("ProfileManager: Schema file not found: %1").arg(schemaPath));
         }
 #else
         Q_UNUSED(f);
-        Logger::instance().debug(
+        CRANKSHAFT_LOG_DEBUG(
             QString("ProfileManager: json-schema-validator not available; skipping "
                     "whole-vehicle_profiles.json validation"));
 #endif
@@ -796,8 +798,8 @@ bool ProfileManager::loadProfiles() {
             Q_UNUSED(f);
 #endif
           } catch (const std::exception& ex) {
-            Logger::instance().debug(QString("ProfileManager: Vehicle item validation failed: %1")
-                                         .arg(QString::fromLatin1(ex.what())));
+            CRANKSHAFT_LOG_DEBUG(QString("ProfileManager: Vehicle item validation failed: %1")
+                                     .arg(QString::fromLatin1(ex.what())));
             itemValid = false;
           }
 
@@ -0,0 +1,135 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ServiceJobQueue.h"
+
+#include <QMetaObject>
+#include <QThread>
+
+#include "../eventbus/EventBus.h"
+#include "../logging/Logger.h"
+#include "ServiceManager.h"
+
+ServiceJobQueue::ServiceJobQueue(ServiceManager* serviceManager)
+    : QObject(nullptr), m_serviceManager(serviceManager) {
+  moveToThread(serviceManager->thread());
+
+  // Lifecycle signals raised while a job runs become its progress steps
+  connect(serviceManager, &ServiceManager::serviceStarted, this,
+          [this](const QString& deviceName, bool success) {
+            if (m_currentJob) {
+              publish(kProgressTopic, *m_currentJob,
+                      {{"state", "step"},
+                       {"step", success ? "service_started" : "service_start_failed"},
+                       {"device", deviceName}});
+            }
+          });
+  connect(serviceManager, &ServiceManager::serviceStopped, this,
+          [this](const QString& deviceName) {
+            if (m_currentJob) {
+              publish(kProgressTopic, *m_currentJob,
+                      {{"state", "step"}, {"step", "service_stopped"}, {"device", deviceName}});
+            }
+          });
+}
+
+bool ServiceJobQueue::isJobCommand(const QString& command) {
+  return command == QLatin1String("reload_services") ||
+         command == QLatin1String("start_service") || command == QLatin1String("stop_service") ||
+         command == QLatin1String("restart_service");
+}
+
+QString ServiceJobQueue::submit(const QString& command, const QVariantMap& params,
+                                QString& error) {
+  if (!isJobCommand(command)) {
+    error = "Unknown command: " + command;
+    return QString();
+  }
+
+  Job job;
+  job.command = command;
+  job.service = params.value("service").toString();
+  if (command != QLatin1String("reload_services") && job.service.isEmpty()) {
+    error = "Missing 'service' parameter";
+    return QString();
+  }
+  job.id = QString("job-%1").arg(m_nextJobId.fetch_add(1));
+
+  ++m_pendingJobs;
+  publish(kProgressTopic, job, {{"state", "queued"}});
+  // Each job is its own queued call, so other events run between jobs
+  QMetaObject::invokeMethod(this, [this, job]() { run(job); }, Qt::QueuedConnection);
+  return job.id;
+}
+
+int ServiceJobQueue::pendingJobs() const {
+  return m_pendingJobs.load();
+}
+
+void ServiceJobQueue::run(const Job& job) {
+  Logger::instance().info(
+      QString("[ServiceJobQueue] Running %1 (%2)").arg(job.command, job.id));
+  m_currentJob = &job;
+  m_jobTimer.start();
+  publish(kProgressTopic, job, {{"state", "running"}});
+
+  QString error;
+  const bool success = execute(job, error);
+  m_currentJob = nullptr;
+  --m_pendingJobs;
+
+  QVariantMap result{{"state", success ? "completed" : "failed"},
+                     {"success", success},
+                     {"duration_ms", m_jobTimer.elapsed()}};
+  if (!error.isEmpty()) {
+    result["error"] = error;
+  }
+  publish(kCompletedTopic, job, result);
+  Logger::instance().info(QString("[ServiceJobQueue] %1 (%2) %3 in %4ms")
+                              .arg(job.command, job.id, success ? "completed" : "failed")
+                              .arg(m_jobTimer.elapsed()));
+}
+
+bool ServiceJobQueue::execute(const Job& job, QString& error) {
+  bool success = false;
+  if (job.command == QLatin1String("reload_services")) {
+    m_serviceManager->reloadServices();
+    success = true;
+  } else if (job.command == QLatin1String("start_service")) {
+    success = m_serviceManager->startService(job.service);
+  } else if (job.command == QLatin1String("stop_service")) {
+    success = m_serviceManager->stopService(job.service);
+  } else if (job.command == QLatin1String("restart_service")) {
+    success = m_serviceManager->restartService(job.service);
+  }
+
+  if (!success) {
+    error = QString("%1 failed for '%2'").arg(job.command, job.service);
+  }
+  return success;
+}
+
+void ServiceJobQueue::publish(const char* topic, const Job& job, QVariantMap payload) const {
+  payload["job_id"] = job.id;
+  payload["command"] = job.command;
+  if (!job.service.isEmpty()) {
+    payload["service"] = job.service;
+  }
+  EventBus::instance().publish(QString::fromLatin1(topic), payload);
+}
@@ -0,0 +1,103 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+#include <atomic>
+
+class ServiceManager;
+
+/**
+ * @brief Runs service lifecycle commands as asynchronous jobs
+ *
+ * reload_services, start_service, stop_service and restart_service can tear
+ * down and rebuild AASDK sessions and GStreamer pipelines, which takes
+ * hundreds of milliseconds. submit() returns a job id at once; the job then
+ * runs on the ServiceManager's thread, one job per event-loop pass, so
+ * WebSocket handling and event relay never wait for it.
+ *
+ * Progress is published on the EventBus:
+ * - "service-manager/job/progress": state "queued", "running", and one
+ *   "step" per service started or stopped while the job runs
+ * - "service-manager/job/completed": state "completed" or "failed", with
+ *   success, error and duration_ms
+ *
+ * Every payload carries job_id, command and (when given) service.
+ *
+ * THREAD SAFETY:
+ * - submit() and isJobCommand() may be called from any thread
+ * - Jobs run sequentially in the thread of the ServiceManager
+ */
+class ServiceJobQueue : public QObject {
+  Q_OBJECT
+
+ public:
+  static constexpr const char* kProgressTopic = "service-manager/job/progress";
+  static constexpr const char* kCompletedTopic = "service-manager/job/completed";
+
+  /**
+   * @param serviceManager Manager the jobs act on; the queue lives in its thread
+   */
+  explicit ServiceJobQueue(ServiceManager* serviceManager);
+
+  /**
+   * @brief Check whether a command runs as a job
+   */
+  static auto isJobCommand(const QString& command) -> bool;
+
+  /**
+   * @brief Queue a command and return its job id immediately
+   * @param command One of the job commands (see isJobCommand())
+   * @param params Command parameters ("service" for per-service commands)
+   * @param error Set when the command is rejected before queueing
+   * @return Job id, or an empty string if rejected
+   */
+  auto submit(const QString& command, const QVariantMap& params, QString& error) -> QString;
+
+  /**
+   * @brief Jobs queued or running
+   */
+  [[nodiscard]] auto pendingJobs() const -> int;
+
+ private:
+  struct Job {
+    QString id;
+    QString command;
+    QString service;
+  };
+
+  /// Execute one job on the ServiceManager's thread
+  void run(const Job& job);
+  /// Perform the command; returns success and sets error on failure
+  auto execute(const Job& job, QString& error) -> bool;
+  /// Publish a job event with the common fields filled in
+  void publish(const char* topic, const Job& job, QVariantMap payload) const;
+
+  ServiceManager* m_serviceManager;
+  std::atomic<quint64> m_nextJobId{1};
+  std::atomic_int m_pendingJobs{0};
+
+  /// Job currently running; progress steps are attributed to it
+  const Job* m_currentJob{nullptr};
+  QElapsedTimer m_jobTimer;
+};
@@ -269,8 +269,7 @@ QVariantMap SessionStore::getSessionByDevice(const QString& deviceId) const {
   query.addBindValue(deviceId);
 
   if (!query.exec() || !query.next()) {
-    Logger::instance().debug(
-        QString("[SessionStore] No active session for device: %1").arg(deviceId));
+    CRANKSHAFT_LOG_DEBUG(QString("[SessionStore] No active session for device: %1").arg(deviceId));
     return QVariantMap();
   }
 
@@ -0,0 +1,178 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "JsonPatch.h"
+
+#include <QStringList>
+
+namespace {
+
+void diffValue(const QString& path, const QJsonValue& from, const QJsonValue& to,
+               QJsonArray& ops);
+
+void diffObject(const QString& path, const QJsonObject& from, const QJsonObject& to,
+                QJsonArray& ops) {
+  for (auto it = from.constBegin(); it != from.constEnd(); ++it) {
+    if (!to.contains(it.key())) {
+      const QString childPath = path + QLatin1Char('/') + JsonPatch::escapeToken(it.key());
+      ops.append(QJsonObject{{"op", "remove"}, {"path", childPath}});
+    }
+  }
+  for (auto it = to.constBegin(); it != to.constEnd(); ++it) {
+    const QString childPath = path + QLatin1Char('/') + JsonPatch::escapeToken(it.key());
+    const auto previous = from.constFind(it.key());
+    if (previous == from.constEnd()) {
+      ops.append(QJsonObject{{"op", "add"}, {"path", childPath}, {"value", it.value()}});
+    } else {
+      diffValue(childPath, previous.value(), it.value(), ops);
+    }
+  }
+}
+
+void diffValue(const QString& path, const QJsonValue& from, const QJsonValue& to,
+               QJsonArray& ops) {
+  if (from == to) {
+    return;
+  }
+  if (from.isObject() && to.isObject()) {
+    diffObject(path, from.toObject(), to.toObject(), ops);
+    return;
+  }
+  if (from.isArray() && to.isArray()) {
+    const QJsonArray fromArray = from.toArray();
+    const QJsonArray toArray = to.toArray();
+    if (fromArray.size() == toArray.size()) {
+      for (qsizetype i = 0; i < toArray.size(); ++i) {
+        const QString childPath = path + QLatin1Char('/') + QString::number(i);
+        diffValue(childPath, fromArray.at(i), toArray.at(i), ops);
+      }
+      return;
+    }
+  }
+  ops.append(QJsonObject{{"op", "replace"}, {"path", path}, {"value", to}});
+}
+
+auto unescapeToken(QString token) -> QString {
+  return token.replace(QLatin1String("~1"), QLatin1String("/"))
+      .replace(QLatin1String("~0"), QLatin1String("~"));
+}
+
+/// Array index of a reference token; "-" (one past the end) only when allowed
+auto arrayIndex(const QString& token, qsizetype size, bool allowEnd, qsizetype& index) -> bool {
+  if (allowEnd && token == QLatin1String("-")) {
+    index = size;
+    return true;
+  }
+  bool ok = false;
+  index = token.toLongLong(&ok);
+  return ok && index >= 0 && (index < size || (allowEnd && index == size));
+}
+
+auto applyAt(QJsonValue& node, const QStringList& tokens, qsizetype depth, const QString& op,
+             const QJsonValue& value) -> bool {
+  const QString& token = tokens.at(depth);
+  const bool last = (depth + 1 == tokens.size());
+
+  if (node.isObject()) {
+    QJsonObject object = node.toObject();
+    if (!last) {
+      QJsonValue child = object.value(token);
+      if (child.isUndefined() || !applyAt(child, tokens, depth + 1, op, value)) {
+        return false;
+      }
+      object.insert(token, child);
+    } else if (op == QLatin1String("add")) {
+      object.insert(token, value);
+    } else if (!object.contains(token)) {
+      return false;
+    } else if (op == QLatin1String("replace")) {
+      object.insert(token, value);
+    } else {
+      object.remove(token);
+    }
+    node = object;
+    return true;
+  }
+
+  if (node.isArray()) {
+    QJsonArray array = node.toArray();
+    qsizetype index = 0;
+    if (!arrayIndex(token, array.size(), last && op == QLatin1String("add"), index)) {
+      return false;
+    }
+    if (!last) {
+      QJsonValue child = array.at(index);
+      if (!applyAt(child, tokens, depth + 1, op, value)) {
+        return false;
+      }
+      array.replace(index, child);
+    } else if (op == QLatin1String("add")) {
+      array.insert(index, value);
+    } else if (op == QLatin1String("replace")) {
+      array.replace(index, value);
+    } else {
+      array.removeAt(index);
+    }
+    node = array;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+QJsonArray JsonPatch::diff(const QJsonObject& from, const QJsonObject& to) {
+  QJsonArray ops;
+  diffObject(QString(), from, to, ops);
+  return ops;
+}
+
+bool JsonPatch::apply(QJsonObject& target, const QJsonArray& patch) {
+  QJsonValue result(target);
+  for (const QJsonValue& entry : patch) {
+    const QJsonObject operation = entry.toObject();
+    const QString op = operation.value("op").toString();
+    const QString path = operation.value("path").toString();
+    if ((op != QLatin1String("add") && op != QLatin1String("replace") &&
+         op != QLatin1String("remove")) ||
+        !path.startsWith(QLatin1Char('/'))) {
+      return false;
+    }
+    if (op != QLatin1String("remove") && !operation.contains("value")) {
+      return false;
+    }
+
+    QStringList tokens = path.mid(1).split(QLatin1Char('/'));
+    for (QString& token : tokens) {
+      token = unescapeToken(token);
+    }
+    if (!applyAt(result, tokens, 0, op, operation.value("value"))) {
+      return false;
+    }
+  }
+  target = result.toObject();
+  return true;
+}
+
+QString JsonPatch::escapeToken(const QString& token) {
+  QString escaped = token;
+  return escaped.replace(QLatin1String("~"), QLatin1String("~0"))
+      .replace(QLatin1String("/"), QLatin1String("~1"));
+}
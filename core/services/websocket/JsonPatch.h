@@ -0,0 +1,56 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+
+/**
+ * @brief Minimal RFC 6902 JSON Patch support for delta-encoded events
+ *
+ * diff() produces "add", "remove" and "replace" operations that turn one
+ * payload into another. Objects are compared key by key and arrays of equal
+ * length element by element; anything else (including arrays that changed
+ * length) is replaced whole. apply() accepts the same three operations,
+ * including array insertion and removal, so it also reads patches from
+ * other producers.
+ *
+ * Paths are JSON Pointers (RFC 6901): "/a/b/0", with "~" escaped as "~0"
+ * and "/" as "~1".
+ */
+class JsonPatch {
+ public:
+  /**
+   * @brief Operations that turn from into to
+   * @return Empty array when the objects are equal
+   */
+  static auto diff(const QJsonObject& from, const QJsonObject& to) -> QJsonArray;
+
+  /**
+   * @brief Apply a patch in place
+   * @return false if an operation is malformed or its path does not exist;
+   *         target is then left unchanged
+   */
+  static auto apply(QJsonObject& target, const QJsonArray& patch) -> bool;
+
+  /// Escape one JSON Pointer reference token
+  static auto escapeToken(const QString& token) -> QString;
+};
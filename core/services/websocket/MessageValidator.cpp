@@ -0,0 +1,231 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MessageValidator.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+// Same build switch as ProfileManager: 1 when the pboettch headers are available
+#if CRANKSHAFT_JSON_SCHEMA_VALIDATOR
+#include <nlohmann/json-schema.hpp>
+#include <nlohmann/json.hpp>
+namespace json_schema = nlohmann::json_schema;
+using nlohmann::json;
+#endif
+
+#include "../logging/Logger.h"
+
+#if CRANKSHAFT_JSON_SCHEMA_VALIDATOR
+struct MessageValidator::CompiledSchema {
+  json_schema::json_validator validator;
+};
+
+namespace {
+
+/// Convert without a text round trip; integral numbers stay integers for "type": "integer"
+json toNlohmann(const QJsonValue& value) {
+  switch (value.type()) {
+    case QJsonValue::Bool:
+      return value.toBool();
+    case QJsonValue::Double: {
+      const double number = value.toDouble();
+      if (std::trunc(number) == number && std::abs(number) < 9.0e15) {
+        return static_cast<std::int64_t>(number);
+      }
+      return number;
+    }
+    case QJsonValue::String:
+      return value.toString().toStdString();
+    case QJsonValue::Array: {
+      json array = json::array();
+      for (const QJsonValue& item : value.toArray()) {
+        array.push_back(toNlohmann(item));
+      }
+      return array;
+    }
+    case QJsonValue::Object: {
+      json object = json::object();
+      const QJsonObject source = value.toObject();
+      for (auto it = source.constBegin(); it != source.constEnd(); ++it) {
+        object[it.key().toStdString()] = toNlohmann(it.value());
+      }
+      return object;
+    }
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+#else
+struct MessageValidator::CompiledSchema {};
+#endif
+
+MessageValidator::MessageValidator() = default;
+MessageValidator::~MessageValidator() = default;
+
+QString MessageValidator::defaultSchemaPath() {
+  const QString name = QStringLiteral("ws-schema.json");
+#ifdef CRANKSHAFT_SOURCE_DIR
+  const QString candidate =
+      QString(CRANKSHAFT_SOURCE_DIR) + "/specs/002-infotainment-androidauto/contracts/" + name;
+  if (QFile::exists(candidate)) return candidate;
+#endif
+  const QString appShare = QDir(QCoreApplication::applicationDirPath())
+                               .filePath("../share/crankshaft/docs/schemas/" + name);
+  if (QFile::exists(appShare)) return appShare;
+  return QString();
+}
+
+bool MessageValidator::loadSchema(const QString& path) {
+#if CRANKSHAFT_JSON_SCHEMA_VALIDATOR
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    Logger::instance().warning(
+        QString("[MessageValidator] Cannot open message schema: %1").arg(path));
+    return false;
+  }
+
+  try {
+    const json document = json::parse(file.readAll().toStdString());
+    const auto compile = [](const json& schema) {
+      auto compiled = std::make_shared<CompiledSchema>();
+      compiled->validator.set_root_schema(schema);
+      return std::shared_ptr<const CompiledSchema>(std::move(compiled));
+    };
+
+    // Each oneOf branch of the contract is keyed by its "type" const
+    QHash<QString, std::shared_ptr<const CompiledSchema>> messages;
+    QHash<QString, std::shared_ptr<const CompiledSchema>> payloads;
+    for (const json& schema : document.value("oneOf", json::array())) {
+      const json type = schema.value("properties", json::object())
+                            .value("type", json::object())
+                            .value("const", json());
+      if (type.is_string()) {
+        messages.insert(QString::fromStdString(type.get<std::string>()), compile(schema));
+      }
+    }
+    for (const auto& [topic, schema] : document.value("payloads", json::object()).items()) {
+      payloads.insert(QString::fromStdString(topic), compile(schema));
+    }
+    if (messages.isEmpty()) {
+      Logger::instance().warning(
+          QString("[MessageValidator] No message schemas in %1").arg(path));
+      return false;
+    }
+
+    m_messageSchemas = std::move(messages);
+    m_payloadSchemas = std::move(payloads);
+    Logger::instance().info(
+        QString("[MessageValidator] Compiled %1 message and %2 payload schemas from %3")
+            .arg(m_messageSchemas.size())
+            .arg(m_payloadSchemas.size())
+            .arg(path));
+    return true;
+  } catch (const std::exception& ex) {
+    Logger::instance().warning(QString("[MessageValidator] Invalid message schema %1: %2")
+                                   .arg(path)
+                                   .arg(QString::fromLatin1(ex.what())));
+    return false;
+  }
+#else
+  CRANKSHAFT_LOG_DEBUG(
+      QString("[MessageValidator] json-schema-validator not available; not loading %1")
+          .arg(path));
+  return false;
+#endif
+}
+
+bool MessageValidator::hasSchemaFor(const QString& type) const {
+  return m_messageSchemas.contains(type);
+}
+
+bool MessageValidator::validate(const QString& type, const QJsonObject& message,
+                                QString& error) const {
+#if CRANKSHAFT_JSON_SCHEMA_VALIDATOR
+  const auto schema = m_messageSchemas.constFind(type);
+  if (schema == m_messageSchemas.constEnd()) {
+    return true;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  bool valid = true;
+  try {
+    schema.value()->validator.validate(toNlohmann(message));
+    if (type == QLatin1String("publish")) {
+      const auto payloadSchema = m_payloadSchemas.constFind(message.value("topic").toString());
+      if (payloadSchema != m_payloadSchemas.constEnd()) {
+        try {
+          payloadSchema.value()->validator.validate(toNlohmann(message.value("payload")));
+        } catch (const std::exception& ex) {
+          Logger::instance().warning(QString("[MessageValidator] Invalid payload for %1: %2")
+                                         .arg(message.value("topic").toString())
+                                         .arg(QString::fromLatin1(ex.what())));
+          error = QStringLiteral("invalid_payload");
+          valid = false;
+        }
+      }
+    }
+  } catch (const std::exception& ex) {
+    Logger::instance().warning(QString("[MessageValidator] Invalid %1 message: %2")
+                                   .arg(type)
+                                   .arg(QString::fromLatin1(ex.what())));
+    error = QStringLiteral("schema_violation");
+    valid = false;
+  }
+
+  const auto elapsedNs = static_cast<quint64>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                           start)
+          .count());
+  m_validated.fetch_add(1, std::memory_order_relaxed);
+  m_totalNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+  quint64 previousMax = m_maxNs.load(std::memory_order_relaxed);
+  while (elapsedNs > previousMax &&
+         !m_maxNs.compare_exchange_weak(previousMax, elapsedNs, std::memory_order_relaxed)) {
+  }
+  if (!valid) {
+    m_rejected.fetch_add(1, std::memory_order_relaxed);
+  }
+  return valid;
+#else
+  Q_UNUSED(type);
+  Q_UNUSED(message);
+  Q_UNUSED(error);
+  return true;
+#endif
+}
+
+MessageValidator::Stats MessageValidator::stats() const {
+  Stats stats;
+  stats.validated = m_validated.load(std::memory_order_relaxed);
+  stats.rejected = m_rejected.load(std::memory_order_relaxed);
+  stats.maxNs = m_maxNs.load(std::memory_order_relaxed);
+  if (stats.validated > 0) {
+    stats.averageNs = m_totalNs.load(std::memory_order_relaxed) / stats.validated;
+  }
+  return stats;
+}
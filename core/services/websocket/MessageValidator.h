@@ -0,0 +1,108 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief Contract-schema validation of inbound WebSocket messages
+ *
+ * loadSchema() reads the WebSocket contract
+ * (specs/002-infotainment-androidauto/contracts/ws-schema.json) once and
+ * compiles one pboettch json-schema-validator per "oneOf" message branch,
+ * keyed by its "type" const, and per publish topic ("payloads"). validate() then only looks up the
+ * compiled validator and walks the instance: no schema is parsed or
+ * compiled per message, unlike the ProfileManager file validation path.
+ *
+ * The time spent per message (including the QJson to nlohmann conversion)
+ * is accumulated in stats().
+ *
+ * Without the validator library (CRANKSHAFT_JSON_SCHEMA_VALIDATOR=0)
+ * loadSchema() fails and hasSchemaFor() is always false, so callers keep
+ * their hand-written checks.
+ *
+ * THREAD SAFETY:
+ * - loadSchema() must complete before validate() is called
+ * - validate() and stats() may be called from any thread afterwards
+ */
+class MessageValidator {
+ public:
+  /// Validation cost and outcome counters
+  struct Stats {
+    quint64 validated{0};      ///< Messages checked against a schema
+    quint64 rejected{0};       ///< Messages that failed
+    quint64 averageNs{0};      ///< Mean time per validated message
+    quint64 maxNs{0};          ///< Slowest validation seen
+  };
+
+  MessageValidator();
+  ~MessageValidator();
+
+  MessageValidator(const MessageValidator&) = delete;
+  MessageValidator& operator=(const MessageValidator&) = delete;
+
+  /**
+   * @brief Parse and compile the message schema file
+   * @param path Path to ws-schema.json
+   * @return true if at least one message validator was compiled
+   */
+  auto loadSchema(const QString& path) -> bool;
+
+  /**
+   * @brief Locate the installed or in-tree schema file
+   * @return Path, or an empty string if none was found
+   */
+  static auto defaultSchemaPath() -> QString;
+
+  /**
+   * @brief Check whether a compiled validator exists for a message type
+   */
+  [[nodiscard]] auto hasSchemaFor(const QString& type) const -> bool;
+
+  /**
+   * @brief Validate a message (and a publish payload) against the compiled schemas
+   * @param type Message type, already checked against the allow-list
+   * @param message Decoded message object
+   * @param error "schema_violation" or "invalid_payload" on failure
+   * @return true if the message conforms
+   */
+  auto validate(const QString& type, const QJsonObject& message, QString& error) const -> bool;
+
+  /**
+   * @brief Validation counters since startup
+   */
+  [[nodiscard]] auto stats() const -> Stats;
+
+ private:
+  /// Compiled validator; defined in the .cpp next to the library include
+  struct CompiledSchema;
+
+  QHash<QString, std::shared_ptr<const CompiledSchema>> m_messageSchemas;
+  QHash<QString, std::shared_ptr<const CompiledSchema>> m_payloadSchemas;
+
+  mutable std::atomic<quint64> m_validated{0};
+  mutable std::atomic<quint64> m_rejected{0};
+  mutable std::atomic<quint64> m_totalNs{0};
+  mutable std::atomic<quint64> m_maxNs{0};
+};
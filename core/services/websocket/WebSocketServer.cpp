@@ -19,18 +19,28 @@
 
 #include "WebSocketServer.h"
 
+#include <QCborMap>
+#include <QCborValue>
 #include <QDateTime>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QPointer>
 #include <QSslCertificate>
 #include <QSslKey>
+#include <QThread>
+#include <QTimer>
+#include <QtEndian>
+#include <algorithm>
 
-#include "../android_auto/AndroidAutoService.h"
 #include "../eventbus/EventBus.h"
 #include "../logging/Logger.h"
+#include "../service_manager/ServiceJobQueue.h"
 #include "../service_manager/ServiceManager.h"
+#include "JsonPatch.h"
 
 WebSocketServer::WebSocketServer(quint16 port, QObject* parent)
     : QObject(parent),
@@ -38,8 +48,12 @@ WebSocketServer::WebSocketServer(quint16 port, QObject* parent)
       m_serviceManager(nullptr),
       m_secureModeEnabled(false) {
   Logger::instance().info(QString("Initializing WebSocket server on port %1...").arg(port));
+  m_clock.start();
 
-  if (m_server->listen(QHostAddress::Any, port)) {
+  configureSubprotocols();
+  if (port == 0) {
+    Logger::instance().info("WebSocket TCP endpoint disabled");
+  } else if (m_server->listen(QHostAddress::Any, port)) {
     Logger::instance().info(QString("WebSocket server listening on port %1 (ws://)").arg(port));
     connect(m_server, &QWebSocketServer::newConnection, this, &WebSocketServer::onNewConnection);
   } else {
@@ -50,27 +64,93 @@ WebSocketServer::WebSocketServer(quint16 port, QObject* parent)
 }
 
 WebSocketServer::~WebSocketServer() {
+  QObject::disconnect(m_relayConnection);
+  stopIoThread();
   m_server->close();
+  if (m_localServer) {
+    m_localServer->close();
+  }
   qDeleteAll(m_clients);
 }
 
 bool WebSocketServer::isListening() const {
-  return m_server->isListening();
+  return m_server->isListening() || isLocalListening();
+}
+
+bool WebSocketServer::listenLocal(const QString& path) {
+  if (!m_localServer) {
+    m_localServer = new QLocalServer(this);
+    m_localServer->setSocketOptions(QLocalServer::UserAccessOption |
+                                    QLocalServer::GroupAccessOption);
+    connect(m_localServer, &QLocalServer::newConnection, this,
+            &WebSocketServer::onNewLocalConnection);
+  }
+  m_localServer->close();
+
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  // A crashed previous instance leaves its socket file behind
+  QLocalServer::removeServer(path);
+  if (!m_localServer->listen(path)) {
+    Logger::instance().error(QString("Failed to listen on local socket %1: %2")
+                                 .arg(path)
+                                 .arg(m_localServer->errorString()));
+    return false;
+  }
+  Logger::instance().info(QString("WebSocket server listening on local socket %1").arg(path));
+  return true;
+}
+
+bool WebSocketServer::isLocalListening() const {
+  return m_localServer && m_localServer->isListening();
 }
 
 void WebSocketServer::setServiceManager(ServiceManager* serviceManager) {
   m_serviceManager = serviceManager;
+  m_serviceMailbox =
+      serviceManager ? std::make_unique<ThreadMailbox>(serviceManager) : nullptr;
+  m_jobQueue = serviceManager ? std::make_unique<ServiceJobQueue>(serviceManager) : nullptr;
   Logger::instance().info("[WebSocketServer] ServiceManager registered");
 }
 
-void WebSocketServer::initializeServiceConnections() {
-  if (!m_serviceManager) {
-    Logger::instance().debug("[WebSocketServer] ServiceManager not available");
+void WebSocketServer::relayEventBus(EventBus& bus) {
+  QObject::disconnect(m_relayConnection);
+  // Runs in the bus dispatcher thread; only the shared Event handle crosses
+  // over. Critical topics keep their lane in the mailbox as well.
+  m_relayConnection = connect(
+      &bus, &EventBus::eventPublished, this,
+      [this, &bus](const Event& event) {
+        const bool critical = bus.priorityFor(event.topic()) == EventBus::Priority::Critical;
+        m_mailbox.post([this, event]() { broadcastEvent(event); },
+                       critical ? Qt::HighEventPriority : Qt::NormalEventPriority);
+      },
+      Qt::DirectConnection);
+}
+
+void WebSocketServer::startIoThread() {
+  if (m_ioThread) {
     return;
   }
+  m_ownerThread = thread();
+  m_ioThread = new QThread();
+  m_ioThread->setObjectName(QStringLiteral("WebSocketIO"));
+  moveToThread(m_ioThread);
+  m_ioThread->start();
+  Logger::instance().info("[WebSocketServer] Serving clients on dedicated I/O thread");
+}
 
-  Logger::instance().info("[WebSocketServer] Initializing service connections...");
-  setupAndroidAutoConnections();
+void WebSocketServer::stopIoThread() {
+  if (!m_ioThread) {
+    return;
+  }
+  // moveToThread() must run in the thread the object currently lives in
+  QThread* owner = m_ownerThread;
+  QMetaObject::invokeMethod(
+      this, [this, owner]() { moveToThread(owner); }, Qt::BlockingQueuedConnection);
+  m_ioThread->quit();
+  m_ioThread->wait();
+  delete m_ioThread;
+  m_ioThread = nullptr;
+  m_mailbox.drain();
 }
 
 void WebSocketServer::onNewConnection() {
@@ -82,18 +162,85 @@ void WebSocketServer::onNewConnection() {
           .arg(m_clients.size() + 1));
 
   connect(client, &QWebSocket::textMessageReceived, this, &WebSocketServer::onTextMessageReceived);
+  connect(client, &QWebSocket::binaryMessageReceived, this,
+          &WebSocketServer::onBinaryMessageReceived);
   connect(client, &QWebSocket::disconnected, this, &WebSocketServer::onClientDisconnected);
+  connect(client, &QWebSocket::bytesWritten, this, [this, client]() {
+    const auto slot = m_clientSlotOf.constFind(client);
+    if (slot != m_clientSlotOf.constEnd()) {
+      flushOutbound(slot.value());
+    }
+  });
+
+  ClientSlot state;
+  state.socket = client;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+  if (client->subprotocol() == QLatin1String(kCborSubprotocol)) {
+    state.format = WireFormat::Cbor;
+    Logger::instance().info("[WebSocketServer] Client negotiated binary (CBOR) subprotocol");
+  }
+#endif
+
+  registerClient(client, state);
+}
+
+void WebSocketServer::onNewLocalConnection() {
+  while (m_localServer->hasPendingConnections()) {
+    QLocalSocket* client = m_localServer->nextPendingConnection();
+    Logger::instance().info(
+        QString("[WebSocketServer] New local connection, Total clients: %1")
+            .arg(m_clients.size() + 1));
+
+    connect(client, &QLocalSocket::readyRead, this, &WebSocketServer::onLocalReadyRead);
+    connect(client, &QLocalSocket::disconnected, this, &WebSocketServer::onClientDisconnected);
+    connect(client, &QLocalSocket::bytesWritten, this, [this, client]() {
+      const auto slot = m_clientSlotOf.constFind(client);
+      if (slot != m_clientSlotOf.constEnd()) {
+        flushOutbound(slot.value());
+      }
+    });
 
-  m_clients.append(client);
-  m_subscriptions[client] = QStringList();
+    // Local clients always speak length-prefixed CBOR
+    ClientSlot state;
+    state.local = client;
+    state.format = WireFormat::Cbor;
+    registerClient(client, state);
+  }
+}
+
+void WebSocketServer::registerClient(QObject* connection, const ClientSlot& client) {
+  ClientSlot state = client;
+  state.messageBucket =
+      TokenBucket(m_inboundLimits.messagesPerSecond, m_inboundLimits.messageBurst);
+  state.publishBucket =
+      TokenBucket(m_inboundLimits.publishBytesPerSecond, m_inboundLimits.publishByteBurst);
+
+  m_clients.append(connection);
+  m_subscriptions[connection] = QStringList();
+
+  // Give the client a bit position in the recipient sets, reusing free slots
+  qsizetype slot = 0;
+  while (slot < m_clientSlots.size() && m_clientSlots.at(slot).connection()) {
+    ++slot;
+  }
+  if (slot == m_clientSlots.size()) {
+    m_clientSlots.append(state);
+  } else {
+    m_clientSlots[slot] = state;
+  }
+  m_clientSlotOf.insert(connection, static_cast<int>(slot));
+  m_recipientCache.clear();
 }
 
 void WebSocketServer::onTextMessageReceived(const QString& message) {
   QWebSocket* client = qobject_cast<QWebSocket*>(sender());
   if (!client) return;
+  // Over-limit frames are dropped before paying for the parse
+  if (!admitFrame(client)) return;
 
+  const QByteArray utf8 = message.toUtf8();
   QJsonParseError parseError;
-  QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8(), &parseError);
+  QJsonDocument doc = QJsonDocument::fromJson(utf8, &parseError);
   if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
     Logger::instance().warning(
         QString("[WebSocketServer] Invalid JSON message: %1").arg(parseError.errorString()));
@@ -101,86 +248,349 @@ void WebSocketServer::onTextMessageReceived(const QString& message) {
     return;
   }
 
-  QJsonObject obj = doc.object();
+  processMessage(client, doc.object(), utf8.size());
+}
+
+void WebSocketServer::onBinaryMessageReceived(const QByteArray& message) {
+  QWebSocket* client = qobject_cast<QWebSocket*>(sender());
+  if (!client) return;
+  if (!admitFrame(client)) return;
+
+  QCborParserError parseError;
+  const QCborValue value = QCborValue::fromCbor(message, &parseError);
+  if (parseError.error != QCborError::NoError || !value.isMap()) {
+    Logger::instance().warning(
+        QString("[WebSocketServer] Invalid CBOR message: %1").arg(parseError.errorString()));
+    sendError(client, QStringLiteral("invalid_cbor"));
+    return;
+  }
+
+  processMessage(client, value.toMap().toJsonObject(), message.size());
+}
+
+/**
+ * @brief Split the local byte stream into messages
+ *
+ * Bytes are buffered until a whole frame (4-byte big-endian length + CBOR)
+ * is available. An oversized length means a broken or hostile peer, which
+ * is disconnected rather than buffered.
+ */
+void WebSocketServer::onLocalReadyRead() {
+  QLocalSocket* client = qobject_cast<QLocalSocket*>(sender());
+  if (!client) return;
+
+  QByteArray& buffer = m_localInbound[client];
+  buffer.append(client->readAll());
+
+  qsizetype offset = 0;
+  QList<QByteArray> messages;
+  while (buffer.size() - offset >= 4) {
+    const quint32 length = qFromBigEndian<quint32>(buffer.constData() + offset);
+    if (length > kMaxLocalFrameBytes) {
+      Logger::instance().warning(
+          QString("[WebSocketServer] Local frame of %1 bytes exceeds limit, disconnecting")
+              .arg(length));
+      m_localInbound.remove(client);
+      client->disconnectFromServer();
+      return;
+    }
+    if (buffer.size() - offset - 4 < length) {
+      break;
+    }
+    messages.append(buffer.mid(offset + 4, length));
+    offset += 4 + length;
+  }
+  buffer.remove(0, offset);
+
+  // Handlers may drop the connection; stop as soon as the client is gone
+  for (const QByteArray& message : std::as_const(messages)) {
+    if (!m_clientSlotOf.contains(client)) {
+      return;
+    }
+    if (!admitFrame(client)) {
+      continue;
+    }
+    QCborParserError parseError;
+    const QCborValue value = QCborValue::fromCbor(message, &parseError);
+    if (parseError.error != QCborError::NoError || !value.isMap()) {
+      Logger::instance().warning(
+          QString("[WebSocketServer] Invalid CBOR message: %1").arg(parseError.errorString()));
+      sendError(client, QStringLiteral("invalid_cbor"));
+      continue;
+    }
+    processMessage(client, value.toMap().toJsonObject(), message.size());
+  }
+}
+
+void WebSocketServer::processMessage(QObject* client, const QJsonObject& obj,
+                                     qsizetype frameBytes) {
+  const QJsonValue id = obj.value("id");
   QString error;
   if (!validateMessage(obj, error)) {
     Logger::instance().warning(QString("[WebSocketServer] Invalid message: %1").arg(error));
-    sendError(client, error);
+    sendError(client, error, id);
     return;
   }
 
   QString type = obj.value("type").toString();
 
-  if (type == "subscribe") {
-    QString topic = obj.value("topic").toString();
-    handleSubscribe(client, topic);
-  } else if (type == "unsubscribe") {
-    QString topic = obj.value("topic").toString();
-    handleUnsubscribe(client, topic);
-  } else if (type == "publish") {
-    QString topic = obj.value("topic").toString();
-    QVariantMap payload = obj.value("payload").toObject().toVariantMap();
-    handlePublish(topic, payload);
+  if (type == "batch") {
+    handleBatch(client, obj, frameBytes);
   } else if (type == "service_command") {
     QString command = obj.value("command").toString();
     QString commandError;
     if (!validateServiceCommand(command, commandError)) {
       Logger::instance().warning(
           QString("[WebSocketServer] Rejected service command: %1").arg(commandError));
-      sendError(client, commandError);
+      sendError(client, commandError, id);
       return;
     }
     QVariantMap params = obj.value("params").toObject().toVariantMap();
-    handleServiceCommand(client, command, params);
+    handleServiceCommand(client, command, params, id);
+  } else if (!applyOperation(client, obj, frameBytes, error)) {
+    sendError(client, error, id);
+  }
+}
+
+bool WebSocketServer::admitFrame(QObject* client) {
+  const auto slot = m_clientSlotOf.constFind(client);
+  if (slot == m_clientSlotOf.constEnd()) {
+    return false;
+  }
+  ClientSlot& state = m_clientSlots[slot.value()];
+  if (admitMessages(client, 1)) {
+    state.throttled = false;
+    return true;
+  }
+  // One reply per episode: answering every dropped frame would amplify the flood
+  if (!state.throttled) {
+    state.throttled = true;
+    Logger::instance().warning(
+        QString("[WebSocketServer] Rate limiting inbound messages from %1").arg(state.peerName()));
+    sendError(client, QStringLiteral("rate_limited"));
+  }
+  return false;
+}
+
+bool WebSocketServer::admitMessages(QObject* client, qsizetype count) {
+  const auto slot = m_clientSlotOf.constFind(client);
+  if (slot == m_clientSlotOf.constEnd()) {
+    return false;
+  }
+  ClientSlot& state = m_clientSlots[slot.value()];
+  if (state.messageBucket.tryConsume(static_cast<double>(count), m_clock.nsecsElapsed())) {
+    return true;
+  }
+  state.rateLimited += static_cast<quint64>(count);
+  return false;
+}
+
+bool WebSocketServer::admitPublish(QObject* client, qsizetype bytes) {
+  const auto slot = m_clientSlotOf.constFind(client);
+  if (slot == m_clientSlotOf.constEnd()) {
+    return false;
+  }
+  ClientSlot& state = m_clientSlots[slot.value()];
+  if (state.publishBucket.tryConsume(static_cast<double>(bytes), m_clock.nsecsElapsed())) {
+    return true;
+  }
+  ++state.publishRateLimited;
+  return false;
+}
+
+bool WebSocketServer::applyOperation(QObject* client, const QJsonObject& obj, qsizetype bytes,
+                                     QString& error) {
+  const QString type = obj.value("type").toString();
+  const QString topic = obj.value("topic").toString();
+
+  if (type == "subscribe") {
+    return handleSubscribe(client, topic, obj.value("delta").toBool(), error);
+  }
+  if (type == "unsubscribe") {
+    return handleUnsubscribe(client, topic, error);
+  }
+  if (type == "publish") {
+    // Publishes are re-injected into the EventBus; a noisy client must not flood it
+    if (!admitPublish(client, bytes)) {
+      error = QStringLiteral("rate_limited");
+      return false;
+    }
+    handlePublish(topic, obj.value("payload").toObject().toVariantMap());
+    return true;
+  }
+  error = QStringLiteral("invalid_type");
+  return false;
+}
+
+/**
+ * @brief Apply every operation of a batch and answer with one frame
+ *
+ * Operations run in order and each gets a result entry at its index.
+ * Service commands in the batch are pipelined to the ServiceManager; the
+ * batch_response goes out once the last of them has completed.
+ */
+void WebSocketServer::handleBatch(QObject* client, const QJsonObject& obj,
+                                  qsizetype frameBytes) {
+  const QJsonArray ops = obj.value("ops").toArray();
+
+  // The frame paid for one message; every further operation costs one more
+  if (ops.size() > 1 && !admitMessages(client, ops.size() - 1)) {
+    sendError(client, QStringLiteral("rate_limited"), obj.value("id"));
+    return;
+  }
+  const qsizetype bytesPerOp = frameBytes / std::max<qsizetype>(1, ops.size());
+
+  auto batch = std::make_shared<PendingBatch>();
+  batch->client = client;
+  batch->id = obj.value("id");
+  for (qsizetype index = 0; index < ops.size(); ++index) {
+    batch->results.append(QJsonValue());
+  }
+  // Held by this loop, so commands answered synchronously cannot finish early
+  batch->outstanding = 1;
+
+  for (qsizetype index = 0; index < ops.size(); ++index) {
+    const QJsonObject op = ops.at(index).toObject();
+    QJsonObject result;
+    if (op.contains("id")) {
+      result["id"] = op.value("id");
+    }
+
+    QString error;
+    const QString type = op.value("type").toString();
+    if (!ops.at(index).isObject() || type == QLatin1String("batch")) {
+      error = QStringLiteral("invalid_operation");
+    } else if (validateMessage(op, error)) {
+      if (type == QLatin1String("service_command")) {
+        const QString command = op.value("command").toString();
+        if (validateServiceCommand(command, error)) {
+          ++batch->outstanding;
+          runServiceCommand(command, op.value("params").toObject().toVariantMap(),
+                            [this, batch, index, result](const QJsonObject& response) {
+                              QJsonObject entry = response;
+                              if (result.contains("id")) {
+                                entry["id"] = result.value("id");
+                              }
+                              batch->results[index] = entry;
+                              if (--batch->outstanding == 0) {
+                                finishBatch(*batch);
+                              }
+                            });
+          continue;
+        }
+      } else if (applyOperation(client, op, bytesPerOp, error)) {
+        result["success"] = true;
+        batch->results[index] = result;
+        continue;
+      }
+    }
+
+    result["success"] = false;
+    result["error"] = error;
+    batch->results[index] = result;
+  }
+
+  if (--batch->outstanding == 0) {
+    finishBatch(*batch);
   }
 }
 
+void WebSocketServer::finishBatch(const PendingBatch& batch) {
+  if (!batch.client) {
+    return;
+  }
+  QJsonObject response;
+  response["type"] = "batch_response";
+  if (!batch.id.isUndefined()) {
+    response["id"] = batch.id;
+  }
+  response["results"] = batch.results;
+  sendMessage(batch.client, response);
+}
+
 void WebSocketServer::onClientDisconnected() {
-  QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-  if (client) {
+  QObject* client = sender();
+  if (client && m_clientSlotOf.contains(client)) {
+    const int slot = m_clientSlotOf.take(client);
     Logger::instance().info(
-        QString("Client disconnected: %1").arg(client->peerAddress().toString()));
+        QString("Client disconnected: %1").arg(m_clientSlots.at(slot).peerName()));
     m_clients.removeOne(client);
-    m_subscriptions.remove(client);
+    m_localInbound.remove(client);
+    for (const QString& pattern : m_subscriptions.take(client)) {
+      m_subscriptionIndex.remove(pattern, slot);
+    }
+    for (const QString& pattern : std::as_const(m_clientSlots[slot].deltaPatterns)) {
+      m_deltaIndex.remove(pattern, slot);
+      --m_deltaSubscriptions;
+    }
+    m_clientSlots[slot] = ClientSlot();
+    m_recipientCache.clear();
+    m_deltaRecipientCache.clear();
     client->deleteLater();
   }
 }
 
-void WebSocketServer::handleSubscribe(QWebSocket* client, const QString& topic) {
+bool WebSocketServer::handleSubscribe(QObject* client, const QString& topic, bool delta,
+                                     QString& error) {
+  const int slot = m_clientSlotOf.value(client);
   if (!m_subscriptions[client].contains(topic)) {
+    if (!m_subscriptionIndex.insert(topic, m_clientSlotOf.value(client))) {
+      Logger::instance().warning(
+          QString("[WebSocketServer] Invalid subscription pattern: %1").arg(topic));
+      error = QStringLiteral("invalid_topic");
+      return false;
+    }
+    m_recipientCache.clear();
     m_subscriptions[client].append(topic);
+    setDeltaSubscription(slot, topic, delta);
     Logger::instance().info(QString("[WebSocketServer] Client subscribed to topic: %1").arg(topic));
     Logger::instance().info(QString("[WebSocketServer] Client now has %1 subscriptions")
                                 .arg(m_subscriptions[client].size()));
     for (const auto& sub : std::as_const(m_subscriptions[client])) {
-      Logger::instance().debug(QString("[WebSocketServer]   - %1").arg(sub));
-    }
-
-    // Send current Android Auto state when subscribing to android-auto topics
-    if (topic.startsWith("android-auto") && m_serviceManager) {
-      AndroidAutoService* aaService = m_serviceManager->getAndroidAutoService();
-      if (aaService) {
-        Logger::instance().info(
-            "[WebSocketServer] Sending current Android Auto state to new subscriber");
-        int currentState = static_cast<int>(aaService->getConnectionState());
-        onAndroidAutoStateChanged(currentState);
-
-        // If connected, also send device info
-        if (aaService->isConnected()) {
-          AndroidAutoService::AndroidDevice device = aaService->getConnectedDevice();
-          QVariantMap deviceMap;
-          deviceMap["serial_number"] = device.serialNumber;
-          deviceMap["manufacturer"] = device.manufacturer;
-          deviceMap["model"] = device.model;
-          deviceMap["android_version"] = device.androidVersion;
-          deviceMap["connected"] = device.connected;
-          onAndroidAutoConnected(deviceMap);
-        }
+      CRANKSHAFT_LOG_DEBUG(QString("[WebSocketServer]   - %1").arg(sub));
+    }
+
+    // Bootstrap the new subscriber with the current state of every matching
+    // topic; only this client receives the replay
+    const QList<Event> retained = EventBus::instance().retainedEvents(topic);
+    for (const Event& event : retained) {
+      if (delta) {
+        enqueue(slot, stateFrame(slot, event, QJsonObject::fromVariantMap(event.payload())));
+      } else {
+        sendEvent(client, event);
       }
     }
   } else {
-    Logger::instance().debug(
-        QString("[WebSocketServer] Client already subscribed to: %1").arg(topic));
+    CRANKSHAFT_LOG_DEBUG(QString("[WebSocketServer] Client already subscribed to: %1").arg(topic));
+    setDeltaSubscription(slot, topic, delta);
+    // A repeated delta subscribe is the client's way to ask for a resync
+    if (delta) {
+      const QList<Event> retained = EventBus::instance().retainedEvents(topic);
+      for (const Event& event : retained) {
+        enqueue(slot, stateFrame(slot, event, QJsonObject::fromVariantMap(event.payload())));
+      }
+    }
+  }
+  return true;
+}
+
+void WebSocketServer::setDeltaSubscription(int slot, const QString& pattern, bool delta) {
+  ClientSlot& client = m_clientSlots[slot];
+  const bool wasDelta = client.deltaPatterns.contains(pattern);
+  if (delta && !wasDelta) {
+    m_deltaIndex.insert(pattern, slot);
+    client.deltaPatterns.append(pattern);
+    ++m_deltaSubscriptions;
+    m_deltaRecipientCache.clear();
+  } else if (!delta && wasDelta) {
+    m_deltaIndex.remove(pattern, slot);
+    client.deltaPatterns.removeOne(pattern);
+    --m_deltaSubscriptions;
+    m_deltaRecipientCache.clear();
+  }
+  if (delta) {
+    // Every delta topic of the client restarts from a snapshot
+    client.deltaState.clear();
   }
 }
 
@@ -188,8 +598,30 @@ void WebSocketServer::handlePublish(const QString& topic, const QVariantMap& pay
   EventBus::instance().publish(topic, payload);
 }
 
-void WebSocketServer::handleServiceCommand(QWebSocket* client, const QString& command,
-                                           const QVariantMap& params) {
+void WebSocketServer::handleServiceCommand(QObject* client, const QString& command,
+                                           const QVariantMap& params, const QJsonValue& id) {
+  // Responses carry the request id, so clients can pipeline commands and
+  // match replies that complete out of order; the client may be gone by then
+  QPointer<QObject> target(client);
+  runServiceCommand(command, params, [this, target, id](const QJsonObject& response) {
+    if (!target) {
+      return;
+    }
+    QJsonObject reply = response;
+    if (!id.isUndefined()) {
+      reply["id"] = id;
+    }
+    sendMessage(target, reply);
+  });
+}
+
+void WebSocketServer::runServiceCommand(const QString& command, const QVariantMap& params,
+                                        std::function<void(const QJsonObject&)> done) {
+  if (command == QLatin1String("set_log_level") || command == QLatin1String("get_log_levels")) {
+    done(executeLoggingCommand(command, params));
+    return;
+  }
+
   if (!m_serviceManager) {
     Logger::instance().warning("[WebSocketServer] ServiceManager not available for command: " +
                                command);
@@ -199,53 +631,50 @@ void WebSocketServer::handleServiceCommand(QWebSocket* client, const QString& co
     response["command"] = command;
     response["success"] = false;
     response["error"] = "ServiceManager not available";
-    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+    done(response);
     return;
   }
 
   Logger::instance().info(QString("[WebSocketServer] Handling service command: %1").arg(command));
 
+  // Lifecycle commands can take hundreds of milliseconds: acknowledge with a
+  // job id now and report progress and completion on the EventBus
+  if (ServiceJobQueue::isJobCommand(command)) {
+    QString error;
+    const QString jobId = m_jobQueue->submit(command, params, error);
+    QJsonObject response;
+    response["type"] = "service_response";
+    response["command"] = command;
+    response["success"] = !jobId.isEmpty();
+    if (jobId.isEmpty()) {
+      response["error"] = error;
+    } else {
+      response["job_id"] = jobId;
+      response["status"] = "queued";
+    }
+    response["timestamp"] = QDateTime::currentSecsSinceEpoch();
+    done(response);
+    return;
+  }
+
+  // ServiceManager lives on the main thread: run the command there and hand
+  // the response back to this thread
+  m_serviceMailbox->post([this, command, params, done = std::move(done)]() {
+    const QJsonObject response = executeServiceCommand(command, params);
+    m_mailbox.post([done, response]() { done(response); });
+  });
+}
+
+QJsonObject WebSocketServer::executeServiceCommand(const QString& command,
+                                                   const QVariantMap& params) {
+  Q_UNUSED(params);
   QJsonObject response;
   response["type"] = "service_response";
   response["command"] = command;
   bool success = false;
   QString error;
 
-  if (command == "reload_services") {
-    m_serviceManager->reloadServices();
-    success = true;
-    Logger::instance().info("[WebSocketServer] Services reloaded via WebSocket command");
-  } else if (command == "start_service") {
-    QString serviceName = params.value("service").toString();
-    if (!serviceName.isEmpty()) {
-      success = m_serviceManager->startService(serviceName);
-      Logger::instance().info(QString("[WebSocketServer] Start service '%1': %2")
-                                  .arg(serviceName)
-                                  .arg(success ? "success" : "failed"));
-    } else {
-      error = "Missing 'service' parameter";
-    }
-  } else if (command == "stop_service") {
-    QString serviceName = params.value("service").toString();
-    if (!serviceName.isEmpty()) {
-      success = m_serviceManager->stopService(serviceName);
-      Logger::instance().info(QString("[WebSocketServer] Stop service '%1': %2")
-                                  .arg(serviceName)
-                                  .arg(success ? "success" : "failed"));
-    } else {
-      error = "Missing 'service' parameter";
-    }
-  } else if (command == "restart_service") {
-    QString serviceName = params.value("service").toString();
-    if (!serviceName.isEmpty()) {
-      success = m_serviceManager->restartService(serviceName);
-      Logger::instance().info(QString("[WebSocketServer] Restart service '%1': %2")
-                                  .arg(serviceName)
-                                  .arg(success ? "success" : "failed"));
-    } else {
-      error = "Missing 'service' parameter";
-    }
-  } else if (command == "get_running_services") {
+  if (command == "get_running_services") {
     QStringList services = m_serviceManager->getRunningServices();
     response["services"] = QJsonArray::fromStringList(services);
     success = true;
@@ -261,165 +690,195 @@ void WebSocketServer::handleServiceCommand(QWebSocket* client, const QString& co
     response["error"] = error;
   }
   response["timestamp"] = QDateTime::currentSecsSinceEpoch();
+  return response;
+}
+
+QJsonObject WebSocketServer::executeLoggingCommand(const QString& command,
+                                                   const QVariantMap& params) {
+  QJsonObject response;
+  response["type"] = "service_response";
+  response["command"] = command;
+  Logger& logger = Logger::instance();
+
+  if (command == QLatin1String("set_log_level")) {
+    // {"level": "debug"} sets the global level; with "component" it overrides
+    // that component only, and "level": "default" removes the override
+    const QString component = params.value("component").toString();
+    const QString levelName = params.value("level").toString().toLower();
+    const bool reset = !component.isEmpty() && levelName == QLatin1String("default");
+    const Logger::Level level = Logger::levelFromString(levelName, Logger::Level::Fatal);
+    if (!reset && level == Logger::Level::Fatal && levelName != QLatin1String("fatal")) {
+      response["success"] = false;
+      response["error"] = "invalid_level";
+      return response;
+    }
+    if (reset) {
+      logger.clearComponentLevel(component);
+    } else if (component.isEmpty()) {
+      logger.setLevel(level);
+    } else {
+      logger.setComponentLevel(component, level);
+    }
+    Logger::instance().info(
+        QString("[WebSocketServer] Log level for %1 set to %2")
+            .arg(component.isEmpty() ? QStringLiteral("all components") : component, levelName));
+  }
 
-  client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+  response["level"] = Logger::levelName(logger.level());
+  response["components"] = QJsonObject::fromVariantMap(logger.componentLevels());
+  response["suppressed"] = static_cast<qint64>(logger.suppressedRecords());
+  response["dropped"] = static_cast<qint64>(logger.droppedRecords());
+  response["success"] = true;
+  response["timestamp"] = QDateTime::currentSecsSinceEpoch();
+  return response;
 }
 
 void WebSocketServer::broadcastEvent(const QString& topic, const QVariantMap& payload) {
-  Logger::instance().info(
-      QString("[WebSocketServer] broadcastEvent called - Topic: %1").arg(topic));
-  Logger::instance().info(
-      QString("[WebSocketServer] Payload keys: %1").arg(payload.keys().join(", ")));
+  broadcastEvent(Event(topic, payload));
+}
 
-  QJsonObject obj;
-  obj["type"] = "event";
-  obj["topic"] = topic;
-  obj["payload"] = QJsonObject::fromVariantMap(payload);
-  obj["timestamp"] = QDateTime::currentSecsSinceEpoch();
+/**
+ * @brief Fan an event out to every client with a matching subscription
+ *
+ * The receiving set comes from the compiled subscription trie in one pass
+ * (cached per topic). Each wire form is produced at most once per event:
+ * text clients share the event's cached QString (Event::toJsonText()), so
+ * retained replays and later broadcasts of the same event do not decode the
+ * UTF-8 envelope again, and binary clients share its CBOR buffer.
+ */
+void WebSocketServer::broadcastEvent(const Event& event) {
+  const QBitArray recipients = recipientsFor(event.topic());
+  if (recipients.isEmpty()) {
+    return;
+  }
 
-  QJsonDocument doc(obj);
-  QString message = doc.toJson(QJsonDocument::Compact);
+  const QBitArray deltaRecipients = deltaRecipientsFor(event.topic());
+  QJsonObject payload;  // Converted once, and only if a delta subscriber needs it
+  bool payloadConverted = false;
 
-  Logger::instance().info(QString("[WebSocketServer] Message JSON: %1").arg(message));
-  Logger::instance().info(
-      QString("[WebSocketServer] Number of connected clients: %1").arg(m_clients.size()));
-
-  for (auto* client : std::as_const(m_clients)) {
-    bool shouldSend = false;
-    Logger::instance().debug(QString("[WebSocketServer] Checking subscriptions for client %1")
-                                 .arg(m_clients.indexOf(client)));
-
-    for (const QString& subscription : std::as_const(m_subscriptions[client])) {
-      Logger::instance().debug(
-          QString("[WebSocketServer]   Subscription pattern: %1, Topic: %2, Match: %3")
-              .arg(subscription)
-              .arg(topic)
-              .arg(topicMatches(topic, subscription) ? "YES" : "NO"));
-      if (topicMatches(topic, subscription)) {
-        shouldSend = true;
-        break;
+  for (qsizetype slot = 0; slot < recipients.size(); ++slot) {
+    if (!recipients.testBit(slot)) {
+      continue;
+    }
+    if (slot < deltaRecipients.size() && deltaRecipients.testBit(slot)) {
+      if (!payloadConverted) {
+        payload = QJsonObject::fromVariantMap(event.payload());
+        payloadConverted = true;
       }
+      enqueue(static_cast<int>(slot), stateFrame(static_cast<int>(slot), event, payload));
+      continue;
     }
-
-    if (shouldSend) {
-      Logger::instance().info(
-          QString("[WebSocketServer] Sending event to client (matched subscription)"));
-      client->sendTextMessage(message);
+    OutboundFrame frame;
+    frame.topic = event.topic();
+    if (m_clientSlots.at(slot).format == WireFormat::Cbor) {
+      frame.binary = event.toCbor();
+      frame.bytes = frame.binary.size();
     } else {
-      Logger::instance().debug(QString("[WebSocketServer] Client has no matching subscription"));
+      frame.text = event.toJsonText();
+      frame.bytes = event.toJson().size();
     }
+    enqueue(static_cast<int>(slot), std::move(frame));
   }
 }
 
-bool WebSocketServer::topicMatches(const QString& topic, const QString& pattern) const {
-  // Handle exact match
-  if (topic == pattern) {
-    return true;
-  }
+/**
+ * @brief Resolve the set of client slots subscribed to a topic
+ * @return Bitset indexed by client slot, or an empty array if nobody matches
+ */
+QBitArray WebSocketServer::recipientsFor(const QString& topic) {
+  return resolveRecipients(m_subscriptionIndex, m_recipientCache, topic);
+}
 
-  // Handle wildcard '*' - matches everything
-  if (pattern == "*") {
-    return true;
+QBitArray WebSocketServer::deltaRecipientsFor(const QString& topic) {
+  if (m_deltaSubscriptions == 0) {
+    return {};
   }
+  return resolveRecipients(m_deltaIndex, m_deltaRecipientCache, topic);
+}
 
-  // Handle pattern with wildcard like 'test/*'
-  if (pattern.endsWith("/*")) {
-    QString prefix = pattern.left(pattern.length() - 2);
-    return topic.startsWith(prefix + "/");
+QBitArray WebSocketServer::resolveRecipients(const TopicTrie<int>& index,
+                                             QHash<QString, QBitArray>& cache,
+                                             const QString& topic) {
+  const auto cached = cache.constFind(topic);
+  if (cached != cache.constEnd()) {
+    return cached.value();
   }
 
-  // Handle MQTT-style '#' wildcard - matches everything including nested levels
-  if (pattern.endsWith("/#")) {
-    QString prefix = pattern.left(pattern.length() - 2);
-    return topic.startsWith(prefix + "/");
-  }
+  QBitArray recipients;
+  index.match(topic, [this, &recipients](int slot) {
+    if (recipients.isEmpty()) {
+      recipients.resize(m_clientSlots.size());
+    }
+    recipients.setBit(slot);
+  });
 
-  return false;
+  if (cache.size() >= kMaxCachedTopics) {
+    cache.clear();
+  }
+  cache.insert(topic, recipients);
+  return recipients;
 }
 
-void WebSocketServer::setupAndroidAutoConnections() {
-  if (!m_serviceManager) {
-    Logger::instance().warning(
-        "[WebSocketServer] ServiceManager not set, cannot setup Android Auto connections");
-    return;
+/**
+ * @brief Build the next frame of a client's snapshot/delta chain for a topic
+ *
+ * The first update (or the first after a reset) is a full snapshot. Later
+ * ones carry a patch against the payload last sent to this client, unless
+ * the resync interval is reached or the patch would touch as many members
+ * as the payload has, in which case a snapshot is cheaper to apply.
+ */
+WebSocketServer::OutboundFrame WebSocketServer::stateFrame(int slot, const Event& event,
+                                                           const QJsonObject& payload) {
+  ClientSlot& client = m_clientSlots[slot];
+  const QString topic = event.topic();
+  if (client.deltaState.size() >= kMaxDeltaTopicsPerClient && !client.deltaState.contains(topic)) {
+    client.deltaState.clear();
   }
-
-  AndroidAutoService* aaService = m_serviceManager->getAndroidAutoService();
-  if (!aaService) {
-    Logger::instance().warning(
-        "[WebSocketServer] Android Auto service not available - will not broadcast Android Auto "
-        "events");
-    return;
+  DeltaState& state = client.deltaState[topic];
+
+  QJsonObject message;
+  message["topic"] = topic;
+  message["seq"] = static_cast<qint64>(state.seq + 1);
+  message["timestamp"] = event.timestampMs() / 1000;
+
+  bool snapshot = state.seq == 0 || state.deltasSinceSnapshot >= m_deltaResyncInterval;
+  if (!snapshot) {
+    const QJsonArray patch = JsonPatch::diff(state.payload, payload);
+    if (patch.size() < std::max<qsizetype>(1, payload.size())) {
+      message["type"] = QStringLiteral("delta");
+      message["base"] = static_cast<qint64>(state.seq);
+      message["patch"] = patch;
+      ++state.deltasSinceSnapshot;
+    } else {
+      snapshot = true;
+    }
   }
-
-  Logger::instance().info(
-      "[WebSocketServer] Setting up Android Auto service signal connections...");
-
-  // Connect Android Auto service signals to WebSocket broadcast methods
-  connect(aaService, &AndroidAutoService::connectionStateChanged, this,
-          [this](AndroidAutoService::ConnectionState state) {
-            onAndroidAutoStateChanged(static_cast<int>(state));
-          });
-  connect(aaService, &AndroidAutoService::connected, this,
-          [this](const AndroidAutoService::AndroidDevice& device) {
-            QVariantMap deviceMap;
-            deviceMap["serial_number"] = device.serialNumber;
-            deviceMap["manufacturer"] = device.manufacturer;
-            deviceMap["model"] = device.model;
-            deviceMap["android_version"] = device.androidVersion;
-            deviceMap["connected"] = device.connected;
-            onAndroidAutoConnected(deviceMap);
-          });
-  connect(aaService, &AndroidAutoService::disconnected, this,
-          &WebSocketServer::onAndroidAutoDisconnected);
-  connect(aaService, &AndroidAutoService::errorOccurred, this,
-          &WebSocketServer::onAndroidAutoError);
-
-  Logger::instance().info("[WebSocketServer] Android Auto service connections setup");
-}
-
-void WebSocketServer::onAndroidAutoStateChanged(int state) {
-  Logger::instance().info(QString("[WebSocketServer] Android Auto state changed: %1").arg(state));
-  QVariantMap payload;
-  payload["state"] = state;
-
-  // Convert state enum to string
-  static const QStringList stateNames = {"DISCONNECTED",   "SEARCHING", "CONNECTING",
-                                         "AUTHENTICATING", "SECURING",  "CONNECTED",
-                                         "DISCONNECTING",  "ERROR"};
-
-  if (state >= 0 && state < stateNames.size()) {
-    payload["stateName"] = stateNames[state];
-    Logger::instance().info(
-        QString("[WebSocketServer] Broadcasting state: %1").arg(stateNames[state]));
+  if (snapshot) {
+    message["type"] = QStringLiteral("snapshot");
+    message["payload"] = payload;
+    state.deltasSinceSnapshot = 0;
   }
-
-  broadcastEvent("android-auto/status/state-changed", payload);
-}
-
-void WebSocketServer::onAndroidAutoConnected(const QVariantMap& device) {
-  QVariantMap payload;
-  payload["device"] = device;
-  payload["connected"] = true;
-  broadcastEvent("android-auto/status/connected", payload);
-}
-
-void WebSocketServer::onAndroidAutoDisconnected() {
-  QVariantMap payload;
-  payload["connected"] = false;
-  broadcastEvent("android-auto/status/disconnected", payload);
-}
-
-void WebSocketServer::onAndroidAutoError(const QString& error) {
-  QVariantMap payload;
-  payload["error"] = error;
-  broadcastEvent("android-auto/status/error", payload);
+  ++state.seq;
+  state.payload = payload;
+
+  OutboundFrame frame;
+  frame.topic = topic;
+  frame.delta = true;
+  if (client.format == WireFormat::Cbor) {
+    frame.binary = QCborValue::fromJsonValue(message).toCbor();
+    frame.bytes = frame.binary.size();
+  } else {
+    const QByteArray json = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    frame.text = QString::fromUtf8(json);
+    frame.bytes = json.size();
+  }
+  return frame;
 }
 
 bool WebSocketServer::validateMessage(const QJsonObject& obj, QString& error) const {
   static const QSet<QString> allowedTypes = {
       QStringLiteral("subscribe"), QStringLiteral("unsubscribe"), QStringLiteral("publish"),
-      QStringLiteral("service_command")};
+      QStringLiteral("service_command"), QStringLiteral("batch")};
 
   const QString type = obj.value("type").toString();
   if (type.isEmpty() || !allowedTypes.contains(type)) {
@@ -427,6 +886,25 @@ bool WebSocketServer::validateMessage(const QJsonObject& obj, QString& error) co
     return false;
   }
 
+  // Correlation ids are echoed verbatim, so only scalars are accepted
+  if (obj.contains("id") && !obj.value("id").isString() && !obj.value("id").isDouble()) {
+    error = QStringLiteral("invalid_id");
+    return false;
+  }
+
+  // Contract schemas, compiled once at startup, replace the hand checks below
+  if (m_messageValidator.hasSchemaFor(type)) {
+    return m_messageValidator.validate(type, obj, error);
+  }
+
+  if (type == "batch") {
+    const QJsonValue ops = obj.value("ops");
+    if (!ops.isArray() || ops.toArray().isEmpty() || ops.toArray().size() > kMaxBatchOps) {
+      error = QStringLiteral("invalid_batch");
+      return false;
+    }
+  }
+
   // Validate required fields for each type
   if (type == "subscribe" || type == "unsubscribe" || type == "publish") {
     if (!obj.contains("topic") || obj.value("topic").toString().isEmpty()) {
@@ -460,7 +938,8 @@ bool WebSocketServer::validateServiceCommand(const QString& command, QString& er
   static const QSet<QString> allowedCommands = {
       QStringLiteral("reload_services"), QStringLiteral("start_service"),
       QStringLiteral("stop_service"), QStringLiteral("restart_service"),
-      QStringLiteral("get_running_services")};
+      QStringLiteral("get_running_services"), QStringLiteral("set_log_level"),
+      QStringLiteral("get_log_levels")};
 
   if (!allowedCommands.contains(command)) {
     error = QStringLiteral("unauthorised_command");
@@ -469,7 +948,7 @@ bool WebSocketServer::validateServiceCommand(const QString& command, QString& er
   return true;
 }
 
-void WebSocketServer::sendError(QWebSocket* client, const QString& message) const {
+void WebSocketServer::sendError(QObject* client, const QString& message, const QJsonValue& id) {
   if (!client) {
     return;
   }
@@ -477,27 +956,324 @@ void WebSocketServer::sendError(QWebSocket* client, const QString& message) cons
   QJsonObject errorObj;
   errorObj["type"] = "error";
   errorObj["message"] = message;
-  QJsonDocument doc(errorObj);
-  client->sendTextMessage(doc.toJson(QJsonDocument::Compact));
-  Logger::instance().debug(QString("[WebSocketServer] Sent error to client: %1").arg(message));
+  if (!id.isUndefined()) {
+    errorObj["id"] = id;
+  }
+  sendMessage(client, errorObj);
+  CRANKSHAFT_LOG_DEBUG(QString("[WebSocketServer] Sent error to client: %1").arg(message));
+}
+
+void WebSocketServer::sendMessage(QObject* client, const QJsonObject& message) {
+  OutboundFrame frame;
+  if (formatOf(client) == WireFormat::Cbor) {
+    frame.binary = QCborValue::fromJsonValue(message).toCbor();
+    frame.bytes = frame.binary.size();
+  } else {
+    const QByteArray json = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    frame.text = QString::fromUtf8(json);
+    frame.bytes = json.size();
+  }
+
+  const auto slot = m_clientSlotOf.constFind(client);
+  if (slot == m_clientSlotOf.constEnd()) {
+    return;
+  }
+  enqueue(slot.value(), std::move(frame));
+}
+
+void WebSocketServer::sendEvent(QObject* client, const Event& event) {
+  const auto slot = m_clientSlotOf.constFind(client);
+  if (slot == m_clientSlotOf.constEnd()) {
+    return;
+  }
+  OutboundFrame frame;
+  frame.topic = event.topic();
+  if (m_clientSlots.at(slot.value()).format == WireFormat::Cbor) {
+    frame.binary = event.toCbor();
+    frame.bytes = frame.binary.size();
+  } else {
+    frame.text = event.toJsonText();
+    frame.bytes = event.toJson().size();
+  }
+  enqueue(slot.value(), std::move(frame));
+}
+
+/**
+ * @brief Send a frame, or queue it if the client is not keeping up
+ *
+ * Frames go straight to the socket while nothing is queued and Qt's own
+ * buffer is below socketBufferBytes. Otherwise they are queued and the
+ * slow-consumer policy keeps the queue within maxMessages/maxBytes.
+ */
+void WebSocketServer::enqueue(int slot, OutboundFrame frame) {
+  ClientSlot& client = m_clientSlots[slot];
+  if (!client.isOpen()) {
+    return;
+  }
+
+  if (client.outbound.isEmpty() && client.bytesToWrite() < m_outboundLimits.socketBufferBytes) {
+    writeFrame(client, frame);
+    return;
+  }
+
+  if (m_outboundLimits.policy == SlowConsumerPolicy::Conflate && !frame.topic.isEmpty()) {
+    // Delta chains cannot skip a link, so their frames are never conflated
+    for (OutboundFrame& queued : client.outbound) {
+      if (queued.topic == frame.topic && !queued.delta && !frame.delta) {
+        client.queuedBytes += frame.bytes - queued.bytes;
+        queued = std::move(frame);
+        ++client.conflated;
+        return;
+      }
+    }
+  }
+
+  client.queuedBytes += frame.bytes;
+  client.outbound.enqueue(std::move(frame));
+
+  // The newest frame is always kept, even if it alone exceeds maxBytes
+  while (client.outbound.size() > m_outboundLimits.maxMessages ||
+         (client.queuedBytes > m_outboundLimits.maxBytes && client.outbound.size() > 1)) {
+    if (m_outboundLimits.policy == SlowConsumerPolicy::Disconnect) {
+      ++m_slowConsumerDisconnects;
+      Logger::instance().warning(
+          QString("[WebSocketServer] Disconnecting slow client %1 (%2 frames, %3 bytes queued)")
+              .arg(client.peerName())
+              .arg(client.outbound.size())
+              .arg(client.queuedBytes));
+      client.outbound.clear();
+      client.queuedBytes = 0;
+      if (client.socket) {
+        client.socket->close(QWebSocketProtocol::CloseCodePolicyViolated,
+                             QStringLiteral("Outbound queue limit exceeded"));
+      } else {
+        client.local->disconnectFromServer();
+      }
+      return;
+    }
+    const OutboundFrame dropped = client.outbound.dequeue();
+    client.queuedBytes -= dropped.bytes;
+    ++client.dropped;
+    if (dropped.delta) {
+      // The client's chain for this topic is broken; its next update is a snapshot
+      client.deltaState.remove(dropped.topic);
+    }
+  }
+}
+
+void WebSocketServer::flushOutbound(int slot) {
+  ClientSlot& client = m_clientSlots[slot];
+  while (!client.outbound.isEmpty() && client.connection() &&
+         client.bytesToWrite() < m_outboundLimits.socketBufferBytes) {
+    const OutboundFrame frame = client.outbound.dequeue();
+    client.queuedBytes -= frame.bytes;
+    writeFrame(client, frame);
+  }
+}
+
+void WebSocketServer::writeFrame(const ClientSlot& client, const OutboundFrame& frame) {
+  if (client.local) {
+    // Header and shared CBOR buffer are appended to the socket buffer as-is
+    const quint32 length = qToBigEndian(static_cast<quint32>(frame.binary.size()));
+    client.local->write(reinterpret_cast<const char*>(&length), sizeof(length));
+    client.local->write(frame.binary);
+  } else if (!frame.binary.isNull()) {
+    client.socket->sendBinaryMessage(frame.binary);
+  } else {
+    client.socket->sendTextMessage(frame.text);
+  }
+}
+
+QObject* WebSocketServer::ClientSlot::connection() const {
+  if (socket) {
+    return socket;
+  }
+  return local;
+}
+
+bool WebSocketServer::ClientSlot::isOpen() const {
+  if (socket) {
+    return socket->state() == QAbstractSocket::ConnectedState;
+  }
+  return local && local->state() == QLocalSocket::ConnectedState;
+}
+
+qint64 WebSocketServer::ClientSlot::bytesToWrite() const {
+  if (socket) {
+    return socket->bytesToWrite();
+  }
+  return local ? local->bytesToWrite() : 0;
+}
+
+QString WebSocketServer::ClientSlot::peerName() const {
+  if (socket) {
+    return QString("%1:%2").arg(socket->peerAddress().toString()).arg(socket->peerPort());
+  }
+  return local ? QString("local:%1").arg(local->socketDescriptor()) : QString();
+}
+
+void WebSocketServer::setOutboundLimits(const OutboundLimits& limits) {
+  m_outboundLimits = limits;
+}
+
+WebSocketServer::OutboundLimits WebSocketServer::outboundLimits() const {
+  return m_outboundLimits;
+}
+
+void WebSocketServer::setInboundLimits(const InboundLimits& limits) {
+  m_inboundLimits = limits;
+  for (ClientSlot& client : m_clientSlots) {
+    client.messageBucket = TokenBucket(limits.messagesPerSecond, limits.messageBurst);
+    client.publishBucket = TokenBucket(limits.publishBytesPerSecond, limits.publishByteBurst);
+    client.throttled = false;
+  }
+}
+
+WebSocketServer::InboundLimits WebSocketServer::inboundLimits() const {
+  return m_inboundLimits;
 }
 
-void WebSocketServer::handleUnsubscribe(QWebSocket* client, const QString& topic) {
+void WebSocketServer::setDeltaResyncInterval(int updates) {
+  m_deltaResyncInterval = std::max(1, updates);
+}
+
+int WebSocketServer::deltaResyncInterval() const {
+  return m_deltaResyncInterval;
+}
+
+WebSocketServer::SlowConsumerPolicy WebSocketServer::policyFromString(
+    const QString& name, SlowConsumerPolicy fallback) {
+  if (name == QLatin1String("drop-oldest")) {
+    return SlowConsumerPolicy::DropOldest;
+  }
+  if (name == QLatin1String("conflate")) {
+    return SlowConsumerPolicy::Conflate;
+  }
+  if (name == QLatin1String("disconnect")) {
+    return SlowConsumerPolicy::Disconnect;
+  }
+  return fallback;
+}
+
+QList<WebSocketServer::ClientStats> WebSocketServer::clientStats() const {
+  QList<ClientStats> stats;
+  for (const ClientSlot& client : m_clientSlots) {
+    if (!client.connection()) {
+      continue;
+    }
+    ClientStats entry;
+    entry.peer = client.peerName();
+    entry.queuedMessages = client.outbound.size();
+    entry.queuedBytes = client.queuedBytes;
+    entry.socketBytesToWrite = client.bytesToWrite();
+    entry.dropped = client.dropped;
+    entry.conflated = client.conflated;
+    entry.rateLimited = client.rateLimited;
+    entry.publishRateLimited = client.publishRateLimited;
+    stats.append(entry);
+  }
+  return stats;
+}
+
+quint64 WebSocketServer::slowConsumerDisconnects() const {
+  return m_slowConsumerDisconnects;
+}
+
+bool WebSocketServer::loadMessageSchema(const QString& path) {
+  return m_messageValidator.loadSchema(path);
+}
+
+MessageValidator::Stats WebSocketServer::validationStats() const {
+  return m_messageValidator.stats();
+}
+
+void WebSocketServer::setStatsInterval(int intervalMs) {
+  if (intervalMs <= 0) {
+    delete m_statsTimer;
+    m_statsTimer = nullptr;
+    return;
+  }
+  if (!m_statsTimer) {
+    m_statsTimer = new QTimer(this);
+    connect(m_statsTimer, &QTimer::timeout, this, &WebSocketServer::publishStats);
+  }
+  m_statsTimer->start(intervalMs);
+}
+
+void WebSocketServer::publishStats() {
+  QVariantList clients;
+  quint64 dropped = 0;
+  quint64 rateLimited = 0;
+  for (const ClientStats& stats : clientStats()) {
+    QVariantMap entry;
+    entry["peer"] = stats.peer;
+    entry["queued_messages"] = stats.queuedMessages;
+    entry["queued_bytes"] = stats.queuedBytes;
+    entry["socket_bytes_to_write"] = stats.socketBytesToWrite;
+    entry["dropped"] = stats.dropped;
+    entry["conflated"] = stats.conflated;
+    entry["rate_limited"] = stats.rateLimited;
+    entry["publish_rate_limited"] = stats.publishRateLimited;
+    clients.append(entry);
+    dropped += stats.dropped;
+    rateLimited += stats.rateLimited + stats.publishRateLimited;
+  }
+
+  QVariantMap payload;
+  payload["clients"] = clients;
+  payload["dropped"] = dropped;
+  payload["slow_consumer_disconnects"] = m_slowConsumerDisconnects;
+  payload["rate_limited"] = rateLimited;
+
+  const MessageValidator::Stats validation = m_messageValidator.stats();
+  payload["validation"] = QVariantMap{{"validated", validation.validated},
+                                      {"rejected", validation.rejected},
+                                      {"average_ns", validation.averageNs},
+                                      {"max_ns", validation.maxNs}};
+  EventBus::instance().publish(QStringLiteral("websocket/stats"), payload);
+}
+
+WebSocketServer::WireFormat WebSocketServer::formatOf(QObject* client) const {
+  const auto slot = m_clientSlotOf.constFind(client);
+  if (slot == m_clientSlotOf.constEnd()) {
+    return WireFormat::Json;
+  }
+  return m_clientSlots.at(slot.value()).format;
+}
+
+/**
+ * @brief Offer the binary subprotocol during the opening handshake
+ *
+ * CBOR is listed first so clients offering both get binary frames. Older Qt
+ * releases cannot negotiate subprotocols and always fall back to JSON.
+ */
+void WebSocketServer::configureSubprotocols() {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+  m_server->setSupportedSubprotocols(
+      {QLatin1String(kCborSubprotocol), QLatin1String(kJsonSubprotocol)});
+#endif
+}
+
+bool WebSocketServer::handleUnsubscribe(QObject* client, const QString& topic, QString& error) {
   if (!m_subscriptions.contains(client)) {
     Logger::instance().warning("[WebSocketServer] Unsubscribe from unknown client");
-    sendError(client, QStringLiteral("client_not_found"));
-    return;
+    error = QStringLiteral("client_not_found");
+    return false;
   }
 
   if (!m_subscriptions[client].contains(topic)) {
-    Logger::instance().debug(QString("[WebSocketServer] Client not subscribed to: %1").arg(topic));
-    sendError(client, QStringLiteral("not_subscribed"));
-    return;
+    CRANKSHAFT_LOG_DEBUG(QString("[WebSocketServer] Client not subscribed to: %1").arg(topic));
+    error = QStringLiteral("not_subscribed");
+    return false;
   }
 
   m_subscriptions[client].removeOne(topic);
+  m_subscriptionIndex.remove(topic, m_clientSlotOf.value(client));
+  m_recipientCache.clear();
+  setDeltaSubscription(m_clientSlotOf.value(client), topic, false);
   Logger::instance().info(
       QString("[WebSocketServer] Client unsubscribed from topic: %1").arg(topic));
+  return true;
 }
 
 void WebSocketServer::enableSecureMode(const QString& certificatePath, const QString& keyPath) {
@@ -555,6 +1331,7 @@ void WebSocketServer::enableSecureMode(const QString& certificatePath, const QSt
   sslConfiguration.setPrivateKey(sslKey);
   sslConfiguration.setProtocol(QSsl::TlsV1_3OrLater);
   m_server->setSslConfiguration(sslConfiguration);
+  configureSubprotocols();
 
   // Listen on the secure port (typically 9003 for wss)
   quint16 securePort = 9003;
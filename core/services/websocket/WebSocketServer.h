@@ -19,16 +19,38 @@
 
 #pragma once
 
+#include <QBitArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
 #include <QList>
+#include <QLocalServer>
+#include <QLocalSocket>
 #include <QObject>
+#include <QPointer>
+#include <QQueue>
 #include <QSslConfiguration>
 #include <QWebSocket>
 #include <QWebSocketServer>
+#include <functional>
+#include <memory>
+
+class QThread;
+class QTimer;
+class EventBus;
 
 // Forward declarations
+class ServiceJobQueue;
 class ServiceManager;
 
 #include "../android_auto/AndroidAutoService.h"
+#include "../common/TokenBucket.h"
+#include "../eventbus/Event.h"
+#include "../eventbus/ThreadMailbox.h"
+#include "../eventbus/TopicTrie.h"
+#include "MessageValidator.h"
 
 /**
  * @brief WebSocket server for real-time event communication
@@ -58,11 +80,15 @@ class ServiceManager;
  *
  * PROTOCOL:
  * ────────
- * All messages are JSON. Client→Server commands:
+ * Messages are JSON text frames by default. A client that offers the
+ * "crankshaft.cbor.v1" WebSocket subprotocol in its handshake instead
+ * exchanges the same message objects CBOR-encoded in binary frames
+ * (smaller, and cheaper to encode/decode on Pi-class hardware). Clients
+ * offering nothing, or "crankshaft.json.v1", get JSON. Client→Server commands:
  *
  * {
  *   "action": "subscribe",        // Subscribe to event topic
- *   "topic": "android_auto/*"     // Wildcards supported: "*" or "**"
+ *   "topic": "android_auto/*"     // Wildcards: "+"/"*" one level, "#"/"**" many
  * }
  *
  * {
@@ -77,6 +103,17 @@ class ServiceManager;
  *   "params": {...}               // Command-specific parameters
  * }
  *
+ * {
+ *   "type": "batch",              // Up to kMaxBatchOps operations, one frame
+ *   "id": 7,                      // Optional correlation id (any request)
+ *   "ops": [{"type": "subscribe", "topic": "ui/#"}, ...]
+ * }
+ *
+ * A batch is answered by one "batch_response" whose "results" hold one
+ * {success, error?} entry (or service_response) per operation. Any request
+ * may carry an "id", echoed in its service_response or error, so several
+ * service commands can be pipelined without waiting for each reply.
+ *
  * Server→Client events:
  *
  * {
@@ -90,6 +127,16 @@ class ServiceManager;
  *   "message": "Invalid topic pattern"
  * }
  *
+ * Topic patterns use TopicTrie syntax: "+" (or an inner "*") matches one
+ * level anywhere, e.g. "android-auto/+/state-changed"; an inner "#"/"**"
+ * matches zero or more levels, and so does a trailing "#"/"**" as in MQTT
+ * ("ui/#" also matches "ui"); a trailing "*" matches one or more levels.
+ * Patterns are compiled once on subscribe.
+ *
+ * A new subscription is first sent the retained last event of every matching
+ * state topic (EventBus::retainedEvents()), so clients get current state at
+ * once. Only topics marked with EventBus::addRetainPattern() are replayed.
+ *
  * SCENARIO EXAMPLES:
  * ─────────────────
  *
@@ -175,13 +222,61 @@ class ServiceManager;
  * - Memory per client: ~2KB (overhead) + subscriptions
  * - Max clients: Limited by ulimit (typically 1024 per process)
  * - Throughput: ~1000 events/sec with 10 clients
+ * - Fan-out: subscriptions are compiled into one topic trie; recipients are
+ *   resolved once per topic as a client bitset and the encoded event is
+ *   shared by every recipient
  * - CPU: <1% for typical automotive scenario (~10 events/sec)
  *
+ * SLOW CONSUMERS:
+ * ───────────────
+ * Frames are only handed to a QWebSocket while its bytesToWrite() is below
+ * OutboundLimits::socketBufferBytes; beyond that they wait in a per-client
+ * queue bounded in messages and bytes. When the queue is full the
+ * configured SlowConsumerPolicy drops the oldest frame, replaces a queued
+ * event of the same topic, or disconnects the client, so a stalled client
+ * costs bounded memory. clientStats() and the periodic "websocket/stats"
+ * event report queue depth and drop counts.
+ *
+ * DELTA UPDATES:
+ * ──────────────
+ * A subscribe with "delta": true opts that subscription into state
+ * updates: the client receives one {"type":"snapshot"} with the full
+ * payload per topic, then {"type":"delta"} messages carrying an RFC 6902
+ * patch against the previous payload ("seq" / "base" numbering per topic).
+ * A full snapshot is re-sent every deltaResyncInterval() updates, when a
+ * patch would be no smaller than the payload, and after a frame of the
+ * chain was dropped by the slow-consumer policy. Subscribing again with
+ * "delta": true forces a snapshot of every delta topic.
+ *
+ * INBOUND RATE LIMITS:
+ * ────────────────────
+ * Every client has two token buckets (InboundLimits): one for messages,
+ * charged per frame before it is parsed and per operation inside a batch,
+ * and one for publish bytes, charged before a publish reaches the EventBus.
+ * Frames over the limit are discarded unparsed; the client gets a single
+ * "rate_limited" error per throttling episode, and rejected publishes get
+ * "rate_limited" as their error. Per-client counts appear in clientStats().
+ *
+ * LOCAL ENDPOINT:
+ * ───────────────
+ * listenLocal() additionally accepts same-host clients on a Unix domain
+ * socket (QLocalServer), skipping the TCP stack, HTTP upgrade and frame
+ * masking. Each message is a 4-byte big-endian length followed by a CBOR
+ * map with the same schema as the WebSocket messages. Local clients share
+ * subscriptions, fan-out and outbound limits with WebSocket clients; with
+ * port 0 the TCP endpoint stays closed.
+ *
  * THREAD SAFETY:
  * ──────────────
- * - Server must be created and all methods called from Qt event thread
+ * - Server must be created and configured from the Qt event thread
+ * - startIoThread() then moves the server, its QWebSocketServer and all
+ *   client sockets to a dedicated "WebSocketIO" thread, so parsing,
+ *   validation and fan-out no longer compete with the main loop
+ * - Events arrive through relayEventBus(): a direct connection pushes each
+ *   Event into a lock-free ThreadMailbox drained on the server's thread
+ * - Service commands are handed to the ServiceManager's thread the same
+ *   way, and their responses come back through the server's mailbox
  * - EventBus::publish() called from various threads is safe
- * - broadcastEvent() converts to WS messages in event thread
  *
  * @note Thread-safe for event emission; connections must be made from same thread as server
  * creation
@@ -192,10 +287,15 @@ class WebSocketServer : public QObject {
  public:
   /**
    * @brief Construct WebSocket server on specified port
-   * @param port Port number to listen on (e.g. 8080)
+   * @param port Port number to listen on (e.g. 8080); 0 keeps TCP closed
    * @param parent Qt parent object
    */
   explicit WebSocketServer(quint16 port, QObject* parent = nullptr);
+
+  /// Subprotocol selecting compact JSON text frames (the default)
+  static constexpr const char* kJsonSubprotocol = "crankshaft.json.v1";
+  /// Subprotocol selecting CBOR-encoded binary frames
+  static constexpr const char* kCborSubprotocol = "crankshaft.cbor.v1";
   ~WebSocketServer() override;
 
   /**
@@ -206,12 +306,143 @@ class WebSocketServer : public QObject {
    */
   void broadcastEvent(const QString& topic, const QVariantMap& payload);
 
+  /**
+   * @brief Broadcast a shared bus event to all subscribed clients
+   *
+   * Uses the event's cached wire encoding, so the payload is serialised at
+   * most once per event regardless of how many consumers relay it.
+   *
+   * @param event Immutable event from the EventBus
+   */
+  void broadcastEvent(const Event& event);
+
+  /// What to do when a client's outbound queue is full
+  enum class SlowConsumerPolicy {
+    DropOldest,  ///< Discard the oldest queued frame
+    Conflate,    ///< Replace a queued event of the same topic, else drop oldest
+    Disconnect   ///< Close the connection (policy violation)
+  };
+
+  /// Per-client outbound buffering limits
+  struct OutboundLimits {
+    qsizetype maxMessages{1000};                 ///< Frames queued per client
+    qsizetype maxBytes{4 * 1024 * 1024};         ///< Bytes queued per client
+    qint64 socketBufferBytes{256 * 1024};        ///< Max bytesToWrite() before queueing
+    SlowConsumerPolicy policy{SlowConsumerPolicy::DropOldest};
+  };
+
+  /// Outbound queue statistics of one connected client
+  struct ClientStats {
+    QString peer;                ///< Peer address and port
+    qsizetype queuedMessages{0};
+    qsizetype queuedBytes{0};
+    qint64 socketBytesToWrite{0};  ///< Bytes buffered inside the socket
+    quint64 dropped{0};            ///< Frames discarded by the policy
+    quint64 conflated{0};          ///< Events replaced by a newer one
+    quint64 rateLimited{0};        ///< Inbound messages rejected by the message bucket
+    quint64 publishRateLimited{0};  ///< Publishes rejected by the publish byte bucket
+  };
+
+  /// Per-client inbound rate limits; a rate of 0 disables that bucket
+  struct InboundLimits {
+    double messagesPerSecond{200.0};         ///< Sustained messages (and batch operations)
+    double messageBurst{400.0};              ///< Messages accepted back to back
+    double publishBytesPerSecond{256 * 1024.0};  ///< Sustained publish frame bytes
+    double publishByteBurst{1024 * 1024.0};  ///< Publish bytes accepted back to back
+  };
+
+  /**
+   * @brief Set per-client inbound rate limits
+   * @note Connected clients start again with full buckets
+   */
+  void setInboundLimits(const InboundLimits& limits);
+
+  /**
+   * @brief Current per-client inbound rate limits
+   */
+  [[nodiscard]] auto inboundLimits() const -> InboundLimits;
+
+  /**
+   * @brief Set outbound queue limits and slow-consumer policy
+   * @note Applies to frames queued after the call
+   */
+  void setOutboundLimits(const OutboundLimits& limits);
+
+  /**
+   * @brief Current outbound queue limits
+   */
+  [[nodiscard]] auto outboundLimits() const -> OutboundLimits;
+
+  /**
+   * @brief Parse a policy name ("drop-oldest", "conflate", "disconnect")
+   * @return Parsed policy, or fallback for unknown names
+   */
+  static auto policyFromString(const QString& name, SlowConsumerPolicy fallback)
+      -> SlowConsumerPolicy;
+
+  /**
+   * @brief Outbound queue statistics for every connected client
+   */
+  [[nodiscard]] auto clientStats() const -> QList<ClientStats>;
+
+  /**
+   * @brief Clients disconnected by SlowConsumerPolicy::Disconnect since startup
+   */
+  [[nodiscard]] auto slowConsumerDisconnects() const -> quint64;
+
+  /**
+   * @brief Validate inbound messages against the contract schemas
+   * @param path ws-schema.json (see MessageValidator::defaultSchemaPath())
+   * @return true if the schemas were compiled; otherwise the built-in checks stay in use
+   * @note Call before startIoThread()
+   */
+  auto loadMessageSchema(const QString& path) -> bool;
+
+  /**
+   * @brief Schema validation counts and per-message cost
+   */
+  [[nodiscard]] auto validationStats() const -> MessageValidator::Stats;
+
+  /**
+   * @brief Send a full snapshot instead of a delta every N updates of a topic
+   * @param updates Deltas between snapshots (minimum 1)
+   */
+  void setDeltaResyncInterval(int updates);
+
+  [[nodiscard]] auto deltaResyncInterval() const -> int;
+
+  /**
+   * @brief Publish clientStats() on the EventBus as "websocket/stats"
+   * @param intervalMs Publish period; 0 disables
+   */
+  void setStatsInterval(int intervalMs);
+
+  /// Most operations accepted in one "batch" message
+  static constexpr qsizetype kMaxBatchOps = 256;
+
+  /// Largest accepted frame on the local endpoint
+  static constexpr quint32 kMaxLocalFrameBytes = 1024 * 1024;
+
   /**
    * @brief Check if server is actively listening for connections
-   * @return true if server is bound and listening
+   * @return true if the TCP or the local endpoint is listening
    */
   [[nodiscard]] auto isListening() const -> bool;
 
+  /**
+   * @brief Also accept clients on a Unix domain socket
+   * @param path Socket path (e.g. "/run/crankshaft/core.sock"); a stale
+   *        socket file left by a previous run is replaced
+   * @return true if the local endpoint is listening
+   * @note Call before startIoThread()
+   */
+  auto listenLocal(const QString& path) -> bool;
+
+  /**
+   * @brief Check if the Unix domain socket endpoint is listening
+   */
+  [[nodiscard]] auto isLocalListening() const -> bool;
+
   /**
    * @brief Enable SSL/TLS for secure connections (wss://)
    * @param certificatePath Path to PEM-encoded certificate file
@@ -229,33 +460,45 @@ class WebSocketServer : public QObject {
   /**
    * @brief Inject service manager for event relay
    * @param serviceManager Pointer to application ServiceManager
-   * @note Must be called before initializeServiceConnections()
    */
   void setServiceManager(ServiceManager* serviceManager);
 
   /**
-   * @brief Connect to all service signals for event forwarding
-   * @note Call after all services are started and serviceManager is set
+   * @brief Forward every EventBus event to subscribed clients
+   *
+   * Events are handed over through a lock-free mailbox straight from the
+   * bus dispatcher, independent of which thread the server lives in.
+   * Critical-lane topics use the mailbox's high-priority queue, so they are
+   * broadcast ahead of a backlog of normal events.
+   */
+  void relayEventBus(EventBus& bus);
+
+  /**
+   * @brief Move the server and its sockets to a dedicated I/O thread
+   * @note Call from the owning thread after configuration is complete
    */
-  void initializeServiceConnections();
+  void startIoThread();
+
+  /**
+   * @brief Bring the server back to the owning thread and stop the I/O thread
+   * @note Called automatically on destruction
+   */
+  void stopIoThread();
 
  private slots:
   /// Emitted when a new client connects; initializes event subscriptions
   void onNewConnection();
-  /// Processes incoming message from a connected client
+  /// Accepts pending clients on the Unix domain socket
+  void onNewLocalConnection();
+  /// Reassembles length-prefixed CBOR messages from a local client
+  void onLocalReadyRead();
+  /// Processes incoming JSON message from a connected client
   void onTextMessageReceived(const QString& message);
+  /// Processes incoming CBOR message from a binary-subprotocol client
+  void onBinaryMessageReceived(const QByteArray& message);
   /// Cleanup when client disconnects; removes subscriptions
   void onClientDisconnected();
 
-  /// Relay: AndroidAuto connection state changed
-  void onAndroidAutoStateChanged(int state);
-  /// Relay: AndroidAuto device connected successfully
-  void onAndroidAutoConnected(const QVariantMap& device);
-  /// Relay: AndroidAuto device disconnected
-  void onAndroidAutoDisconnected();
-  /// Relay: AndroidAuto service error occurred
-  void onAndroidAutoError(const QString& error);
-
  private:
   // Message validation and error reporting
   /**
@@ -276,36 +519,195 @@ class WebSocketServer : public QObject {
 
   /**
    * @brief Send error response to client
-   * @param client Target websocket client
+   * @param client Target client connection
    * @param message Error message text
+   * @param id Correlation id of the failed request, echoed when present
+   */
+  void sendError(QObject* client, const QString& message,
+                 const QJsonValue& id = QJsonValue(QJsonValue::Undefined));
+
+  /**
+   * @brief Send a message object in the client's negotiated encoding
+   * @param client Target client connection
+   * @param message Message object (same schema for JSON and CBOR)
+   */
+  void sendMessage(QObject* client, const QJsonObject& message);
+
+  /**
+   * @brief Send an event envelope in the client's negotiated encoding
+   * @note Uses the event's cached encodings; nothing is re-serialised
    */
-  void sendError(QWebSocket* client, const QString& message) const;
+  void sendEvent(QObject* client, const Event& event);
+
+  /// Dispatch a decoded client message (shared by text and binary frames)
+  void processMessage(QObject* client, const QJsonObject& obj, qsizetype frameBytes);
+
+  /// Take message tokens; the first rejection of an episode is answered with "rate_limited"
+  auto admitFrame(QObject* client) -> bool;
+  /// Take count message tokens from the client's bucket; counts a rejection
+  auto admitMessages(QObject* client, qsizetype count) -> bool;
+  /// Take bytes from the client's publish bucket; counts a rejection
+  auto admitPublish(QObject* client, qsizetype bytes) -> bool;
+
+  /// Advertise the supported subprotocols on the current QWebSocketServer
+  void configureSubprotocols();
 
   // Message handlers
+  /// Apply a subscribe, unsubscribe or publish operation
+  /// @param bytes Wire size charged to the publish bucket for a publish
+  auto applyOperation(QObject* client, const QJsonObject& obj, qsizetype bytes, QString& error)
+      -> bool;
+  /// Apply a "batch" message's operations and send one batch_response
+  void handleBatch(QObject* client, const QJsonObject& obj, qsizetype frameBytes);
   /// Handle topic subscription request from client
-  void handleSubscribe(QWebSocket* client, const QString& topic);
+  /// @param delta Send snapshot + patch updates for this subscription
+  auto handleSubscribe(QObject* client, const QString& topic, bool delta, QString& error)
+      -> bool;
   /// Handle topic unsubscription request from client
-  void handleUnsubscribe(QWebSocket* client, const QString& topic);
+  auto handleUnsubscribe(QObject* client, const QString& topic, QString& error) -> bool;
   /// Handle event publication from internal service
   void handlePublish(const QString& topic, const QVariantMap& payload);
   /// Route service command to appropriate service handler
-  void handleServiceCommand(QWebSocket* client, const QString& command, const QVariantMap& params);
+  void handleServiceCommand(QObject* client, const QString& command, const QVariantMap& params,
+                            const QJsonValue& id);
+  /**
+   * @brief Run a service command off-thread; done() is called back on the server's thread
+   * @note Lifecycle commands are submitted to the ServiceJobQueue and answered at once
+   *       with a job id; their outcome is published on the EventBus
+   */
+  void runServiceCommand(const QString& command, const QVariantMap& params,
+                         std::function<void(const QJsonObject&)> done);
+  /// Run a query command (not a job) on the ServiceManager's thread and build its response
+  auto executeServiceCommand(const QString& command, const QVariantMap& params) -> QJsonObject;
+  /// Answer set_log_level / get_log_levels (Logger is thread-safe: runs on this thread)
+  auto executeLoggingCommand(const QString& command, const QVariantMap& params) -> QJsonObject;
 
   /**
-   * @brief Check if provided topic matches a subscription pattern
+   * @brief Client slots whose subscriptions match topic (cached per topic)
    * @param topic Actual event topic (e.g. "android_auto/connected")
-   * @param pattern Subscription pattern (supports wildcards)
-   * @return true if topic matches pattern
-   * @note Wildcards: "*" matches single segment, "**" matches multiple segments
+   * @return Bitset indexed by client slot; empty if no client matches
+   * @note Pattern syntax is that of TopicTrie
    */
-  [[nodiscard]] auto topicMatches(const QString& topic, const QString& pattern) const -> bool;
-
-  /// Connect AndroidAutoService signals for event forwarding
-  void setupAndroidAutoConnections();
+  [[nodiscard]] auto recipientsFor(const QString& topic) -> QBitArray;
+  /// Turn delta updates on or off for one of a client's subscriptions
+  void setDeltaSubscription(int slot, const QString& pattern, bool delta);
+  /// Recipients of topic whose matching subscription asked for delta updates
+  [[nodiscard]] auto deltaRecipientsFor(const QString& topic) -> QBitArray;
+  /// Resolve topic against index, memoised in cache
+  [[nodiscard]] auto resolveRecipients(const TopicTrie<int>& index,
+                                       QHash<QString, QBitArray>& cache, const QString& topic)
+      -> QBitArray;
 
   QWebSocketServer* m_server;
-  QList<QWebSocket*> m_clients;
-  QMap<QWebSocket*, QStringList> m_subscriptions;
+  QLocalServer* m_localServer{nullptr};
+  QList<QObject*> m_clients;
+  QMap<QObject*, QStringList> m_subscriptions;
+
+  /// Encoding negotiated through the WebSocket subprotocol header
+  enum class WireFormat { Json, Cbor };
+
+  /// Encoded frame waiting for socket buffer space
+  struct OutboundFrame {
+    QString topic;      ///< Event topic; empty for replies (never conflated)
+    QString text;       ///< JSON text frame (Json clients)
+    QByteArray binary;  ///< CBOR binary frame (Cbor clients)
+    qsizetype bytes{0};
+    bool delta{false};  ///< Snapshot or delta: part of a per-client chain
+  };
+
+  /// Last payload sent to one client on a delta topic
+  struct DeltaState {
+    QJsonObject payload;
+    quint64 seq{0};                ///< Sequence number of the last update sent
+    int deltasSinceSnapshot{0};
+  };
+
+  /// Per-connection state, indexed by the client's bit in recipient sets
+  struct ClientSlot {
+    QWebSocket* socket{nullptr};   ///< WebSocket transport
+    QLocalSocket* local{nullptr};  ///< Unix domain socket transport
+    WireFormat format{WireFormat::Json};
+    QQueue<OutboundFrame> outbound;
+    qsizetype queuedBytes{0};
+    quint64 dropped{0};
+    quint64 conflated{0};
+    TokenBucket messageBucket;
+    TokenBucket publishBucket;
+    quint64 rateLimited{0};
+    quint64 publishRateLimited{0};
+    bool throttled{false};  ///< Inside a rate-limiting episode (already told)
+    QStringList deltaPatterns;  ///< Subscriptions that asked for delta updates
+    QHash<QString, DeltaState> deltaState;  ///< Per concrete topic
+
+    /// Client connection (either transport); nullptr for a free slot
+    [[nodiscard]] auto connection() const -> QObject*;
+    [[nodiscard]] auto isOpen() const -> bool;
+    /// Bytes buffered inside the transport, not yet on the wire
+    [[nodiscard]] auto bytesToWrite() const -> qint64;
+    [[nodiscard]] auto peerName() const -> QString;
+  };
+
+  /// Batch whose pipelined service commands are still running
+  struct PendingBatch {
+    QPointer<QObject> client;
+    QJsonValue id{QJsonValue::Undefined};  ///< Batch correlation id
+    QJsonArray results;                    ///< One entry per operation
+    int outstanding{0};                    ///< Service commands not yet answered
+  };
+
+  /// Encode the next snapshot or delta of event for one client, advancing its chain
+  auto stateFrame(int slot, const Event& event, const QJsonObject& payload) -> OutboundFrame;
+
+  /// Send the batch_response for a completed batch
+  void finishBatch(const PendingBatch& batch);
+
+  /// Wire format of a connected client
+  [[nodiscard]] auto formatOf(QObject* client) const -> WireFormat;
+
+  /// Assign a slot (bit in the recipient sets) to a new connection
+  void registerClient(QObject* connection, const ClientSlot& client);
+  /// Send now if the socket has room, otherwise queue under the policy
+  void enqueue(int slot, OutboundFrame frame);
+  /// Move queued frames into the socket while it has buffer room
+  void flushOutbound(int slot);
+  /// Hand one frame to the client's transport
+  static void writeFrame(const ClientSlot& client, const OutboundFrame& frame);
+  /// Publish clientStats() on the EventBus
+  void publishStats();
+
+  /// Upper bound on cached topic → recipients resolutions
+  static constexpr qsizetype kMaxCachedTopics = 1024;
+  /// All client patterns compiled into one trie; values are client slots
+  TopicTrie<int> m_subscriptionIndex;
+  QList<ClientSlot> m_clientSlots;
+  QHash<QObject*, int> m_clientSlotOf;
+  QHash<QString, QBitArray> m_recipientCache;
+  /// Delta subscriptions only, a subset of m_subscriptionIndex
+  TopicTrie<int> m_deltaIndex;
+  qsizetype m_deltaSubscriptions{0};
+  QHash<QString, QBitArray> m_deltaRecipientCache;
+  int m_deltaResyncInterval{100};
+  /// Topics tracked per client before its delta baselines are reset
+  static constexpr qsizetype kMaxDeltaTopicsPerClient = 256;
+  /// Partial inbound frames of local clients
+  QHash<QObject*, QByteArray> m_localInbound;
+  OutboundLimits m_outboundLimits;
+  InboundLimits m_inboundLimits;
+  /// Monotonic time base for the inbound token buckets
+  QElapsedTimer m_clock;
+  quint64 m_slowConsumerDisconnects{0};
+  QTimer* m_statsTimer{nullptr};
+  MessageValidator m_messageValidator;
+
+  /// Tasks for the server's own thread (events, command responses)
+  ThreadMailbox m_mailbox{this};
+  /// Tasks for the ServiceManager's thread (service commands)
+  std::unique_ptr<ThreadMailbox> m_serviceMailbox;
+  /// Runs reload/start/stop/restart without blocking command handling
+  std::unique_ptr<ServiceJobQueue> m_jobQueue;
+  QMetaObject::Connection m_relayConnection;
+  QThread* m_ioThread{nullptr};
+  QThread* m_ownerThread{nullptr};
   ServiceManager* m_serviceManager;
   bool m_secureModeEnabled;
   QString m_certificatePath;
@@ -70,7 +70,7 @@ wait_for_aa_event() {
     local elapsed=0
     while ((elapsed < timeout)); do
         # Check if core has logged AA session state change (event published)
-        if grep -q "android-auto/status/connected\|SessionState.*ACTIVE" /tmp/crankshaft-core.log 2>/dev/null; then
+        if grep -q "android-auto/session/state-changed (ACTIVE)\|SessionState.*ACTIVE" /tmp/crankshaft-core.log 2>/dev/null; then
             event_received=1
             break
         fi
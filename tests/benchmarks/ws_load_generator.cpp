@@ -0,0 +1,553 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @brief WebSocket fan-out load generator for a running crankshaft-core
+ *
+ * Opens N subscriber clients with M topic subscriptions each, drives
+ * publishes from a separate publisher client at a fixed rate, and measures
+ * the end-to-end delay from publish to delivery on every subscriber. The
+ * path covered is the one vehicles depend on: client parse, EventBus
+ * dispatch, WebSocketServer::broadcastEvent fan-out and the outbound queues.
+ *
+ * Each publish carries the generator's monotonic send time, so latency is
+ * measured on one clock without any synchronisation with the core. The
+ * subscribers run on their own threads (--threads) so that receive-side
+ * processing in the generator does not inflate the numbers.
+ *
+ * The core rate limits inbound traffic per client (core.websocket.inbound,
+ * 200 messages/s with a burst of 400 and 256 KiB/s of publish payload by
+ * default), and the publisher is a single client. Above those limits the
+ * run would measure the rate limiter, so raise messages_per_sec,
+ * message_burst and the publish_byte* limits above --rate (and --rate x
+ * payload size) in the core's config first. When the core answers a publish
+ * with a "rate_limited" error the generator stops and exits with status 1.
+ *
+ * Exit codes: 0 success, 1 setup failure or rate limited by the core,
+ * 2 a --max-* threshold was exceeded.
+ */
+
+#include <QCborMap>
+#include <QCborValue>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QThread>
+#include <QTimer>
+#include <QWebSocket>
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+#include <QWebSocketHandshakeOptions>
+#endif
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr const char* kCborSubprotocol = "crankshaft.cbor.v1";
+
+struct Options {
+  QUrl url{QStringLiteral("ws://127.0.0.1:8080")};
+  int clients{20};
+  int subscriptions{4};
+  double rate{200.0};
+  int durationSec{10};
+  int payloadBytes{64};
+  int threads{2};
+  int drainMs{3000};
+  bool cbor{false};
+  bool json{false};
+  qint64 corePid{0};
+  double maxP99Ms{0.0};
+  double maxLossPercent{-1.0};
+};
+
+/**
+ * @brief utime + stime of a process in clock ticks, or -1 if unavailable
+ */
+auto processCpuTicks(qint64 pid) -> qint64 {
+  QFile stat(QString("/proc/%1/stat").arg(pid));
+  if (!stat.open(QIODevice::ReadOnly)) {
+    return -1;
+  }
+  // The command name may contain spaces; fields are counted after its ')'
+  const QByteArray line = stat.readAll();
+  const qsizetype nameEnd = line.lastIndexOf(')');
+  if (nameEnd < 0) {
+    return -1;
+  }
+  const QList<QByteArray> fields = line.mid(nameEnd + 2).split(' ');
+  if (fields.size() < 13) {
+    return -1;
+  }
+  return fields.at(11).toLongLong() + fields.at(12).toLongLong();
+}
+
+/**
+ * @brief PID of the first process named crankshaft-core, or 0
+ */
+auto findCorePid() -> qint64 {
+  const QStringList entries = QDir(QStringLiteral("/proc")).entryList(QDir::Dirs);
+  for (const QString& entry : entries) {
+    bool isPid = false;
+    const qint64 pid = entry.toLongLong(&isPid);
+    if (!isPid) {
+      continue;
+    }
+    QFile comm(QString("/proc/%1/comm").arg(pid));
+    if (comm.open(QIODevice::ReadOnly) && comm.readAll().trimmed() == "crankshaft-core") {
+      return pid;
+    }
+  }
+  return 0;
+}
+
+auto topicName(int index) -> QString {
+  return QStringLiteral("bench/load/%1").arg(index);
+}
+
+auto percentile(const std::vector<qint64>& sorted, double p) -> double {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+  return static_cast<double>(sorted.at(std::clamp<size_t>(rank, 1, sorted.size()) - 1)) / 1e6;
+}
+
+void openSocket(QWebSocket* socket, const Options& options) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+  if (options.cbor) {
+    QWebSocketHandshakeOptions handshake;
+    handshake.setSubprotocols({QLatin1String(kCborSubprotocol)});
+    socket->open(QNetworkRequest(options.url), handshake);
+    return;
+  }
+#endif
+  socket->open(options.url);
+}
+
+void onSocketError(QWebSocket* socket, QObject* context, const std::function<void()>& handler) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+  QObject::connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::errorOccurred),
+                   context, [handler](QAbstractSocket::SocketError) { handler(); });
+#else
+  QObject::connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error),
+                   context, [handler](QAbstractSocket::SocketError) { handler(); });
+#endif
+}
+
+/**
+ * @brief Whether a reply is the core's "rate_limited" error (JSON text or CBOR)
+ */
+auto isRateLimitedReply(const QJsonObject& reply) -> bool {
+  return reply.value("type").toString() == QLatin1String("error") &&
+         reply.value("message").toString() == QLatin1String("rate_limited");
+}
+
+void sendMessage(QWebSocket* socket, const QJsonObject& message, bool cbor) {
+  if (cbor) {
+    socket->sendBinaryMessage(QCborValue::fromJsonValue(message).toCbor());
+  } else {
+    const QByteArray json = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    socket->sendTextMessage(QString::fromUtf8(json));
+  }
+}
+
+/**
+ * @brief Subscriber clients owned by one generator thread
+ *
+ * Latency samples are only touched in the worker's thread and are read by
+ * main() after that thread has finished.
+ */
+class SubscriberWorker : public QObject {
+ public:
+  SubscriberWorker(const Options& options, const QElapsedTimer& clock)
+      : m_options(options), m_clock(clock) {}
+
+  void open(int count) {
+    for (int i = 0; i < count; ++i) {
+      auto* socket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+      connect(socket, &QWebSocket::connected, this, [this, socket]() { subscribe(socket); });
+      onSocketError(socket, this, [this]() { failed.fetch_add(1, std::memory_order_relaxed); });
+      connect(socket, &QWebSocket::textMessageReceived, this,
+              [this](const QString& message) { onText(message); });
+      connect(socket, &QWebSocket::binaryMessageReceived, this,
+              [this](const QByteArray& message) { onBinary(message); });
+      m_sockets.push_back(socket);
+      openSocket(socket, m_options);
+    }
+  }
+
+  void close() {
+    for (QWebSocket* socket : m_sockets) {
+      socket->abort();
+      delete socket;
+    }
+    m_sockets.clear();
+  }
+
+  std::atomic<int> subscribed{0};
+  std::atomic<int> failed{0};
+  std::atomic<quint64> received{0};
+  std::vector<qint64> latenciesNs;
+
+ private:
+  void subscribe(QWebSocket* socket) {
+    for (int topic = 0; topic < m_options.subscriptions; ++topic) {
+      QJsonObject message;
+      message["type"] = QStringLiteral("subscribe");
+      message["topic"] = topicName(topic);
+      sendMessage(socket, message, m_options.cbor);
+    }
+    subscribed.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void onText(const QString& message) {
+    const QJsonObject event = QJsonDocument::fromJson(message.toUtf8()).object();
+    if (event.value("type").toString() == QLatin1String("event")) {
+      record(event.value("payload").toObject().value("sent_ns").toInteger(-1));
+    }
+  }
+
+  void onBinary(const QByteArray& message) {
+    const QCborMap event = QCborValue::fromCbor(message).toMap();
+    if (event.value(QStringLiteral("type")).toString() == QLatin1String("event")) {
+      record(event.value(QStringLiteral("payload"))
+                 .toMap()
+                 .value(QStringLiteral("sent_ns"))
+                 .toInteger(-1));
+    }
+  }
+
+  void record(qint64 sentNs) {
+    if (sentNs < 0) {
+      return;  // Not one of ours
+    }
+    latenciesNs.push_back(m_clock.nsecsElapsed() - sentNs);
+    received.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  const Options& m_options;
+  const QElapsedTimer& m_clock;
+  std::vector<QWebSocket*> m_sockets;
+};
+
+/**
+ * @brief Spin the event loop until done() or the timeout; returns done()
+ */
+auto waitUntil(const std::function<bool()>& done, int timeoutMs) -> bool {
+  QElapsedTimer elapsed;
+  elapsed.start();
+  QEventLoop loop;
+  QTimer poll;
+  poll.setInterval(10);
+  QObject::connect(&poll, &QTimer::timeout, &loop, [&]() {
+    if (done() || elapsed.elapsed() >= timeoutMs) {
+      loop.quit();
+    }
+  });
+  poll.start();
+  if (!done()) {
+    loop.exec();
+  }
+  return done();
+}
+
+auto parseOptions(const QCoreApplication& app, Options& options) -> bool {
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Crankshaft WebSocket fan-out load generator: measures publish-to-delivery latency, "
+      "throughput and core CPU against a running crankshaft-core");
+  parser.addHelpOption();
+  const QCommandLineOption url({"u", "url"}, "Core WebSocket URL", "url", options.url.toString());
+  const QCommandLineOption clients({"n", "clients"}, "Subscriber clients", "count", "20");
+  const QCommandLineOption subs({"m", "subscriptions"}, "Topics subscribed per client", "count",
+                                "4");
+  const QCommandLineOption rate({"r", "rate"}, "Publishes per second", "rate", "200");
+  const QCommandLineOption duration({"d", "duration"}, "Publishing time in seconds", "seconds",
+                                    "10");
+  const QCommandLineOption payload("payload-bytes", "Padding added to each payload", "bytes",
+                                   "64");
+  const QCommandLineOption threads("threads", "Subscriber threads", "count", "2");
+  const QCommandLineOption drain("drain-ms", "Time to wait for late deliveries", "ms", "3000");
+  const QCommandLineOption cbor("cbor", "Negotiate the binary CBOR subprotocol");
+  const QCommandLineOption json("json", "Print the report as JSON");
+  const QCommandLineOption pid("core-pid", "Core PID for CPU usage (default: find crankshaft-core)",
+                               "pid");
+  const QCommandLineOption maxP99("max-p99-ms", "Fail (exit 2) if p99 latency exceeds this", "ms");
+  const QCommandLineOption maxLoss("max-loss-percent", "Fail (exit 2) if more deliveries are lost",
+                                   "percent");
+  parser.addOptions({url, clients, subs, rate, duration, payload, threads, drain, cbor, json, pid,
+                     maxP99, maxLoss});
+  parser.process(app);
+
+  options.url = QUrl(parser.value(url));
+  options.clients = parser.value(clients).toInt();
+  options.subscriptions = parser.value(subs).toInt();
+  options.rate = parser.value(rate).toDouble();
+  options.durationSec = parser.value(duration).toInt();
+  options.payloadBytes = std::max(0, parser.value(payload).toInt());
+  options.threads = std::clamp(parser.value(threads).toInt(), 1, std::max(1, options.clients));
+  options.drainMs = std::max(0, parser.value(drain).toInt());
+  options.cbor = parser.isSet(cbor);
+  options.json = parser.isSet(json);
+  options.corePid = parser.isSet(pid) ? parser.value(pid).toLongLong() : findCorePid();
+  options.maxP99Ms = parser.value(maxP99).toDouble();
+  options.maxLossPercent = parser.isSet(maxLoss) ? parser.value(maxLoss).toDouble() : -1.0;
+
+  if (!options.url.isValid() || options.clients < 1 || options.subscriptions < 1 ||
+      options.rate <= 0.0 || options.durationSec < 1) {
+    qCritical("Invalid options: need a valid --url, --clients >= 1, --subscriptions >= 1, "
+              "--rate > 0 and --duration >= 1");
+    return false;
+  }
+#if QT_VERSION < QT_VERSION_CHECK(6, 4, 0)
+  if (options.cbor) {
+    qWarning("--cbor needs Qt 6.4 or later; using JSON");
+    options.cbor = false;
+  }
+#endif
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("ws_load_generator");
+
+  Options options;
+  if (!parseOptions(app, options)) {
+    return 1;
+  }
+
+  QElapsedTimer clock;
+  clock.start();
+
+  // Spread subscribers over their own threads
+  std::vector<std::unique_ptr<QThread>> threads;
+  std::vector<std::unique_ptr<SubscriberWorker>> workers;
+  for (int t = 0; t < options.threads; ++t) {
+    const int count = options.clients / options.threads + (t < options.clients % options.threads);
+    auto worker = std::make_unique<SubscriberWorker>(options, clock);
+    auto thread = std::make_unique<QThread>();
+    worker->moveToThread(thread.get());
+    thread->start();
+    SubscriberWorker* target = worker.get();
+    QMetaObject::invokeMethod(target, [target, count]() { target->open(count); });
+    workers.push_back(std::move(worker));
+    threads.push_back(std::move(thread));
+  }
+
+  const auto sum = [&workers](auto member) {
+    quint64 total = 0;
+    for (const auto& worker : workers) {
+      total += (worker.get()->*member).load(std::memory_order_relaxed);
+    }
+    return total;
+  };
+  const auto shutdown = [&]() {
+    for (const auto& worker : workers) {
+      SubscriberWorker* target = worker.get();
+      QMetaObject::invokeMethod(target, [target]() { target->close(); },
+                                Qt::BlockingQueuedConnection);
+    }
+    for (const auto& thread : threads) {
+      thread->quit();
+      thread->wait();
+    }
+  };
+
+  QWebSocket publisher;
+  bool publisherFailed = false;
+  bool rateLimited = false;
+  onSocketError(&publisher, &publisher, [&publisherFailed]() { publisherFailed = true; });
+  QObject::connect(&publisher, &QWebSocket::textMessageReceived, &publisher,
+                   [&rateLimited](const QString& message) {
+                     const QJsonObject reply = QJsonDocument::fromJson(message.toUtf8()).object();
+                     rateLimited = rateLimited || isRateLimitedReply(reply);
+                   });
+  QObject::connect(&publisher, &QWebSocket::binaryMessageReceived, &publisher,
+                   [&rateLimited](const QByteArray& message) {
+                     const QJsonObject reply = QCborValue::fromCbor(message).toMap().toJsonObject();
+                     rateLimited = rateLimited || isRateLimitedReply(reply);
+                   });
+  openSocket(&publisher, options);
+
+  const bool ready = waitUntil(
+      [&]() {
+        return publisherFailed || sum(&SubscriberWorker::failed) > 0 ||
+               (publisher.state() == QAbstractSocket::ConnectedState &&
+                sum(&SubscriberWorker::subscribed) == static_cast<quint64>(options.clients));
+      },
+      10000);
+  if (!ready || publisherFailed || sum(&SubscriberWorker::failed) > 0) {
+    qCritical("Could not connect %d clients to %s (%s)", options.clients + 1,
+              qPrintable(options.url.toString()), qPrintable(publisher.errorString()));
+    shutdown();
+    return 1;
+  }
+  // Subscriptions travel on other connections than the publisher's; let them land first
+  waitUntil([]() { return false; }, 500);
+
+  const auto total = static_cast<quint64>(std::llround(options.rate * options.durationSec));
+  const quint64 expected = total * static_cast<quint64>(options.clients);
+  const QString padding(options.payloadBytes, QLatin1Char('x'));
+  const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+  const qint64 cpuStart = options.corePid > 0 ? processCpuTicks(options.corePid) : -1;
+
+  // Pace publishes against the clock rather than the timer, so a late tick catches up
+  quint64 sent = 0;
+  const qint64 publishStartNs = clock.nsecsElapsed();
+  QTimer pacer;
+  pacer.setTimerType(Qt::PreciseTimer);
+  pacer.setInterval(1);
+  QObject::connect(&pacer, &QTimer::timeout, &publisher, [&]() {
+    const double elapsedSec = static_cast<double>(clock.nsecsElapsed() - publishStartNs) / 1e9;
+    const auto due = std::min(total, static_cast<quint64>(elapsedSec * options.rate) + 1);
+    while (sent < due) {
+      QJsonObject payload;
+      payload["seq"] = static_cast<qint64>(sent);
+      payload["sent_ns"] = clock.nsecsElapsed();
+      if (!padding.isEmpty()) {
+        payload["pad"] = padding;
+      }
+      QJsonObject message;
+      message["type"] = QStringLiteral("publish");
+      message["topic"] = topicName(static_cast<int>(sent % options.subscriptions));
+      message["payload"] = payload;
+      sendMessage(&publisher, message, options.cbor);
+      ++sent;
+    }
+    if (sent >= total || rateLimited) {
+      pacer.stop();
+    }
+  });
+  pacer.start();
+
+  waitUntil([&]() { return sent >= total || publisherFailed || rateLimited; },
+            (options.durationSec + 5) * 1000);
+  if (rateLimited) {
+    fprintf(stderr,
+            "FAIL: the core rate limited the publisher after %llu publishes. Raise "
+            "core.websocket.inbound.messages_per_sec and message_burst above --rate %.0f "
+            "(and publish_bytes_per_sec / publish_byte_burst for large payloads), then rerun.\n",
+            static_cast<unsigned long long>(sent), options.rate);
+    publisher.close();
+    shutdown();
+    return 1;
+  }
+  const qint64 publishEndNs = clock.nsecsElapsed();
+  waitUntil([&]() { return sum(&SubscriberWorker::received) >= expected; }, options.drainMs);
+  const qint64 endNs = clock.nsecsElapsed();
+  const qint64 cpuEnd = options.corePid > 0 ? processCpuTicks(options.corePid) : -1;
+
+  publisher.close();
+  shutdown();
+
+  std::vector<qint64> latencies;
+  latencies.reserve(expected);
+  for (const auto& worker : workers) {
+    latencies.insert(latencies.end(), worker->latenciesNs.begin(), worker->latenciesNs.end());
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  const quint64 delivered = latencies.size();
+  const double publishSec = static_cast<double>(publishEndNs - publishStartNs) / 1e9;
+  const double wallSec = static_cast<double>(endNs - publishStartNs) / 1e9;
+  const double lossPercent =
+      expected > 0 && delivered < expected
+          ? 100.0 * static_cast<double>(expected - delivered) / static_cast<double>(expected)
+          : 0.0;
+  const double cpuPercent =
+      cpuStart >= 0 && cpuEnd >= cpuStart && ticksPerSecond > 0
+          ? 100.0 * static_cast<double>(cpuEnd - cpuStart) / ticksPerSecond / wallSec
+          : -1.0;
+
+  QJsonObject report;
+  report["clients"] = options.clients;
+  report["subscriptions_per_client"] = options.subscriptions;
+  report["rate"] = options.rate;
+  report["duration_s"] = options.durationSec;
+  report["payload_bytes"] = options.payloadBytes;
+  report["format"] = options.cbor ? QStringLiteral("cbor") : QStringLiteral("json");
+  report["published"] = static_cast<qint64>(sent);
+  report["publish_rate"] = publishSec > 0 ? static_cast<double>(sent) / publishSec : 0.0;
+  report["expected"] = static_cast<qint64>(expected);
+  report["delivered"] = static_cast<qint64>(delivered);
+  report["loss_percent"] = lossPercent;
+  report["throughput"] = wallSec > 0 ? static_cast<double>(delivered) / wallSec : 0.0;
+  report["p50_ms"] = percentile(latencies, 0.50);
+  report["p99_ms"] = percentile(latencies, 0.99);
+  report["p999_ms"] = percentile(latencies, 0.999);
+  report["max_ms"] = latencies.empty() ? 0.0 : static_cast<double>(latencies.back()) / 1e6;
+  report["core_pid"] = options.corePid;
+  report["core_cpu_percent"] = cpuPercent;
+
+  if (options.json) {
+    printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+  } else {
+    printf("Crankshaft WebSocket fan-out benchmark (%s)\n", qPrintable(options.url.toString()));
+    printf("  clients %d x %d subscriptions, %.0f publishes/s for %ds, %d byte padding, %s\n",
+           options.clients, options.subscriptions, options.rate, options.durationSec,
+           options.payloadBytes, options.cbor ? "CBOR" : "JSON");
+    printf("  published   %llu (%.1f/s)\n", static_cast<unsigned long long>(sent),
+           report["publish_rate"].toDouble());
+    printf("  delivered   %llu of %llu (%.2f%% lost)\n", static_cast<unsigned long long>(delivered),
+           static_cast<unsigned long long>(expected), lossPercent);
+    printf("  throughput  %.1f deliveries/s\n", report["throughput"].toDouble());
+    printf("  latency     p50 %.3f ms  p99 %.3f ms  p999 %.3f ms  max %.3f ms\n",
+           report["p50_ms"].toDouble(), report["p99_ms"].toDouble(),
+           report["p999_ms"].toDouble(), report["max_ms"].toDouble());
+    if (cpuPercent >= 0) {
+      printf("  core CPU    %.1f%% (pid %lld)\n", cpuPercent,
+             static_cast<long long>(options.corePid));
+    } else {
+      printf("  core CPU    unavailable (pass --core-pid)\n");
+    }
+  }
+
+  bool failed = false;
+  if (options.maxP99Ms > 0 && report["p99_ms"].toDouble() > options.maxP99Ms) {
+    fprintf(stderr, "FAIL: p99 %.3f ms exceeds %.3f ms\n", report["p99_ms"].toDouble(),
+            options.maxP99Ms);
+    failed = true;
+  }
+  if (options.maxLossPercent >= 0 && lossPercent > options.maxLossPercent) {
+    fprintf(stderr, "FAIL: %.2f%% of deliveries lost (limit %.2f%%)\n", lossPercent,
+            options.maxLossPercent);
+    failed = true;
+  }
+  return failed ? 2 : 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QByteArray>
+#include <QList>
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "hal/multimedia/AudioMixer.h"
+#include "hal/multimedia/SpscByteRing.h"
+
+namespace {
+/// frames of 16-bit PCM (interleaved channels) with every sample set to value
+auto constantPcm(int frames, int16_t value, int channels = 2) -> QByteArray {
+  QByteArray pcm(frames * channels * 2, Qt::Uninitialized);
+  auto* samples = reinterpret_cast<int16_t*>(pcm.data());
+  for (int i = 0; i < frames * channels; ++i) {
+    samples[i] = value;
+  }
+  return pcm;
+}
+
+auto masterFormat() -> IAudioMixer::AudioFormat {
+  IAudioMixer::AudioFormat format;
+  format.sampleRate = 48000;
+  format.channels = 2;
+  format.bitsPerSample = 16;
+  return format;
+}
+}  // namespace
+
+TEST_CASE("SpscByteRing wraps without losing order and rejects overruns", "[audio]") {
+  SpscByteRing ring(100);
+  REQUIRE(ring.capacity() == 128);
+
+  std::vector<char> out;
+  auto drain = [&](std::size_t size) {
+    ring.read(size, [&](const char* data, std::size_t length) {
+      out.insert(out.end(), data, data + length);
+    });
+  };
+
+  char chunk[48];
+  for (int round = 0; round < 10; ++round) {
+    for (std::size_t i = 0; i < sizeof(chunk); ++i) {
+      chunk[i] = static_cast<char>(round * 48 + static_cast<int>(i));
+    }
+    REQUIRE(ring.write(chunk, sizeof(chunk)));
+    REQUIRE(ring.readable() == sizeof(chunk));
+    out.clear();
+    drain(sizeof(chunk));
+    REQUIRE(std::memcmp(out.data(), chunk, sizeof(chunk)) == 0);
+  }
+
+  REQUIRE(ring.write(chunk, 100));
+  REQUIRE_FALSE(ring.write(chunk, 29));  // All or nothing
+  REQUIRE(ring.readable() == 100);
+  ring.clear();
+  REQUIRE(ring.readable() == 0);
+}
+
+TEST_CASE("AudioMixer sizes channel rings from the configured latency", "[audio]") {
+  AudioMixer mixer;
+  REQUIRE(mixer.initialize(masterFormat()));
+
+  IAudioMixer::ChannelConfig media;
+  media.id = IAudioMixer::ChannelId::MEDIA;
+  media.format = masterFormat();
+  media.latencyMs = 100;  // 19200 bytes at 48kHz stereo 16-bit
+  REQUIRE(mixer.addChannel(media));
+  REQUIRE(mixer.channelBufferSize(IAudioMixer::ChannelId::MEDIA) == 32768);
+  REQUIRE_FALSE(mixer.addChannel(media));
+
+  REQUIRE(mixer.removeChannel(IAudioMixer::ChannelId::MEDIA));
+  REQUIRE(mixer.channelBufferSize(IAudioMixer::ChannelId::MEDIA) == 0);
+  REQUIRE_FALSE(mixer.mixAudioData(IAudioMixer::ChannelId::MEDIA, constantPcm(16, 1)));
+}
+
+TEST_CASE("AudioMixer converts and mixes channels from their rings", "[audio]") {
+  AudioMixer mixer;
+  REQUIRE(mixer.initialize(masterFormat()));
+  mixer.setMasterVolume(1.0f);
+
+  IAudioMixer::ChannelConfig media;
+  media.id = IAudioMixer::ChannelId::MEDIA;
+  media.format = masterFormat();
+  media.priority = 1;
+  REQUIRE(mixer.addChannel(media));
+
+  IAudioMixer::ChannelConfig speech;
+  speech.id = IAudioMixer::ChannelId::SPEECH;
+  speech.format = {16000, 1, 16};
+  speech.priority = 3;
+  REQUIRE(mixer.addChannel(speech));
+
+  QList<QByteArray> mixed;
+  QObject::connect(&mixer, &IAudioMixer::audioMixed,
+                   [&](const QByteArray& data) { mixed.append(data); });
+
+  // Media alone is mixed as soon as it arrives
+  REQUIRE(mixer.mixAudioData(IAudioMixer::ChannelId::MEDIA, constantPcm(480, 1000)));
+  REQUIRE(mixed.size() == 1);
+  REQUIRE(mixed.last().size() == 480 * 4);
+  REQUIRE(reinterpret_cast<const int16_t*>(mixed.last().constData())[0] == 1000);
+
+  // 16kHz mono speech is converted to master format and scaled by its volume
+  mixer.setChannelVolume(IAudioMixer::ChannelId::SPEECH, 0.5f);
+  REQUIRE(mixer.mixAudioData(IAudioMixer::ChannelId::SPEECH, constantPcm(160, 500, 1)));
+  REQUIRE(mixed.size() == 2);
+  const auto* samples = reinterpret_cast<const int16_t*>(mixed.last().constData());
+  REQUIRE(mixed.last().size() == 480 * 4);
+  REQUIRE(samples[0] == 250);
+  REQUIRE(samples[1] == 250);
+
+  // Muted channels are consumed but not heard
+  mixer.setChannelMuted(IAudioMixer::ChannelId::MEDIA, true);
+  REQUIRE(mixer.mixAudioData(IAudioMixer::ChannelId::MEDIA, constantPcm(480, 1000)));
+  REQUIRE(reinterpret_cast<const int16_t*>(mixed.last().constData())[0] == 0);
+}
+
+TEST_CASE("AudioMixer drops and counts chunks that overrun a channel", "[audio]") {
+  AudioMixer mixer;
+  REQUIRE(mixer.initialize(masterFormat()));
+
+  IAudioMixer::ChannelConfig media;
+  media.id = IAudioMixer::ChannelId::MEDIA;
+  media.format = masterFormat();
+  media.latencyMs = 10;  // Rounded up to the 4096-byte minimum
+  REQUIRE(mixer.addChannel(media));
+  REQUIRE(mixer.channelBufferSize(IAudioMixer::ChannelId::MEDIA) == 4096);
+
+  REQUIRE(mixer.mixAudioData(IAudioMixer::ChannelId::MEDIA, constantPcm(2048, 1)));
+  REQUIRE(mixer.channelOverruns(IAudioMixer::ChannelId::MEDIA) == 1);
+  REQUIRE(mixer.mixAudioData(IAudioMixer::ChannelId::MEDIA, constantPcm(1024, 1)));
+  REQUIRE(mixer.channelOverruns(IAudioMixer::ChannelId::MEDIA) == 1);
+}
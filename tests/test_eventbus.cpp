@@ -17,10 +17,18 @@
  *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QCborMap>
+#include <QCborValue>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
 #include <QSignalSpy>
+#include <QTest>
 #include <QThread>
 #include <QVariantMap>
+#include <atomic>
 #include <catch2/catch_all.hpp>
 
 #include "services/eventbus/EventBus.h"
@@ -104,3 +112,496 @@ TEST_CASE("EventBus thread safety", "[eventbus]") {
 
   REQUIRE(spy.count() == numThreads * messagesPerThread);
 }
+
+TEST_CASE("EventBus asynchronous dispatch preserves order", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  bus.setDispatchMode(EventBus::DispatchMode::Asynchronous);
+  REQUIRE(bus.dispatchMode() == EventBus::DispatchMode::Asynchronous);
+
+  // Receiver lives in the main thread, so delivery is queued onto it
+  QObject receiver;
+  QList<int> received;
+  QObject::connect(&bus, &EventBus::messagePublished, &receiver,
+                   [&received](const QString&, const QVariantMap& payload) {
+                     received.append(payload.value("seq").toInt());
+                   });
+
+  const int count = 500;
+  for (int i = 0; i < count; ++i) {
+    bus.publish("async/ordered", {{"seq", i}});
+  }
+
+  REQUIRE(QTest::qWaitFor([&received]() { return received.size() == count; }, 5000));
+  for (int i = 0; i < count; ++i) {
+    REQUIRE(received.at(i) == i);
+  }
+
+  bus.setDispatchMode(EventBus::DispatchMode::Synchronous);
+  REQUIRE(bus.pendingEvents() == 0);
+}
+
+TEST_CASE("EventBus asynchronous publish does not block on slow subscriber", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  bus.setDispatchMode(EventBus::DispatchMode::Asynchronous);
+
+  QObject receiver;
+  int delivered = 0;
+  QObject::connect(&bus, &EventBus::messagePublished, &receiver,
+                   [&delivered](const QString&, const QVariantMap&) {
+                     QThread::msleep(20);
+                     ++delivered;
+                   });
+
+  QElapsedTimer timer;
+  timer.start();
+  for (int i = 0; i < 10; ++i) {
+    bus.publish("async/slow", {{"seq", i}});
+  }
+  // Publishing must not wait for the 20ms-per-event subscriber
+  REQUIRE(timer.elapsed() < 100);
+
+  REQUIRE(QTest::qWaitFor([&delivered]() { return delivered == 10; }, 5000));
+
+  bus.setDispatchMode(EventBus::DispatchMode::Synchronous);
+}
+
+TEST_CASE("EventBus subscribe delivers only matching topics", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  QObject receiver;
+  QStringList exact;
+  QStringList singleLevel;
+  QStringList multiLevel;
+
+  bus.subscribe("android-auto/status/connected", &receiver,
+                [&exact](const QString& topic, const QVariantMap&) { exact.append(topic); });
+  bus.subscribe("android-auto/+/state-changed", &receiver,
+                [&singleLevel](const QString& topic, const QVariantMap&) {
+                  singleLevel.append(topic);
+                });
+  bus.subscribe("media/#", &receiver, [&multiLevel](const QString& topic, const QVariantMap&) {
+    multiLevel.append(topic);
+  });
+
+  bus.publish("android-auto/status/connected", {});
+  bus.publish("android-auto/status/state-changed", {});
+  bus.publish("android-auto/status/extra/state-changed", {});
+  bus.publish("media/status/position", {});
+  bus.publish("media", {});
+  bus.publish("audio/route_changed", {});
+
+  REQUIRE(exact == QStringList{"android-auto/status/connected"});
+  REQUIRE(singleLevel == QStringList{"android-auto/status/state-changed"});
+  REQUIRE(multiLevel == QStringList{"media/status/position", "media"});
+}
+
+TEST_CASE("EventBus trailing multi-level wildcards match the parent level", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  QObject receiver;
+  QStringList hash;
+  QStringList doubleStar;
+  QStringList star;
+
+  bus.subscribe("a/#", &receiver,
+                [&hash](const QString& topic, const QVariantMap&) { hash.append(topic); });
+  bus.subscribe("a/**", &receiver, [&doubleStar](const QString& topic, const QVariantMap&) {
+    doubleStar.append(topic);
+  });
+  bus.subscribe("a/*", &receiver,
+                [&star](const QString& topic, const QVariantMap&) { star.append(topic); });
+
+  bus.publish("a", {});
+  bus.publish("a/b", {});
+  bus.publish("a/b/c", {});
+  bus.publish("ab", {});
+
+  // MQTT: "a/#" covers "a" itself; the legacy trailing "*" needs a sub-level
+  REQUIRE(hash == QStringList{"a", "a/b", "a/b/c"});
+  REQUIRE(doubleStar == QStringList{"a", "a/b", "a/b/c"});
+  REQUIRE(star == QStringList{"a/b", "a/b/c"});
+}
+
+TEST_CASE("EventBus inner multi-level wildcards match any depth once", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  QObject receiver;
+  QStringList anyDepth;
+  QStringList nested;
+
+  bus.subscribe("vehicle/**/speed", &receiver,
+                [&anyDepth](const QString& topic, const QVariantMap&) { anyDepth.append(topic); });
+  bus.subscribe("vehicle/#/can/#/frame", &receiver,
+                [&nested](const QString& topic, const QVariantMap&) { nested.append(topic); });
+
+  bus.publish("vehicle/speed", {});
+  bus.publish("vehicle/obd/0/speed", {});
+  bus.publish("vehicle/speed/raw", {});
+  // Several ways to match; each subscriber must still be called once
+  bus.publish("vehicle/can/can/0/frame", {});
+
+  REQUIRE(anyDepth == QStringList{"vehicle/speed", "vehicle/obd/0/speed"});
+  REQUIRE(nested == QStringList{"vehicle/can/can/0/frame"});
+}
+
+TEST_CASE("EventBus unsubscribe and receiver lifetime", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  const qsizetype baseline = bus.subscriptionCount();
+
+  QObject receiver;
+  int calls = 0;
+  const EventBus::SubscriptionId id =
+      bus.subscribe("lifetime/*", &receiver, [&calls](const QString&, const QVariantMap&) {
+        ++calls;
+      });
+  REQUIRE(id != 0);
+
+  bus.publish("lifetime/one", {});
+  bus.unsubscribe(id);
+  bus.publish("lifetime/two", {});
+  REQUIRE(calls == 1);
+
+  {
+    QObject shortLived;
+    bus.subscribe("lifetime/*", &shortLived, [](const QString&, const QVariantMap&) {});
+    REQUIRE(bus.subscriptionCount() == baseline + 1);
+  }
+  REQUIRE(bus.subscriptionCount() == baseline);
+
+  REQUIRE(bus.subscribe("", &receiver, [](const QString&, const QVariantMap&) {}) == 0);
+}
+
+TEST_CASE("EventBus shares one immutable Event across subscribers", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  QObject receiver;
+  QList<Event> received;
+
+  bus.subscribe("shared/event", &receiver,
+                [&received](const Event& event) { received.append(event); });
+  bus.subscribe("shared/#", &receiver, [&received](const Event& event) { received.append(event); });
+
+  bus.publish("shared/event", {{"value", 7}});
+
+  REQUIRE(received.size() == 2);
+  REQUIRE(received.at(0).topic() == "shared/event");
+  REQUIRE(received.at(0).payload().value("value").toInt() == 7);
+
+  // Encoded once: both subscribers see the same cached buffer
+  const QByteArray first = received.at(0).toJson();
+  const QByteArray second = received.at(1).toJson();
+  REQUIRE(first.constData() == second.constData());
+  REQUIRE(received.at(0).toJsonText().constData() == received.at(1).toJsonText().constData());
+  REQUIRE(received.at(0).toJsonText() == QString::fromUtf8(first));
+
+  const QJsonObject envelope = QJsonDocument::fromJson(first).object();
+  REQUIRE(envelope.value("type").toString() == "event");
+  REQUIRE(envelope.value("topic").toString() == "shared/event");
+  REQUIRE(envelope.value("payload").toObject().value("value").toInt() == 7);
+
+  const QCborMap cbor = QCborValue::fromCbor(received.at(0).toCbor()).toMap();
+  REQUIRE(cbor.value(QStringLiteral("topic")).toString() == "shared/event");
+}
+
+TEST_CASE("EventBus conflates pending state updates", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  bus.addConflationPattern("conflate/stats");
+
+  QObject receiver;
+  QList<int> stats;
+  QList<int> others;
+  bus.subscribe("conflate/stats", &receiver, [&stats](const QString&, const QVariantMap& payload) {
+    stats.append(payload.value("value").toInt());
+  });
+  bus.subscribe("conflate/log", &receiver, [&others](const QString&, const QVariantMap& payload) {
+    others.append(payload.value("value").toInt());
+  });
+
+  const quint64 before = bus.conflatedEventCount();
+
+  // Publish from another thread while the receiver's thread is not running
+  QThread* publisher = QThread::create([&bus]() {
+    for (int i = 0; i < 100; ++i) {
+      bus.publish("conflate/stats", {{"value", i}});
+      bus.publish("conflate/log", {{"value", i}});
+    }
+  });
+  publisher->start();
+  publisher->wait();
+  delete publisher;
+
+  QCoreApplication::processEvents();
+
+  REQUIRE(stats == QList<int>{99});
+  REQUIRE(others.size() == 100);
+  REQUIRE(bus.conflatedEventCount() - before == 99);
+  REQUIRE(bus.conflatedEventCounts().value("conflate/stats") >= 99);
+
+  bus.removeConflationPattern("conflate/stats");
+}
+
+TEST_CASE("EventBus retains the last value per topic", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  bus.addRetainPattern("retained/#");
+  bus.publish("retained/audio/volume", {{"value", 10}});
+  bus.publish("retained/audio/volume", {{"value", 20}});
+  bus.publish("retained/media/track", {{"value", 1}});
+
+  REQUIRE(bus.retainedEvent("retained/audio/volume").payload().value("value").toInt() == 20);
+  REQUIRE(bus.retainedEvent("retained/unknown").isNull());
+  REQUIRE(bus.retainedEvents("retained/#").size() == 2);
+
+  QObject receiver;
+  QStringList replayed;
+  bus.subscribe(
+      "retained/audio/+", &receiver,
+      [&replayed](const QString& topic, const QVariantMap& payload) {
+        replayed.append(QString("%1=%2").arg(topic).arg(payload.value("value").toInt()));
+      },
+      EventBus::Replay::Retained);
+
+  // Delivered immediately on the subscribing thread, then live events follow
+  REQUIRE(replayed == QStringList{"retained/audio/volume=20"});
+  bus.publish("retained/audio/volume", {{"value", 30}});
+  REQUIRE(replayed.size() == 2);
+
+  bus.clearRetained("retained/#");
+  REQUIRE(bus.retainedEvents("retained/#").isEmpty());
+  bus.removeRetainPattern("retained/#");
+}
+
+TEST_CASE("EventBus does not replay topics that are not retained", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  bus.addRetainPattern("oneoff/state");
+  bus.publish("oneoff/state", {{"value", 1}});
+  bus.publish("oneoff/error", {{"message", "stale"}});
+
+  REQUIRE(bus.retainedEvent("oneoff/error").isNull());
+
+  QObject receiver;
+  QStringList replayed;
+  bus.subscribe(
+      "oneoff/#", &receiver,
+      [&replayed](const QString& topic, const QVariantMap&) { replayed.append(topic); },
+      EventBus::Replay::Retained);
+  REQUIRE(replayed == QStringList{"oneoff/state"});
+
+  bus.clearRetained("oneoff/#");
+  bus.removeRetainPattern("oneoff/state");
+}
+
+TEST_CASE("EventBus replays to another thread ahead of newer live values", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  bus.addRetainPattern("replay/focus");
+  bus.addCriticalPattern("replay/focus");
+  bus.publish("replay/focus", {{"value", 1}});
+
+  QThread worker;
+  auto* receiver = new QObject();
+  receiver->moveToThread(&worker);
+  QObject::connect(&worker, &QThread::finished, receiver, &QObject::deleteLater);
+
+  // The worker is not running yet, so the replay and the live value are both
+  // queued in its inbox before either is handled
+  QMutex valuesMutex;
+  QList<int> values;
+  const EventBus::SubscriptionId id = bus.subscribe(
+      "replay/focus", receiver,
+      [&valuesMutex, &values](const QString&, const QVariantMap& payload) {
+        QMutexLocker locker(&valuesMutex);
+        values.append(payload.value("value").toInt());
+      },
+      EventBus::Replay::Retained);
+  bus.publish("replay/focus", {{"value", 2}});
+  worker.start();
+
+  REQUIRE(QTest::qWaitFor(
+      [&valuesMutex, &values]() {
+        QMutexLocker locker(&valuesMutex);
+        return values.size() == 2;
+      },
+      5000));
+  bus.unsubscribe(id);
+  worker.quit();
+  worker.wait();
+
+  // The Critical live value must not overtake the replay of its own topic
+  REQUIRE(values == QList<int>{1, 2});
+
+  bus.removeCriticalPattern("replay/focus");
+  bus.clearRetained("replay/focus");
+  bus.removeRetainPattern("replay/focus");
+}
+
+TEST_CASE("EventBus critical lane overtakes queued bulk events", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  bus.addCriticalPattern("lanes/critical/#");
+  REQUIRE(bus.priorityFor("lanes/critical/focus") == EventBus::Priority::Critical);
+  REQUIRE(bus.priorityFor("lanes/bulk") == EventBus::Priority::Normal);
+
+  const quint64 criticalBefore = bus.laneStats(EventBus::Priority::Critical).dispatched;
+  bus.setDispatchMode(EventBus::DispatchMode::Asynchronous);
+
+  // Direct connection runs in the dispatcher thread; the first event stalls it
+  // long enough for the whole burst to queue up behind it
+  QMutex orderMutex;
+  QStringList order;
+  const QMetaObject::Connection connection = QObject::connect(
+      &bus, &EventBus::messagePublished, &bus,
+      [&orderMutex, &order](const QString& topic, const QVariantMap&) {
+        QMutexLocker locker(&orderMutex);
+        if (order.isEmpty()) {
+          QThread::msleep(50);
+        }
+        order.append(topic);
+      },
+      Qt::DirectConnection);
+
+  const int bulk = 100;
+  for (int i = 0; i < bulk; ++i) {
+    bus.publish("lanes/bulk", {{"seq", i}});
+  }
+  bus.publish("lanes/critical/focus", {});
+
+  REQUIRE(QTest::qWaitFor(
+      [&orderMutex, &order]() {
+        QMutexLocker locker(&orderMutex);
+        return order.size() == bulk + 1;
+      },
+      5000));
+  bus.setDispatchMode(EventBus::DispatchMode::Synchronous);
+  QObject::disconnect(connection);
+
+  REQUIRE(order.indexOf("lanes/critical/focus") < bulk);
+
+  const EventBus::LaneStats critical = bus.laneStats(EventBus::Priority::Critical);
+  const EventBus::LaneStats normal = bus.laneStats(EventBus::Priority::Normal);
+  REQUIRE(critical.dispatched == criticalBefore + 1);
+  REQUIRE(critical.queueDepth == 0);
+  REQUIRE(normal.queueDepth == 0);
+
+  bus.removeCriticalPattern("lanes/critical/#");
+  REQUIRE(bus.priorityFor("lanes/critical/focus") == EventBus::Priority::Normal);
+}
+
+TEST_CASE("EventBus critical events overtake a receiver thread's backlog", "[eventbus]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  bus.addCriticalPattern("backlog/critical/#");
+  bus.setDispatchMode(EventBus::DispatchMode::Asynchronous);
+
+  QThread worker;
+  auto* receiver = new QObject();
+  receiver->moveToThread(&worker);
+  QObject::connect(&worker, &QThread::finished, receiver, &QObject::deleteLater);
+  worker.start();
+
+  // The first handler holds the receiver thread until the critical event has
+  // been dispatched, so the rest of the bulk burst is queued there by then
+  std::atomic_bool release{false};
+  QMutex orderMutex;
+  QStringList order;
+  const EventBus::SubscriptionId id = bus.subscribe(
+      "backlog/#", receiver,
+      [&release, &orderMutex, &order](const QString& topic, const QVariantMap&) {
+        QMutexLocker locker(&orderMutex);
+        order.append(topic);
+        const bool first = order.size() == 1;
+        locker.unlock();
+        while (first && !release.load()) {
+          QThread::msleep(1);
+        }
+      });
+
+  const EventBus::LaneStats normalBefore = bus.laneStats(EventBus::Priority::Normal);
+  const EventBus::LaneStats criticalBefore = bus.laneStats(EventBus::Priority::Critical);
+
+  const int bulk = 100;
+  for (int i = 0; i < bulk; ++i) {
+    bus.publish("backlog/bulk", {{"seq", i}});
+  }
+  REQUIRE(QTest::qWaitFor(
+      [&bus, &normalBefore]() {
+        return bus.laneStats(EventBus::Priority::Normal).dispatched ==
+               normalBefore.dispatched + bulk;
+      },
+      5000));
+  bus.publish("backlog/critical/focus", {});
+  REQUIRE(QTest::qWaitFor(
+      [&bus, &criticalBefore]() {
+        return bus.laneStats(EventBus::Priority::Critical).dispatched ==
+               criticalBefore.dispatched + 1;
+      },
+      5000));
+  release.store(true);
+
+  REQUIRE(QTest::qWaitFor(
+      [&orderMutex, &order]() {
+        QMutexLocker locker(&orderMutex);
+        return order.size() == bulk + 1;
+      },
+      5000));
+  bus.setDispatchMode(EventBus::DispatchMode::Synchronous);
+  bus.unsubscribe(id);
+  worker.quit();
+  worker.wait();
+
+  // Runs straight after the handler that was in progress, not after the backlog
+  REQUIRE(order.indexOf("backlog/critical/focus") == 1);
+
+  // Latency is taken when the handler runs, so the bulk backlog shows up
+  const EventBus::LaneStats critical = bus.laneStats(EventBus::Priority::Critical);
+  const EventBus::LaneStats normal = bus.laneStats(EventBus::Priority::Normal);
+  REQUIRE(critical.delivered == criticalBefore.delivered + 1);
+  REQUIRE(normal.delivered == normalBefore.delivered + bulk);
+  REQUIRE(normal.maxLatencyUs >= critical.lastLatencyUs);
+
+  bus.removeCriticalPattern("backlog/critical/#");
+}
@@ -0,0 +1,607 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QTemporaryDir>
+#include <QThread>
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "services/logging/BinaryLog.h"
+#include "services/logging/FlightRecorder.h"
+#include "services/logging/Logger.h"
+#include "services/logging/MpscRingBuffer.h"
+
+namespace {
+/// Run body with the Logger writing to a binary file, and return what it wrote
+auto captureRecords(const std::function<void()>& body) -> QList<BinaryLogEntry> {
+  QTemporaryDir dir;
+  const QString path = dir.filePath("capture.log");
+  Logger& logger = Logger::instance();
+  logger.setConsoleOutput(false);
+  logger.setBinaryFileFormat(true);
+  logger.setLogFile(path);
+
+  body();
+  logger.flush();
+
+  logger.setLogFile(QString());
+  logger.setBinaryFileFormat(false);
+  logger.setConsoleOutput(true);
+
+  QList<BinaryLogEntry> entries;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return entries;
+  }
+  BinaryLogDecoder decoder(file.readAll());
+  QString error;
+  BinaryLogEntry entry;
+  if (decoder.readHeader(error)) {
+    while (decoder.next(entry, error)) {
+      entries.append(entry);
+    }
+  }
+  return entries;
+}
+
+#ifdef Q_OS_UNIX
+/// Holds the Logger writer thread in open() of a FIFO until release() attaches a reader
+class StalledWriter {
+ public:
+  explicit StalledWriter(const QString& path) : m_path(QFile::encodeName(path)) {
+    ::mkfifo(m_path.constData(), 0600);
+    Logger& logger = Logger::instance();
+    logger.setConsoleOutput(false);
+    logger.setLogFile(path);
+    logger.info("stall");
+    QThread::msleep(100);  // The writer has taken the record and is blocked opening the file
+  }
+
+  ~StalledWriter() {
+    release();
+    Logger& logger = Logger::instance();
+    logger.flush();
+    logger.setLogFile(QString());
+    logger.setConsoleOutput(true);
+    m_done.store(true);
+    m_reader.join();
+  }
+
+  StalledWriter(const StalledWriter&) = delete;
+  StalledWriter& operator=(const StalledWriter&) = delete;
+
+  /// Open the read end, letting the writer continue, and discard what it writes
+  void release() {
+    if (m_reader.joinable()) {
+      return;
+    }
+    m_reader = std::thread([this]() {
+      const int fd = ::open(m_path.constData(), O_RDONLY);
+      char buffer[65536];
+      while (!m_done.load()) {
+        if (::read(fd, buffer, sizeof(buffer)) <= 0) {
+          QThread::msleep(1);
+        }
+      }
+      ::close(fd);
+    });
+  }
+
+ private:
+  QByteArray m_path;
+  std::thread m_reader;
+  std::atomic_bool m_done{false};
+};
+#endif
+}  // namespace
+
+TEST_CASE("BinaryLog round-trips records and interns repeats", "[logging]") {
+  BinaryLogEncoder encoder;
+  QByteArray data = BinaryLogEncoder::fileHeader();
+
+  QJsonObject context;
+  context["device_id"] = "device-123";
+  context["attempt"] = 3;
+
+  const qint64 base = 1767443696000;
+  encoder.append(data, base, 1, 42, "AudioMixer", "Channel MEDIA muted", QJsonObject());
+  encoder.append(data, base + 5, 0, 42, "AudioMixer", "Channel MEDIA muted", QJsonObject());
+  const qsizetype beforeRepeat = data.size();
+  encoder.append(data, base + 7, 0, 42, "AudioMixer", "Channel MEDIA muted", QJsonObject());
+  const qsizetype repeatCost = data.size() - beforeRepeat;
+  encoder.append(data, base + 3, 3, 7, "Session", QString::fromUtf8("Gerät getrennt"), context);
+  encoder.reset();
+  encoder.append(data, base + 60000, 2, 7, "Session", "After reset", QJsonObject());
+
+  // Third occurrence: tag, delta, level, component, thread, message id, context length
+  REQUIRE(repeatCost <= 8);
+
+  BinaryLogDecoder decoder(data);
+  QString error;
+  REQUIRE(decoder.readHeader(error));
+
+  BinaryLogEntry entry;
+  QList<BinaryLogEntry> entries;
+  while (decoder.next(entry, error)) {
+    entries.append(entry);
+  }
+  REQUIRE(error.isEmpty());
+  REQUIRE(entries.size() == 5);
+
+  REQUIRE(entries[0].timestampMs == base);
+  REQUIRE(entries[0].level == 1);
+  REQUIRE(entries[0].threadId == 42);
+  REQUIRE(entries[0].component == "AudioMixer");
+  REQUIRE(entries[2].message == "Channel MEDIA muted");
+  REQUIRE(entries[2].timestampMs == base + 7);
+
+  // Timestamps may step backwards (wall clock adjustments)
+  REQUIRE(entries[3].timestampMs == base + 3);
+  REQUIRE(entries[3].message == QString::fromUtf8("Gerät getrennt"));
+  REQUIRE(entries[3].context == context);
+
+  REQUIRE(entries[4].timestampMs == base + 60000);
+  REQUIRE(entries[4].component == "Session");
+  REQUIRE(entries[4].message == "After reset");
+}
+
+TEST_CASE("BinaryLog decoder reports bad input", "[logging]") {
+  QString error;
+  BinaryLogDecoder notBinary(QByteArray("{\"level\":\"INFO\"}\n"));
+  REQUIRE_FALSE(notBinary.readHeader(error));
+  REQUIRE(error == "bad_magic");
+
+  BinaryLogEncoder encoder;
+  QByteArray data = BinaryLogEncoder::fileHeader();
+  encoder.append(data, 1000, 1, 1, "Core", "complete", QJsonObject());
+  encoder.append(data, 1001, 1, 1, "Core", "cut off by power loss", QJsonObject());
+  data.chop(4);
+
+  BinaryLogDecoder decoder(data);
+  REQUIRE(decoder.readHeader(error));
+  BinaryLogEntry entry;
+  REQUIRE(decoder.next(entry, error));
+  REQUIRE(entry.message == "complete");
+  REQUIRE_FALSE(decoder.next(entry, error));
+  REQUIRE(error == "truncated");
+
+  // Only the complete record survives a trim
+  BinaryLogDecoder intact(data.left(BinaryLogDecoder::intactLength(data)));
+  REQUIRE(intact.readHeader(error));
+  REQUIRE(intact.next(entry, error));
+  REQUIRE(entry.message == "complete");
+  REQUIRE_FALSE(intact.next(entry, error));
+  REQUIRE(error.isEmpty());
+  REQUIRE(BinaryLogDecoder::intactLength(QByteArray("not a log")) == 0);
+}
+
+TEST_CASE("Logger writes decodable binary log files", "[logging]") {
+  QTemporaryDir dir;
+  REQUIRE(dir.isValid());
+  const QString path = dir.filePath("core.log");
+
+  Logger& logger = Logger::instance();
+  logger.setConsoleOutput(false);
+  logger.setBinaryFileFormat(true);
+  logger.setLogFile(path);
+
+  QJsonObject context;
+  context["session_id"] = "session-456";
+  logger.infoContext("AndroidAutoService", "Device connected", context);
+  logger.warning("Low memory detected");
+  REQUIRE(logger.flush());
+
+  logger.setLogFile(QString());
+  logger.setBinaryFileFormat(false);
+  logger.setConsoleOutput(true);
+
+  QFile file(path);
+  REQUIRE(file.open(QIODevice::ReadOnly));
+  BinaryLogDecoder decoder(file.readAll());
+  QString error;
+  REQUIRE(decoder.readHeader(error));
+
+  BinaryLogEntry entry;
+  REQUIRE(decoder.next(entry, error));
+  REQUIRE(entry.level == static_cast<int>(Logger::Level::Info));
+  REQUIRE(entry.component == "AndroidAutoService");
+  REQUIRE(entry.message == "Device connected");
+  REQUIRE(entry.context == context);
+
+  REQUIRE(decoder.next(entry, error));
+  REQUIRE(entry.level == static_cast<int>(Logger::Level::Warning));
+  REQUIRE(entry.component == "Crankshaft");
+  REQUIRE(entry.message == "Low memory detected");
+  REQUIRE_FALSE(decoder.next(entry, error));
+  REQUIRE(error.isEmpty());
+}
+
+TEST_CASE("Logger applies per-component levels", "[logging]") {
+  Logger& logger = Logger::instance();
+  logger.setLevel(Logger::Level::Info);
+  logger.setComponentLevel("AudioMixer", Logger::Level::Debug);
+  logger.setComponentLevel("CANDevice", Logger::Level::Error);
+
+  REQUIRE(logger.isEnabled(Logger::Level::Debug));
+  REQUIRE(logger.isEnabled(Logger::Level::Debug, "AudioMixer"));
+  REQUIRE_FALSE(logger.isEnabled(Logger::Level::Debug, "WebSocketServer"));
+  REQUIRE_FALSE(logger.isEnabled(Logger::Level::Warning, "CANDevice"));
+
+  const auto entries = captureRecords([&logger]() {
+    CRANKSHAFT_LOG(Logger::Level::Debug, "AudioMixer", QString("kept %1").arg(1));
+    CRANKSHAFT_LOG(Logger::Level::Debug, "WebSocketServer", QString("dropped"));
+    CRANKSHAFT_LOG(Logger::Level::Warning, "CANDevice", QString("dropped"));
+    logger.debug("[AudioMixer] kept 2");
+    logger.debug("[AudioRouter] dropped");
+    CRANKSHAFT_LOG_DEBUG(QString("[AudioMixer] kept %1").arg(3));
+    logger.info("kept 4");
+  });
+
+  logger.setComponentLevels(QVariantMap());
+  REQUIRE_FALSE(logger.isEnabled(Logger::Level::Debug));
+
+  REQUIRE(entries.size() == 4);
+  REQUIRE(entries[0].message == "kept 1");
+  REQUIRE(entries[1].message == "[AudioMixer] kept 2");
+  REQUIRE(entries[2].message == "[AudioMixer] kept 3");
+  REQUIRE(entries[3].message == "kept 4");
+}
+
+TEST_CASE("Logger samples and rate limits call sites with suppressed counts", "[logging]") {
+  Logger& logger = Logger::instance();
+  logger.setLevel(Logger::Level::Info);
+  const quint64 suppressedBefore = logger.suppressedRecords();
+
+  int formatted = 0;
+  auto message = [&formatted](int i) {
+    ++formatted;
+    return QString("packet %1").arg(i);
+  };
+
+  const auto entries = captureRecords([&message]() {
+    for (int i = 0; i < 25; ++i) {
+      CRANKSHAFT_LOG_SAMPLED(Logger::Level::Info, "Sampler", 10, message(i));
+    }
+    for (int i = 0; i < 5; ++i) {
+      CRANKSHAFT_LOG_RATE_LIMITED(Logger::Level::Info, "Limiter", 0.001, 2.0, message(100 + i));
+    }
+  });
+
+  // Suppressed records are never formatted
+  REQUIRE(formatted == 3 + 2);
+  REQUIRE(logger.suppressedRecords() - suppressedBefore == 22 + 3);
+
+  REQUIRE(entries.size() == 5);
+  REQUIRE(entries[0].message == "packet 0");
+  REQUIRE_FALSE(entries[0].context.contains("suppressed"));
+  REQUIRE(entries[1].message == "packet 10");
+  REQUIRE(entries[1].context.value("suppressed").toInt() == 9);
+  REQUIRE(entries[2].message == "packet 20");
+  REQUIRE(entries[3].message == "packet 100");
+  REQUIRE(entries[4].message == "packet 101");
+}
+
+TEST_CASE("Logger rotates by encoded bytes and archives in the background", "[logging]") {
+  QTemporaryDir dir;
+  REQUIRE(dir.isValid());
+  const QString path = dir.filePath("core.log");
+  const qint64 maxSize = 4096;
+
+  Logger& logger = Logger::instance();
+  LogArchiver::Retention retention;
+  retention.maxFiles = 2;
+  retention.compress = true;
+  logger.setConsoleOutput(false);
+  logger.setRetention(retention);
+  logger.setMaxLogSize(maxSize);
+  logger.setLogFile(path);
+
+  // Multi-byte UTF-8: a character count would undercount the file size
+  const QString padding(40, QChar(0x00E9));
+  for (int i = 0; i < 200; ++i) {
+    logger.info(QString("record %1 %2").arg(i).arg(padding));
+    REQUIRE(logger.flush());  // One record per batch, so no batch alone exceeds the limit
+  }
+  REQUIRE(QFileInfo(path).size() <= maxSize);
+
+  // Compression and retention finish on the archiver thread
+  const QString pattern = QStringLiteral("core.log.*");
+  QDir logDir(dir.path());
+  QElapsedTimer timer;
+  timer.start();
+  QStringList segments;
+  while (timer.elapsed() < 5000) {
+    segments = logDir.entryList({pattern}, QDir::Files);
+    const bool compressed =
+        !LogArchiver::compressionAvailable() ||
+        std::all_of(segments.cbegin(), segments.cend(),
+                    [](const QString& name) { return name.endsWith(QLatin1String(".gz")); });
+    if (segments.size() <= retention.maxFiles && compressed) {
+      break;
+    }
+    QThread::msleep(20);
+  }
+
+  logger.setLogFile(QString());
+  logger.setMaxLogSize(10 * 1024 * 1024);
+  logger.setRetention(LogArchiver::Retention());
+  logger.setConsoleOutput(true);
+
+  REQUIRE(segments.size() == retention.maxFiles);
+  for (const QString& name : segments) {
+    REQUIRE(QFileInfo(logDir.filePath(name)).size() > 0);
+    if (LogArchiver::compressionAvailable()) {
+      REQUIRE(name.endsWith(".gz"));
+    }
+  }
+}
+
+TEST_CASE("Logger starts a new file when the file format changes", "[logging]") {
+  QTemporaryDir dir;
+  REQUIRE(dir.isValid());
+  const QString path = dir.filePath("switch.log");
+
+  Logger& logger = Logger::instance();
+  logger.setLevel(Logger::Level::Info);
+  logger.setConsoleOutput(false);
+  logger.setLogFile(path);
+  logger.info("json record");
+  REQUIRE(logger.flush());
+
+  logger.setBinaryFileFormat(true);
+  logger.info("binary record");
+  REQUIRE(logger.flush());
+
+  logger.setLogFile(QString());
+  logger.setBinaryFileFormat(false);
+  logger.setConsoleOutput(true);
+
+  // The JSON lines were rotated aside instead of prefixing the binary stream
+  const QStringList segments =
+      QDir(dir.path()).entryList({QStringLiteral("switch.log.*")}, QDir::Files);
+  REQUIRE_FALSE(segments.isEmpty());
+  QFile file(path);
+  REQUIRE(file.open(QIODevice::ReadOnly));
+  BinaryLogDecoder decoder(file.readAll());
+  QString error;
+  BinaryLogEntry entry;
+  REQUIRE(decoder.readHeader(error));
+  REQUIRE(decoder.next(entry, error));
+  REQUIRE(entry.message == "binary record");
+}
+
+TEST_CASE("Logger appends decodably after a truncated binary log", "[logging]") {
+  QTemporaryDir dir;
+  REQUIRE(dir.isValid());
+  const QString path = dir.filePath("crashed.log");
+
+  // A previous session killed partway through writing its second record
+  BinaryLogEncoder encoder;
+  QByteArray previous = BinaryLogEncoder::fileHeader();
+  encoder.append(previous, 1000, 1, 1, "Core", "before the crash", QJsonObject());
+  encoder.append(previous, 1001, 1, 1, "Core", "half written", QJsonObject());
+  previous.chop(5);
+  {
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    REQUIRE(file.write(previous) == previous.size());
+  }
+
+  Logger& logger = Logger::instance();
+  logger.setLevel(Logger::Level::Info);
+  logger.setConsoleOutput(false);
+  logger.setBinaryFileFormat(true);
+  logger.setLogFile(path);
+  logger.info("after the restart");
+  REQUIRE(logger.flush());
+
+  logger.setLogFile(QString());
+  logger.setBinaryFileFormat(false);
+  logger.setConsoleOutput(true);
+
+  QFile file(path);
+  REQUIRE(file.open(QIODevice::ReadOnly));
+  BinaryLogDecoder decoder(file.readAll());
+  QString error;
+  BinaryLogEntry entry;
+  REQUIRE(decoder.readHeader(error));
+  REQUIRE(decoder.next(entry, error));
+  REQUIRE(entry.message == "before the crash");
+  REQUIRE(decoder.next(entry, error));
+  REQUIRE(entry.message == "after the restart");
+  REQUIRE_FALSE(decoder.next(entry, error));
+  REQUIRE(error.isEmpty());
+}
+
+TEST_CASE("FlightRecorder keeps the newest records and preserves a crashed ring", "[logging]") {
+  QTemporaryDir dir;
+  const QString path = dir.filePath("flight.bin");
+  auto readFile = [](const QString& name) {
+    QFile file(name);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+  };
+
+  QString error;
+  {
+    FlightRecorder recorder;
+    REQUIRE(recorder.open(path, 16, error));
+    REQUIRE(recorder.previousCrashDump().isEmpty());
+    for (int i = 0; i < 20; ++i) {
+      recorder.record(1767443696000 + i, 1, 7, "AudioMixer", QString("record %1").arg(i));
+    }
+    recorder.record(1767443697000, 3, 7, "AudioMixer", QString(1000, QLatin1Char('x')));
+    // Not marked clean: the next open() treats this run as crashed
+  }
+
+  std::vector<BinaryLogEntry> records;
+  REQUIRE(FlightRecorder::readRecords(readFile(path), records, error));
+  REQUIRE(records.size() == 16);
+  REQUIRE(records.front().message == "record 5");
+  REQUIRE(records.front().component == "AudioMixer");
+  REQUIRE(records.front().timestampMs == 1767443696005);
+  REQUIRE(records.back().level == 3);
+  REQUIRE(records.back().message.size() < 1000);
+  REQUIRE_FALSE(FlightRecorder::wasClean(readFile(path)));
+
+  FlightRecorder next;
+  REQUIRE(next.open(path, 16, error));
+  REQUIRE(next.previousCrashDump() == path + ".crash");
+  REQUIRE(FlightRecorder::readRecords(readFile(path + ".crash"), records, error));
+  REQUIRE(records.size() == 16);
+  REQUIRE(FlightRecorder::readRecords(readFile(path), records, error));
+  REQUIRE(records.empty());
+
+  next.markClean();
+  REQUIRE(FlightRecorder::wasClean(readFile(path)));
+  REQUIRE_FALSE(FlightRecorder::readRecords(QByteArray("CSBL"), records, error));
+}
+
+TEST_CASE("MpscRingBuffer is bounded and keeps per-producer order", "[logging]") {
+  MpscRingBuffer<int> ring(6);
+  REQUIRE(ring.capacity() == 8);
+
+  int value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value = i;
+    REQUIRE(ring.tryPush(value));
+  }
+  value = 99;
+  REQUIRE_FALSE(ring.tryPush(value));
+  REQUIRE(value == 99);  // Not moved from on failure
+
+  int out = -1;
+  REQUIRE(ring.tryPop(out));
+  REQUIRE(out == 0);
+  REQUIRE(ring.tryPush(value));
+  while (ring.tryPop(out)) {
+  }
+  REQUIRE(out == 99);
+
+  const int numThreads = 4;
+  const int valuesPerThread = 20000;
+  MpscRingBuffer<int> shared(64);
+  QList<QThread*> threads;
+  for (int t = 0; t < numThreads; ++t) {
+    QThread* thread = QThread::create([&shared, t, valuesPerThread]() {
+      for (int j = 0; j < valuesPerThread; ++j) {
+        int item = t * valuesPerThread + j;
+        while (!shared.tryPush(item)) {
+          QThread::yieldCurrentThread();
+        }
+      }
+    });
+    threads.append(thread);
+    thread->start();
+  }
+
+  QVector<int> lastSeen(numThreads, -1);
+  int received = 0;
+  bool ordered = true;
+  while (received < numThreads * valuesPerThread) {
+    int item = 0;
+    if (!shared.tryPop(item)) {
+      QThread::yieldCurrentThread();
+      continue;
+    }
+    const int producer = item / valuesPerThread;
+    ordered = ordered && item % valuesPerThread == lastSeen[producer] + 1;
+    lastSeen[producer] = item % valuesPerThread;
+    ++received;
+  }
+
+  for (QThread* thread : threads) {
+    thread->wait();
+    delete thread;
+  }
+  REQUIRE(ordered);
+  REQUIRE(shared.sizeApprox() == 0);
+}
+
+#ifdef Q_OS_UNIX
+TEST_CASE("Logger counts records dropped with the buffer full", "[logging]") {
+  QTemporaryDir dir;
+  Logger& logger = Logger::instance();
+  logger.setLevel(Logger::Level::Info);
+  logger.setOverflowPolicy(Logger::OverflowPolicy::Drop);
+
+  StalledWriter stall(dir.filePath("stall.fifo"));
+  const quint64 droppedBefore = logger.droppedRecords();
+  constexpr int kExtra = 100;
+  for (std::size_t i = 0; i < Logger::kQueueCapacity + kExtra; ++i) {
+    logger.info("fill");
+  }
+  REQUIRE(logger.droppedRecords() - droppedBefore == kExtra);
+}
+
+TEST_CASE("Logger Block policy waits for space except on real-time threads", "[logging]") {
+  QTemporaryDir dir;
+  Logger& logger = Logger::instance();
+  logger.setLevel(Logger::Level::Info);
+  logger.setOverflowPolicy(Logger::OverflowPolicy::Block);
+
+  StalledWriter stall(dir.filePath("stall.fifo"));
+  for (std::size_t i = 0; i < Logger::kQueueCapacity; ++i) {
+    logger.info("fill");
+  }
+  const quint64 droppedBefore = logger.droppedRecords();
+
+  // A real-time caller returns at once and its record is counted as dropped
+  bool realtimeRestored = true;
+  std::thread realtime([&logger, &realtimeRestored]() {
+    {
+      const Logger::RealtimeScope scope;
+      logger.info("realtime");
+    }
+    realtimeRestored = !Logger::isRealtimeThread();
+  });
+  realtime.join();
+  REQUIRE(realtimeRestored);
+  REQUIRE(logger.droppedRecords() - droppedBefore == 1);
+
+  // Any other caller waits until the writer makes room
+  std::atomic_bool logged{false};
+  std::thread blocked([&logger, &logged]() {
+    logger.info("blocked");
+    logged.store(true);
+  });
+  QThread::msleep(100);
+  CHECK_FALSE(logged.load());
+  stall.release();
+  blocked.join();
+  REQUIRE(logged.load());
+  REQUIRE(logger.droppedRecords() - droppedBefore == 1);
+
+  logger.setOverflowPolicy(Logger::OverflowPolicy::Drop);
+}
+#endif
@@ -17,15 +17,30 @@
  *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QCborMap>
+#include <QCborValue>
 #include <QCoreApplication>
+#include <QDir>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QLocalSocket>
+#include <QNetworkRequest>
 #include <QSignalSpy>
 #include <QTest>
 #include <QWebSocket>
+#include <QtEndian>
 #include <catch2/catch_all.hpp>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+#include <QWebSocketHandshakeOptions>
+#endif
 
+#include "services/android_auto/MockAndroidAutoService.h"
 #include "services/eventbus/EventBus.h"
+#include "services/profile/ProfileManager.h"
+#include "services/service_manager/ServiceManager.h"
+#include "services/websocket/JsonPatch.h"
+#include "services/websocket/MessageValidator.h"
 #include "services/websocket/WebSocketServer.h"
 
 TEST_CASE("WebSocketServer starts and stops", "[websocket]") {
@@ -170,3 +185,664 @@ TEST_CASE("WebSocketServer multiple clients", "[websocket]") {
   client1.close();
   client2.close();
 }
+
+TEST_CASE("WebSocketServer replays retained state on subscribe", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus::instance().addRetainPattern("bootstrap/state");
+  EventBus::instance().publish("bootstrap/state", {{"value", 42}});
+  EventBus::instance().publish("bootstrap/error", {{"value", 7}});
+
+  WebSocketServer server(8086);
+  QWebSocket client;
+
+  QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+  QSignalSpy messageSpy(&client, &QWebSocket::textMessageReceived);
+
+  client.open(QUrl("ws://localhost:8086"));
+  REQUIRE(connectedSpy.wait(1000));
+
+  QJsonObject subscribeMsg;
+  subscribeMsg["type"] = "subscribe";
+  subscribeMsg["topic"] = "bootstrap/*";
+  client.sendTextMessage(QJsonDocument(subscribeMsg).toJson(QJsonDocument::Compact));
+
+  // No broadcast needed: the current value arrives as soon as we subscribe
+  REQUIRE(messageSpy.wait(1000));
+  REQUIRE(messageSpy.count() == 1);
+
+  const QJsonObject receivedObj =
+      QJsonDocument::fromJson(messageSpy.at(0).at(0).toString().toUtf8()).object();
+  REQUIRE(receivedObj["type"].toString() == "event");
+  REQUIRE(receivedObj["topic"].toString() == "bootstrap/state");
+  REQUIRE(receivedObj["payload"].toObject()["value"].toInt() == 42);
+
+  // The one-off bootstrap/error event is not retained and never replayed
+  QTest::qWait(100);
+  REQUIRE(messageSpy.count() == 1);
+
+  client.close();
+  EventBus::instance().removeRetainPattern("bootstrap/state");
+}
+
+TEST_CASE("WebSocketServer sends one copy per client for overlapping subscriptions",
+          "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  WebSocketServer server(8087);
+  QWebSocket client;
+
+  QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+  QSignalSpy messageSpy(&client, &QWebSocket::textMessageReceived);
+
+  client.open(QUrl("ws://localhost:8087"));
+  REQUIRE(connectedSpy.wait(1000));
+
+  for (const char* pattern : {"fanout/*", "fanout/event", "*"}) {
+    QJsonObject subscribeMsg;
+    subscribeMsg["type"] = "subscribe";
+    subscribeMsg["topic"] = pattern;
+    client.sendTextMessage(QJsonDocument(subscribeMsg).toJson(QJsonDocument::Compact));
+  }
+  QTest::qWait(100);
+  messageSpy.clear();  // Drop any retained-state replay
+
+  server.broadcastEvent("fanout/event", {{"n", 1}});
+  server.broadcastEvent("other/event", {{"n", 2}});
+
+  REQUIRE(messageSpy.wait(1000));
+  QTest::qWait(100);
+  REQUIRE(messageSpy.count() == 2);
+
+  const QJsonObject first =
+      QJsonDocument::fromJson(messageSpy.at(0).at(0).toString().toUtf8()).object();
+  REQUIRE(first["topic"].toString() == "fanout/event");
+
+  client.close();
+}
+
+TEST_CASE("WebSocketServer honours single-level wildcards in any position", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  WebSocketServer server(8088);
+  QWebSocket client;
+
+  QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+  QSignalSpy messageSpy(&client, &QWebSocket::textMessageReceived);
+
+  client.open(QUrl("ws://localhost:8088"));
+  REQUIRE(connectedSpy.wait(1000));
+
+  QJsonObject subscribeMsg;
+  subscribeMsg["type"] = "subscribe";
+  subscribeMsg["topic"] = "wildcard/+/state-changed";
+  client.sendTextMessage(QJsonDocument(subscribeMsg).toJson(QJsonDocument::Compact));
+  QTest::qWait(100);
+  messageSpy.clear();
+
+  server.broadcastEvent("wildcard/status/connected", {});
+  server.broadcastEvent("wildcard/status/extra/state-changed", {});
+  server.broadcastEvent("wildcard/status/state-changed", {});
+
+  REQUIRE(messageSpy.wait(1000));
+  QTest::qWait(100);
+  REQUIRE(messageSpy.count() == 1);
+  const QJsonObject received =
+      QJsonDocument::fromJson(messageSpy.at(0).at(0).toString().toUtf8()).object();
+  REQUIRE(received["topic"].toString() == "wildcard/status/state-changed");
+
+  client.close();
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+TEST_CASE("WebSocketServer negotiates binary CBOR frames", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  WebSocketServer server(8089);
+  QWebSocket binaryClient;
+  QWebSocket textClient;
+
+  QSignalSpy binaryConnected(&binaryClient, &QWebSocket::connected);
+  QSignalSpy textConnected(&textClient, &QWebSocket::connected);
+  QSignalSpy binaryMessages(&binaryClient, &QWebSocket::binaryMessageReceived);
+  QSignalSpy textMessages(&textClient, &QWebSocket::textMessageReceived);
+
+  QWebSocketHandshakeOptions options;
+  options.setSubprotocols({WebSocketServer::kCborSubprotocol});
+  binaryClient.open(QNetworkRequest(QUrl("ws://localhost:8089")), options);
+  REQUIRE(binaryConnected.wait(1000));
+  REQUIRE(binaryClient.subprotocol() == WebSocketServer::kCborSubprotocol);
+
+  textClient.open(QUrl("ws://localhost:8089"));
+  REQUIRE(textConnected.wait(1000));
+
+  // Same message schema, CBOR-encoded in a binary frame
+  QCborMap subscribeMsg;
+  subscribeMsg.insert(QStringLiteral("type"), QStringLiteral("subscribe"));
+  subscribeMsg.insert(QStringLiteral("topic"), QStringLiteral("binary/*"));
+  binaryClient.sendBinaryMessage(subscribeMsg.toCborValue().toCbor());
+
+  QJsonObject textSubscribe;
+  textSubscribe["type"] = "subscribe";
+  textSubscribe["topic"] = "binary/*";
+  textClient.sendTextMessage(QJsonDocument(textSubscribe).toJson(QJsonDocument::Compact));
+  QTest::qWait(100);
+
+  server.broadcastEvent("binary/event", {{"value", 5}});
+
+  REQUIRE(binaryMessages.wait(1000));
+  if (textMessages.count() == 0) {
+    REQUIRE(textMessages.wait(1000));
+  }
+
+  const QCborMap received =
+      QCborValue::fromCbor(binaryMessages.at(0).at(0).toByteArray()).toMap();
+  REQUIRE(received.value(QStringLiteral("type")).toString() == "event");
+  REQUIRE(received.value(QStringLiteral("topic")).toString() == "binary/event");
+  const QCborMap payload = received.value(QStringLiteral("payload")).toMap();
+  REQUIRE(payload.value(QStringLiteral("value")).toInteger() == 5);
+
+  const QJsonObject textReceived =
+      QJsonDocument::fromJson(textMessages.at(0).at(0).toString().toUtf8()).object();
+  REQUIRE(textReceived["topic"].toString() == "binary/event");
+
+  binaryClient.close();
+  textClient.close();
+}
+#endif
+
+TEST_CASE("WebSocketServer bounds outbound queues of slow clients", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  WebSocketServer server(8090);
+  QWebSocket client;
+  QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+  QSignalSpy disconnectedSpy(&client, &QWebSocket::disconnected);
+  client.open(QUrl("ws://localhost:8090"));
+  REQUIRE(connectedSpy.wait(1000));
+
+  QJsonObject subscribeMsg;
+  subscribeMsg["type"] = "subscribe";
+  subscribeMsg["topic"] = "slow/#";
+  client.sendTextMessage(QJsonDocument(subscribeMsg).toJson(QJsonDocument::Compact));
+  QTest::qWait(100);
+
+  // A zero socket budget makes every frame wait in the outbound queue
+  WebSocketServer::OutboundLimits limits;
+  limits.maxMessages = 2;
+  limits.socketBufferBytes = 0;
+  limits.policy = WebSocketServer::SlowConsumerPolicy::DropOldest;
+  server.setOutboundLimits(limits);
+
+  for (int i = 0; i < 5; ++i) {
+    server.broadcastEvent("slow/a", {{"seq", i}});
+  }
+  QList<WebSocketServer::ClientStats> stats = server.clientStats();
+  REQUIRE(stats.size() == 1);
+  REQUIRE(stats.at(0).queuedMessages == 2);
+  REQUIRE(stats.at(0).dropped == 3);
+
+  // Conflation replaces the queued event of the same topic instead of dropping
+  limits.policy = WebSocketServer::SlowConsumerPolicy::Conflate;
+  server.setOutboundLimits(limits);
+  server.broadcastEvent("slow/a", {{"seq", 5}});
+  stats = server.clientStats();
+  REQUIRE(stats.at(0).queuedMessages == 2);
+  REQUIRE(stats.at(0).dropped == 3);
+  REQUIRE(stats.at(0).conflated == 1);
+
+  limits.policy = WebSocketServer::SlowConsumerPolicy::Disconnect;
+  server.setOutboundLimits(limits);
+  server.broadcastEvent("slow/b", {});
+  REQUIRE(server.slowConsumerDisconnects() == 1);
+  REQUIRE(disconnectedSpy.wait(1000));
+}
+
+TEST_CASE("WebSocketServer relays bus events from its I/O thread", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  WebSocketServer server(8091);
+  server.relayEventBus(EventBus::instance());
+  server.startIoThread();
+  REQUIRE(server.thread() != app.thread());
+
+  QWebSocket client;
+  QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+  QSignalSpy messageSpy(&client, &QWebSocket::textMessageReceived);
+  client.open(QUrl("ws://localhost:8091"));
+  REQUIRE(connectedSpy.wait(1000));
+
+  QJsonObject subscribeMsg;
+  subscribeMsg["type"] = "subscribe";
+  subscribeMsg["topic"] = "io/+";
+  client.sendTextMessage(QJsonDocument(subscribeMsg).toJson(QJsonDocument::Compact));
+  QTest::qWait(100);
+
+  EventBus::instance().publish("io/event", {{"value", 11}});
+
+  REQUIRE(messageSpy.wait(1000));
+  const QJsonObject received =
+      QJsonDocument::fromJson(messageSpy.at(0).at(0).toString().toUtf8()).object();
+  REQUIRE(received["topic"].toString() == "io/event");
+  REQUIRE(received["payload"].toObject()["value"].toInt() == 11);
+
+  client.close();
+  server.stopIoThread();
+  REQUIRE(server.thread() == app.thread());
+}
+
+TEST_CASE("WebSocketServer serves length-prefixed CBOR on a Unix socket", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  // Port 0 keeps the TCP endpoint closed
+  WebSocketServer server(0);
+  const QString path = QDir::tempPath() + QStringLiteral("/crankshaft-test-core.sock");
+  REQUIRE(server.listenLocal(path));
+  REQUIRE(server.isListening());
+
+  QLocalSocket client;
+  client.connectToServer(path);
+  REQUIRE(client.waitForConnected(1000));
+
+  const auto writeFrame = [&client](const QCborMap& message) {
+    const QByteArray cbor = message.toCborValue().toCbor();
+    const quint32 length = qToBigEndian(static_cast<quint32>(cbor.size()));
+    client.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    client.write(cbor);
+    client.flush();
+  };
+
+  QCborMap subscribeMsg;
+  subscribeMsg.insert(QStringLiteral("type"), QStringLiteral("subscribe"));
+  subscribeMsg.insert(QStringLiteral("topic"), QStringLiteral("local/+"));
+  writeFrame(subscribeMsg);
+  QTest::qWait(100);
+  REQUIRE(server.clientStats().size() == 1);
+
+  server.broadcastEvent("local/event", {{"value", 3}});
+
+  QByteArray buffer;
+  REQUIRE(QTest::qWaitFor(
+      [&client, &buffer]() {
+        buffer.append(client.readAll());
+        return buffer.size() >= 4 &&
+               buffer.size() >= 4 + qFromBigEndian<quint32>(buffer.constData());
+      },
+      1000));
+
+  const quint32 length = qFromBigEndian<quint32>(buffer.constData());
+  const QCborMap received = QCborValue::fromCbor(buffer.mid(4, length)).toMap();
+  REQUIRE(received.value(QStringLiteral("type")).toString() == "event");
+  REQUIRE(received.value(QStringLiteral("topic")).toString() == "local/event");
+  const QCborMap payload = received.value(QStringLiteral("payload")).toMap();
+  REQUIRE(payload.value(QStringLiteral("value")).toInteger() == 3);
+
+  client.disconnectFromServer();
+}
+
+TEST_CASE("WebSocketServer answers a batch with one correlated response", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  WebSocketServer server(8092);
+  QWebSocket client;
+  QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+  QSignalSpy messageSpy(&client, &QWebSocket::textMessageReceived);
+  client.open(QUrl("ws://localhost:8092"));
+  REQUIRE(connectedSpy.wait(1000));
+
+  const auto op = [](const QString& type, const QString& topic) {
+    QJsonObject obj;
+    obj["type"] = type;
+    obj["topic"] = topic;
+    return obj;
+  };
+  QJsonObject command;
+  command["type"] = "service_command";
+  command["id"] = "svc-1";
+  command["command"] = "get_running_services";
+  command["params"] = QJsonObject();
+
+  QJsonObject batch;
+  batch["type"] = "batch";
+  batch["id"] = 42;
+  batch["ops"] = QJsonArray{op("subscribe", "batch/a"), op("subscribe", "batch/b"),
+                            op("unsubscribe", "batch/never"), command};
+  client.sendTextMessage(QJsonDocument(batch).toJson(QJsonDocument::Compact));
+
+  REQUIRE(messageSpy.wait(1000));
+  REQUIRE(messageSpy.count() == 1);
+  const QJsonObject response =
+      QJsonDocument::fromJson(messageSpy.at(0).at(0).toString().toUtf8()).object();
+  REQUIRE(response["type"].toString() == "batch_response");
+  REQUIRE(response["id"].toInt() == 42);
+
+  const QJsonArray results = response["results"].toArray();
+  REQUIRE(results.size() == 4);
+  REQUIRE(results.at(0).toObject()["success"].toBool());
+  REQUIRE(results.at(1).toObject()["success"].toBool());
+  REQUIRE(results.at(2).toObject()["error"].toString() == "not_subscribed");
+  // No ServiceManager in this test: the command still answers, correlated by id
+  REQUIRE(results.at(3).toObject()["type"].toString() == "service_response");
+  REQUIRE(results.at(3).toObject()["id"].toString() == "svc-1");
+  REQUIRE_FALSE(results.at(3).toObject()["success"].toBool());
+
+  server.broadcastEvent("batch/b", {});
+  REQUIRE(messageSpy.wait(1000));
+
+  // Errors for single requests echo the correlation id too
+  QJsonObject bad;
+  bad["type"] = "subscribe";
+  bad["id"] = "sub-9";
+  client.sendTextMessage(QJsonDocument(bad).toJson(QJsonDocument::Compact));
+  REQUIRE(messageSpy.wait(1000));
+  const QJsonObject error =
+      QJsonDocument::fromJson(messageSpy.last().at(0).toString().toUtf8()).object();
+  REQUIRE(error["type"].toString() == "error");
+  REQUIRE(error["id"].toString() == "sub-9");
+
+  client.close();
+}
+
+TEST_CASE("WebSocketServer runs lifecycle commands as jobs", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  ProfileManager profileManager(QDir::tempPath() + QStringLiteral("/crankshaft-test-profiles"));
+  ServiceManager serviceManager(&profileManager);
+  WebSocketServer server(8093);
+  server.setServiceManager(&serviceManager);
+  server.relayEventBus(EventBus::instance());
+
+  QWebSocket client;
+  QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+  QSignalSpy messageSpy(&client, &QWebSocket::textMessageReceived);
+  client.open(QUrl("ws://localhost:8093"));
+  REQUIRE(connectedSpy.wait(1000));
+
+  QJsonObject subscribeMsg;
+  subscribeMsg["type"] = "subscribe";
+  subscribeMsg["topic"] = "service-manager/job/completed";
+  client.sendTextMessage(QJsonDocument(subscribeMsg).toJson(QJsonDocument::Compact));
+  QTest::qWait(100);
+
+  QJsonObject command;
+  command["type"] = "service_command";
+  command["id"] = 1;
+  command["command"] = "stop_service";
+  command["params"] = QJsonObject{{"service", "NoSuchService"}};
+  client.sendTextMessage(QJsonDocument(command).toJson(QJsonDocument::Compact));
+
+  // Acknowledged with a job id before the command has run
+  REQUIRE(messageSpy.wait(1000));
+  const QJsonObject ack =
+      QJsonDocument::fromJson(messageSpy.at(0).at(0).toString().toUtf8()).object();
+  REQUIRE(ack["type"].toString() == "service_response");
+  REQUIRE(ack["id"].toInt() == 1);
+  REQUIRE(ack["status"].toString() == "queued");
+  const QString jobId = ack["job_id"].toString();
+  REQUIRE_FALSE(jobId.isEmpty());
+
+  if (messageSpy.count() < 2) {
+    REQUIRE(messageSpy.wait(1000));
+  }
+  const QJsonObject completed =
+      QJsonDocument::fromJson(messageSpy.at(1).at(0).toString().toUtf8()).object();
+  REQUIRE(completed["topic"].toString() == "service-manager/job/completed");
+  const QJsonObject payload = completed["payload"].toObject();
+  REQUIRE(payload["job_id"].toString() == jobId);
+  REQUIRE(payload["state"].toString() == "failed");
+  REQUIRE_FALSE(payload["success"].toBool());
+
+  client.close();
+}
+
+#if CRANKSHAFT_JSON_SCHEMA_VALIDATOR
+TEST_CASE("MessageValidator accepts and rejects each inbound message type", "[websocket]") {
+  MessageValidator validator;
+  REQUIRE(validator.loadSchema(MessageValidator::defaultSchemaPath()));
+  for (const char* type : {"subscribe", "unsubscribe", "publish", "service_command", "batch"}) {
+    REQUIRE(validator.hasSchemaFor(type));
+  }
+
+  QString error;
+  const auto accepts = [&validator, &error](const QJsonObject& message) {
+    error.clear();
+    return validator.validate(message.value("type").toString(), message, error);
+  };
+
+  // subscribe
+  REQUIRE(accepts({{"type", "subscribe"}, {"topic", "audio/+"}, {"delta", true}, {"id", 1}}));
+  REQUIRE_FALSE(accepts({{"type", "subscribe"}, {"topic", ""}}));
+  REQUIRE(error == "schema_violation");
+  REQUIRE_FALSE(accepts({{"type", "subscribe"}, {"topic", "a"}, {"extra", 1}}));
+
+  // unsubscribe
+  REQUIRE(accepts({{"type", "unsubscribe"}, {"topic", "audio/+"}}));
+  REQUIRE_FALSE(accepts({{"type", "unsubscribe"}}));
+  REQUIRE(error == "schema_violation");
+
+  // publish: envelope, then per-topic payload
+  REQUIRE(accepts({{"type", "publish"},
+                   {"topic", "audio/volume"},
+                   {"payload", QJsonObject{{"master", 50}}}}));
+  REQUIRE_FALSE(accepts({{"type", "publish"}, {"topic", "audio/#"}, {"payload", QJsonObject{}}}));
+  REQUIRE(error == "schema_violation");
+  REQUIRE_FALSE(accepts({{"type", "publish"},
+                         {"topic", "audio/volume"},
+                         {"payload", QJsonObject{{"master", 150}}}}));
+  REQUIRE(error == "invalid_payload");
+  REQUIRE(accepts({{"type", "publish"},
+                   {"topic", "androidauto/touch"},
+                   {"payload", QJsonObject{{"x", 1.0}, {"y", 0}, {"action", "move"}}}}));
+  REQUIRE_FALSE(accepts({{"type", "publish"},
+                         {"topic", "androidauto/touch"},
+                         {"payload", QJsonObject{{"x", 1.2}, {"y", 0.5}, {"action", "move"}}}}));
+  REQUIRE(error == "invalid_payload");
+
+  // service_command
+  REQUIRE(accepts({{"type", "service_command"},
+                   {"command", "start_service"},
+                   {"params", QJsonObject{{"service", "wifi"}}}}));
+  REQUIRE_FALSE(accepts({{"type", "service_command"},
+                         {"command", "format_disk"},
+                         {"params", QJsonObject{}}}));
+  REQUIRE(error == "schema_violation");
+
+  // batch
+  REQUIRE(accepts({{"type", "batch"},
+                   {"ops", QJsonArray{QJsonObject{{"type", "subscribe"}, {"topic", "a"}}}}}));
+  REQUIRE_FALSE(accepts({{"type", "batch"}, {"ops", QJsonArray{}}}));
+  REQUIRE(error == "schema_violation");
+
+  const MessageValidator::Stats stats = validator.stats();
+  REQUIRE(stats.validated == 14);
+  REQUIRE(stats.rejected == 8);
+}
+#endif
+
+TEST_CASE("WebSocketServer rate limits inbound messages per client", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  WebSocketServer server(8094);
+  WebSocketServer::InboundLimits limits;
+  limits.messagesPerSecond = 0.01;  // Effectively no refill during the test
+  limits.messageBurst = 3;
+  limits.publishBytesPerSecond = 0.01;
+  limits.publishByteBurst = 256;
+  server.setInboundLimits(limits);
+
+  QWebSocket client;
+  QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+  QSignalSpy messageSpy(&client, &QWebSocket::textMessageReceived);
+  client.open(QUrl("ws://localhost:8094"));
+  REQUIRE(connectedSpy.wait(1000));
+
+  // A publish larger than the byte burst is refused, but costs a message token
+  QJsonObject publishMsg;
+  publishMsg["type"] = "publish";
+  publishMsg["topic"] = "test/flood";
+  publishMsg["payload"] = QJsonObject{{"data", QString(512, QLatin1Char('x'))}};
+  client.sendTextMessage(QJsonDocument(publishMsg).toJson(QJsonDocument::Compact));
+  REQUIRE(messageSpy.wait(1000));
+  const QJsonObject publishError =
+      QJsonDocument::fromJson(messageSpy.at(0).at(0).toString().toUtf8()).object();
+  REQUIRE(publishError["type"].toString() == "error");
+  REQUIRE(publishError["message"].toString() == "rate_limited");
+
+  // Two tokens left: the rest of the flood is dropped with a single reply
+  for (int i = 0; i < 10; ++i) {
+    QJsonObject subscribeMsg;
+    subscribeMsg["type"] = "subscribe";
+    subscribeMsg["topic"] = QString("test/flood/%1").arg(i);
+    client.sendTextMessage(QJsonDocument(subscribeMsg).toJson(QJsonDocument::Compact));
+  }
+  REQUIRE(messageSpy.wait(1000));
+  QTest::qWait(100);
+  REQUIRE(messageSpy.count() == 2);
+  const QJsonObject floodError =
+      QJsonDocument::fromJson(messageSpy.at(1).at(0).toString().toUtf8()).object();
+  REQUIRE(floodError["message"].toString() == "rate_limited");
+
+  const QList<WebSocketServer::ClientStats> stats = server.clientStats();
+  REQUIRE(stats.size() == 1);
+  REQUIRE(stats.first().rateLimited == 8);
+  REQUIRE(stats.first().publishRateLimited == 1);
+
+  client.close();
+}
+
+TEST_CASE("JsonPatch diff round-trips through apply", "[websocket]") {
+  const QJsonObject from{{"name", "head unit"},
+                         {"devices", QJsonArray{QJsonObject{{"id", 1}, {"rssi", -70}},
+                                                QJsonObject{{"id", 2}, {"rssi", -55}}}},
+                         {"a/b", 1},
+                         {"stale", true}};
+  const QJsonObject to{{"name", "head unit"},
+                       {"devices", QJsonArray{QJsonObject{{"id", 1}, {"rssi", -61}},
+                                              QJsonObject{{"id", 2}, {"rssi", -55}}}},
+                       {"a/b", 2},
+                       {"added", QJsonObject{{"x", 1}}}};
+
+  const QJsonArray patch = JsonPatch::diff(from, to);
+  REQUIRE(patch.size() == 4);
+  QJsonObject patched = from;
+  REQUIRE(JsonPatch::apply(patched, patch));
+  REQUIRE(patched == to);
+  REQUIRE(JsonPatch::diff(to, to).isEmpty());
+
+  // A patch that does not fit leaves the target untouched
+  QJsonObject untouched = from;
+  const QJsonArray bad{QJsonObject{{"op", "replace"}, {"path", "/name"}, {"value", "x"}},
+                       QJsonObject{{"op", "remove"}, {"path", "/missing"}}};
+  REQUIRE_FALSE(JsonPatch::apply(untouched, bad));
+  REQUIRE(untouched == from);
+}
+
+TEST_CASE("WebSocketServer sends snapshots then deltas to opted-in clients", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  WebSocketServer server(8095);
+  QWebSocket client;
+  QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+  QSignalSpy messageSpy(&client, &QWebSocket::textMessageReceived);
+  client.open(QUrl("ws://localhost:8095"));
+  REQUIRE(connectedSpy.wait(1000));
+
+  QJsonObject subscribeMsg;
+  subscribeMsg["type"] = "subscribe";
+  subscribeMsg["topic"] = "state/devices";
+  subscribeMsg["delta"] = true;
+  client.sendTextMessage(QJsonDocument(subscribeMsg).toJson(QJsonDocument::Compact));
+  QTest::qWait(100);
+
+  QVariantMap payload{{"count", 2}, {"scanning", false}, {"names", QVariantList{"a", "b"}}};
+  const auto next = [&]() {
+    REQUIRE(messageSpy.wait(1000));
+    return QJsonDocument::fromJson(messageSpy.last().at(0).toString().toUtf8()).object();
+  };
+
+  server.broadcastEvent("state/devices", payload);
+  const QJsonObject snapshot = next();
+  REQUIRE(snapshot["type"].toString() == "snapshot");
+  REQUIRE(snapshot["seq"].toInteger() == 1);
+  QJsonObject held = snapshot["payload"].toObject();
+
+  payload["scanning"] = true;
+  server.broadcastEvent("state/devices", payload);
+  const QJsonObject delta = next();
+  REQUIRE(delta["type"].toString() == "delta");
+  REQUIRE(delta["base"].toInteger() == 1);
+  REQUIRE(delta["seq"].toInteger() == 2);
+  REQUIRE(delta["patch"].toArray().size() == 1);
+  REQUIRE(JsonPatch::apply(held, delta["patch"].toArray()));
+  REQUIRE(held == QJsonObject::fromVariantMap(payload));
+
+  // Periodic resync
+  server.setDeltaResyncInterval(1);
+  payload["count"] = 3;
+  server.broadcastEvent("state/devices", payload);
+  const QJsonObject resync = next();
+  REQUIRE(resync["type"].toString() == "snapshot");
+  REQUIRE(resync["seq"].toInteger() == 3);
+  REQUIRE(resync["payload"].toObject() == QJsonObject::fromVariantMap(payload));
+
+  client.close();
+}
+
+TEST_CASE("Android Auto status topics have one publisher and one schema", "[websocket]") {
+  int argc = 0;
+  char* argv[] = {nullptr};
+  QCoreApplication app(argc, argv);
+
+  EventBus& bus = EventBus::instance();
+  bus.addRetainPattern("android-auto/status/state-changed");
+
+  QObject receiver;
+  QList<QPair<QString, QVariantMap>> received;
+  bus.subscribe("android-auto/status/#", &receiver,
+                [&received](const QString& topic, const QVariantMap& payload) {
+                  received.append({topic, payload});
+                });
+
+  {
+    MockAndroidAutoService service;
+    REQUIRE(service.initialise());
+    REQUIRE_FALSE(service.connectToDevice("unknown-serial"));
+
+    // Each transition arrives once, in the service's connection-state schema
+    REQUIRE(received.size() == 2);
+    REQUIRE(received.at(0).first == "android-auto/status/state-changed");
+    REQUIRE(received.at(0).second.value("state").toInt() ==
+            static_cast<int>(AndroidAutoService::ConnectionState::SEARCHING));
+    REQUIRE(received.at(0).second.value("stateName").toString() == "SEARCHING");
+    REQUIRE(received.at(1).first == "android-auto/status/error");
+    REQUIRE(received.at(1).second.value("error").toString().contains("unknown-serial"));
+
+    const Event retained = bus.retainedEvent("android-auto/status/state-changed");
+    REQUIRE(retained.payload().value("stateName").toString() == "SEARCHING");
+  }
+
+  bus.clearRetained("android-auto/status/#");
+  bus.removeRetainPattern("android-auto/status/state-changed");
+}
@@ -0,0 +1,227 @@
+/*
+ * Project: Crankshaft
+ * This file is part of Crankshaft project.
+ * Copyright (C) 2025 OpenCarDev Team
+ *
+ *  Crankshaft is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Crankshaft is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Crankshaft. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @brief Offline decoder for binary crankshaft-core log files
+ *
+ * Renders files written with Logger::setBinaryFileFormat(true) as the
+ * same JSON lines the JSON file format produces (or, with --text, the
+ * readable "[timestamp] LEVEL (component): message" form), so existing
+ * log tooling keeps working. Rotated files can be passed in order.
+ *
+ * A file that ends mid-record (power loss during a write) is decoded up to
+ * the last complete record with a warning. Segments gzipped by log
+ * rotation (".gz") are read directly when built with zlib.
+ *
+ * With --flight-recorder the inputs are FlightRecorder rings (for example
+ * "/var/lib/crankshaft/flight-recorder.bin.crash" after a crash). Their
+ * records are printed oldest first in the same formats.
+ *
+ * Exit codes: 0 success, 1 unreadable or corrupt input.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+#include <vector>
+
+#ifdef CRANKSHAFT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "services/logging/BinaryLog.h"
+#include "services/logging/FlightRecorder.h"
+
+namespace {
+
+auto levelName(int level) -> QString {
+  switch (level) {
+    case 0:
+      return "DEBUG";
+    case 1:
+      return "INFO";
+    case 2:
+      return "WARNING";
+    case 3:
+      return "ERROR";
+    case 4:
+      return "FATAL";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+/// Same shape as Logger::createLogEntry
+auto renderJson(const BinaryLogEntry& entry) -> QByteArray {
+  QJsonObject object;
+  object["timestamp"] = QDateTime::fromMSecsSinceEpoch(entry.timestampMs).toString(Qt::ISODate);
+  object["level"] = levelName(entry.level);
+  object["component"] = entry.component;
+  object["message"] = entry.message;
+  object["thread"] = QString::number(entry.threadId);
+  for (auto it = entry.context.constBegin(); it != entry.context.constEnd(); ++it) {
+    object[it.key()] = it.value();
+  }
+  return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+auto renderText(const BinaryLogEntry& entry) -> QByteArray {
+  return QString("[%1] %2 (%3): %4")
+      .arg(QDateTime::fromMSecsSinceEpoch(entry.timestampMs).toString(Qt::ISODate),
+           levelName(entry.level), entry.component, entry.message)
+      .toUtf8();
+}
+
+/// Read a whole input: a file, a gzipped segment (".gz") or "-" for stdin
+auto readInput(const QString& path, QByteArray& data) -> bool {
+#ifdef CRANKSHAFT_HAVE_ZLIB
+  if (path.endsWith(QLatin1String(".gz"))) {
+    gzFile input = gzopen(QFile::encodeName(path).constData(), "rb");
+    if (input == nullptr) {
+      std::fprintf(stderr, "%s: cannot open\n", qPrintable(path));
+      return false;
+    }
+    char buffer[64 * 1024];
+    int read = 0;
+    while ((read = gzread(input, buffer, sizeof(buffer))) > 0) {
+      data.append(buffer, read);
+    }
+    // A segment cut short still yields its complete records
+    gzclose(input);
+    return true;
+  }
+#endif
+
+  QFile file;
+  bool opened = false;
+  if (path == QLatin1String("-")) {
+    opened = file.open(stdin, QIODevice::ReadOnly);
+  } else {
+    file.setFileName(path);
+    opened = file.open(QIODevice::ReadOnly);
+  }
+  if (!opened) {
+    std::fprintf(stderr, "%s: cannot open: %s\n", qPrintable(path), qPrintable(file.errorString()));
+    return false;
+  }
+  data = file.readAll();
+  return true;
+}
+
+auto decodeFile(const QString& path, bool text) -> bool {
+  QByteArray data;
+  if (!readInput(path, data)) {
+    return false;
+  }
+
+  BinaryLogDecoder decoder(data);
+  QString error;
+  if (!decoder.readHeader(error)) {
+    std::fprintf(stderr, "%s: not a binary log (%s)\n", qPrintable(path), qPrintable(error));
+    return false;
+  }
+
+  BinaryLogEntry entry;
+  QByteArray out;
+  while (decoder.next(entry, error)) {
+    out += text ? renderText(entry) : renderJson(entry);
+    out += '\n';
+    if (out.size() >= 64 * 1024) {
+      std::fwrite(out.constData(), 1, static_cast<std::size_t>(out.size()), stdout);
+      out.clear();
+    }
+  }
+  std::fwrite(out.constData(), 1, static_cast<std::size_t>(out.size()), stdout);
+
+  if (error == QLatin1String("truncated")) {
+    std::fprintf(stderr, "%s: incomplete final record at offset %lld ignored\n", qPrintable(path),
+                 static_cast<long long>(decoder.position()));
+  } else if (!error.isEmpty()) {
+    std::fprintf(stderr, "%s: corrupt log at offset %lld (%s)\n", qPrintable(path),
+                 static_cast<long long>(decoder.position()), qPrintable(error));
+    return false;
+  }
+  return true;
+}
+
+auto decodeFlightRecording(const QString& path, bool text) -> bool {
+  QByteArray data;
+  if (!readInput(path, data)) {
+    return false;
+  }
+
+  std::vector<BinaryLogEntry> records;
+  QString error;
+  if (!FlightRecorder::readRecords(data, records, error)) {
+    std::fprintf(stderr, "%s: not a flight recorder ring (%s)\n", qPrintable(path),
+                 qPrintable(error));
+    return false;
+  }
+  if (!FlightRecorder::wasClean(data)) {
+    std::fprintf(stderr, "%s: recording did not end with a clean shutdown\n", qPrintable(path));
+  }
+
+  QByteArray out;
+  for (const BinaryLogEntry& entry : records) {
+    out += text ? renderText(entry) : renderJson(entry);
+    out += '\n';
+  }
+  std::fwrite(out.constData(), 1, static_cast<std::size_t>(out.size()), stdout);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("crankshaft-logdecode");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Decode binary crankshaft-core log files to JSON lines (or readable text)");
+  parser.addHelpOption();
+  const QCommandLineOption text("text", "Print \"[timestamp] LEVEL (component): message\" lines");
+  parser.addOption(text);
+  const QCommandLineOption flightRecorder(
+      "flight-recorder", "Inputs are crash flight recorder rings, not binary logs");
+  parser.addOption(flightRecorder);
+  parser.addPositionalArgument("files", "Binary log files in order (\"-\" reads stdin)",
+                               "files...");
+  parser.process(app);
+
+  const QStringList files = parser.positionalArguments();
+  if (files.isEmpty()) {
+    parser.showHelp(1);
+  }
+
+  bool ok = true;
+  for (const QString& path : files) {
+    const bool decoded = parser.isSet(flightRecorder)
+                             ? decodeFlightRecording(path, parser.isSet(text))
+                             : decodeFile(path, parser.isSet(text));
+    ok = decoded && ok;
+  }
+  std::fflush(stdout);
+  return ok ? 0 : 1;
+}
@@ -19,17 +19,51 @@
 
 #include "WebSocketClient.h"
 
+#include <QCborMap>
+#include <QCborValue>
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QNetworkRequest>
 #include <QTimer>
+#include <QtEndian>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+#include <QWebSocketHandshakeOptions>
+#endif
+
+#include "JsonPatch.h"
 
 WebSocketClient::WebSocketClient(const QUrl& url, QObject* parent)
-    : QObject(parent), m_socket(new QWebSocket()), m_url(url) {
+    : QObject(parent), m_url(url) {
+  if (url.scheme() == QLatin1String("unix")) {
+    m_localSocket = new QLocalSocket(this);
+    connect(m_localSocket, &QLocalSocket::connected, this, &WebSocketClient::onConnected);
+    connect(m_localSocket, &QLocalSocket::disconnected, this, &WebSocketClient::onDisconnected);
+    connect(m_localSocket, &QLocalSocket::readyRead, this, &WebSocketClient::onLocalReadyRead);
+    connect(m_localSocket, &QLocalSocket::errorOccurred, this,
+            [this](QLocalSocket::LocalSocketError error) {
+              qWarning() << "Local socket error:" << error << m_localSocket->errorString();
+              emit errorOccurred(m_localSocket->errorString());
+              // A failed connect never emits disconnected(), so retry from here
+              const bool connectFailed = error == QLocalSocket::ServerNotFoundError ||
+                                         error == QLocalSocket::ConnectionRefusedError;
+              if (connectFailed && m_reconnectOnDisconnect) {
+                QTimer::singleShot(2000, this, &WebSocketClient::reconnect);
+              }
+            });
+
+    qDebug() << "Connecting to local socket" << url.path();
+    open();
+    return;
+  }
+
+  m_socket = new QWebSocket();
   connect(m_socket, &QWebSocket::connected, this, &WebSocketClient::onConnected);
   connect(m_socket, &QWebSocket::disconnected, this, &WebSocketClient::onDisconnected);
   connect(m_socket, &QWebSocket::textMessageReceived, this,
           &WebSocketClient::onTextMessageReceived);
+  connect(m_socket, &QWebSocket::binaryMessageReceived, this,
+          &WebSocketClient::onBinaryMessageReceived);
 #if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
   connect(m_socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::errorOccurred), this,
           &WebSocketClient::onError);
@@ -39,10 +73,81 @@ WebSocketClient::WebSocketClient(const QUrl& url, QObject* parent)
 #endif
 
   qDebug() << "Connecting to" << url;
-  m_socket->open(url);
+  open();
+}
+
+void WebSocketClient::open() {
+  if (m_localSocket) {
+    m_localBuffer.clear();
+    m_localSocket->connectToServer(m_url.path());
+    return;
+  }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+  // The server picks CBOR when it supports it; otherwise frames stay JSON text
+  QWebSocketHandshakeOptions options;
+  options.setSubprotocols({QLatin1String(kCborSubprotocol), QLatin1String(kJsonSubprotocol)});
+  m_socket->open(QNetworkRequest(m_url), options);
+#else
+  m_socket->open(m_url);
+#endif
+}
+
+bool WebSocketClient::usesBinaryFrames() const {
+  if (m_localSocket) {
+    return true;
+  }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+  return m_socket->subprotocol() == QLatin1String(kCborSubprotocol);
+#else
+  return false;
+#endif
+}
+
+void WebSocketClient::sendMessage(const QJsonObject& message) {
+  if (m_localSocket) {
+    const QByteArray cbor = QCborValue::fromJsonValue(message).toCbor();
+    const quint32 length = qToBigEndian(static_cast<quint32>(cbor.size()));
+    m_localSocket->write(reinterpret_cast<const char*>(&length), sizeof(length));
+    m_localSocket->write(cbor);
+  } else if (usesBinaryFrames()) {
+    m_socket->sendBinaryMessage(QCborValue::fromJsonValue(message).toCbor());
+  } else {
+    m_socket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+  }
+}
+
+void WebSocketClient::queueOperation(const QJsonObject& operation) {
+  if (m_pendingOperations.isEmpty()) {
+    QTimer::singleShot(0, this, &WebSocketClient::flushOperations);
+  }
+  m_pendingOperations.append(operation);
+}
+
+void WebSocketClient::flushOperations() {
+  if (m_pendingOperations.isEmpty()) {
+    return;
+  }
+  if (!isConnected()) {
+    // Subscriptions are replayed on reconnect; anything else is stale by then
+    m_pendingOperations = QJsonArray();
+    return;
+  }
+
+  if (m_pendingOperations.size() == 1) {
+    sendMessage(m_pendingOperations.first().toObject());
+  } else {
+    QJsonObject batch;
+    batch["type"] = "batch";
+    batch["ops"] = m_pendingOperations;
+    sendMessage(batch);
+  }
+  m_pendingOperations = QJsonArray();
 }
 
 bool WebSocketClient::isConnected() const {
+  if (m_localSocket) {
+    return m_localSocket->state() == QLocalSocket::ConnectedState;
+  }
   return m_socket->state() == QAbstractSocket::ConnectedState;
 }
 
@@ -59,27 +164,34 @@ void WebSocketClient::subscribe(const QString& topic) {
     QJsonObject obj;
     obj["type"] = "subscribe";
     obj["topic"] = topic;
+    if (m_deltaSubscriptions.contains(topic)) {
+      obj["delta"] = true;
+    }
 
-    QJsonDocument doc(obj);
-    QString message = doc.toJson(QJsonDocument::Compact);
-    qDebug() << "[WebSocketClient] Sending subscribe message:" << message;
-    m_socket->sendTextMessage(message);
-    qDebug() << "[WebSocketClient] Subscribe message sent";
+    qDebug() << "[WebSocketClient] Queueing subscribe message:" << obj;
+    queueOperation(obj);
   } else {
     qWarning() << "[WebSocketClient] NOT CONNECTED - subscription will be sent on reconnect";
   }
 }
 
+void WebSocketClient::subscribeDelta(const QString& topic) {
+  if (!m_deltaSubscriptions.contains(topic)) {
+    m_deltaSubscriptions.append(topic);
+  }
+  subscribe(topic);
+}
+
 void WebSocketClient::unsubscribe(const QString& topic) {
   m_subscriptions.removeAll(topic);
+  m_deltaSubscriptions.removeAll(topic);
 
   if (isConnected()) {
     QJsonObject obj;
     obj["type"] = "unsubscribe";
     obj["topic"] = topic;
 
-    QJsonDocument doc(obj);
-    m_socket->sendTextMessage(doc.toJson(QJsonDocument::Compact));
+    queueOperation(obj);
     qDebug() << "Unsubscribed from topic:" << topic;
   }
 }
@@ -95,15 +207,19 @@ void WebSocketClient::publish(const QString& topic, const QVariantMap& payload)
   obj["topic"] = topic;
   obj["payload"] = QJsonObject::fromVariantMap(payload);
 
-  QJsonDocument doc(obj);
-  m_socket->sendTextMessage(doc.toJson(QJsonDocument::Compact));
+  queueOperation(obj);
   qDebug() << "Published to topic:" << topic;
 }
 
 void WebSocketClient::onConnected() {
-  qDebug() << "[WebSocketClient] WebSocket connected!";
+  qDebug() << "[WebSocketClient] WebSocket connected!"
+           << (usesBinaryFrames() ? "(binary CBOR frames)" : "(JSON text frames)");
   emit connectedChanged();
 
+  // Delta chains do not survive a reconnect; every delta topic starts from a snapshot
+  m_deltaState.clear();
+  m_resyncPending = false;
+
   // Re-subscribe to all topics
   qDebug() << "[WebSocketClient] Re-subscribing to" << m_subscriptions.size() << "topics";
   for (const auto& topic : std::as_const(m_subscriptions)) {
@@ -129,7 +245,41 @@ void WebSocketClient::onTextMessageReceived(const QString& message) {
     return;
   }
 
-  QJsonObject obj = doc.object();
+  handleMessage(doc.object());
+}
+
+void WebSocketClient::onBinaryMessageReceived(const QByteArray& message) {
+  const QCborValue value = QCborValue::fromCbor(message);
+  if (!value.isMap()) {
+    qWarning() << "[WebSocketClient] Invalid CBOR message received";
+    return;
+  }
+
+  handleMessage(value.toMap().toJsonObject());
+}
+
+void WebSocketClient::onLocalReadyRead() {
+  m_localBuffer.append(m_localSocket->readAll());
+
+  qsizetype offset = 0;
+  while (m_localBuffer.size() - offset >= 4) {
+    const quint32 length = qFromBigEndian<quint32>(m_localBuffer.constData() + offset);
+    if (length > kMaxLocalFrameBytes) {
+      qWarning() << "[WebSocketClient] Oversized local frame, reconnecting";
+      m_localBuffer.clear();
+      m_localSocket->disconnectFromServer();
+      return;
+    }
+    if (m_localBuffer.size() - offset - 4 < length) {
+      break;
+    }
+    onBinaryMessageReceived(m_localBuffer.mid(offset + 4, length));
+    offset += 4 + length;
+  }
+  m_localBuffer.remove(0, offset);
+}
+
+void WebSocketClient::handleMessage(const QJsonObject& obj) {
   QString type = obj.value("type").toString();
   qDebug() << "[WebSocketClient] Message type:" << type;
 
@@ -139,7 +289,53 @@ void WebSocketClient::onTextMessageReceived(const QString& message) {
     qDebug() << "[WebSocketClient] Event received - Topic:" << topic;
     qDebug() << "[WebSocketClient] Payload:" << payload;
     emit eventReceived(topic, payload);
+  } else if (type == "snapshot" || type == "delta") {
+    if (applyStateUpdate(obj)) {
+      const QString topic = obj.value("topic").toString();
+      emit eventReceived(topic, m_deltaState.value(topic).payload.toVariantMap());
+    } else if (!m_resyncPending) {
+      // A link of the chain is missing: ask for fresh snapshots once
+      qWarning() << "[WebSocketClient] Delta out of sequence for" << obj.value("topic").toString()
+                 << "- requesting resync";
+      m_resyncPending = true;
+      for (const QString& topic : std::as_const(m_deltaSubscriptions)) {
+        subscribe(topic);
+      }
+    }
+  } else if (type == "batch_response") {
+    for (const QJsonValue& result : obj.value("results").toArray()) {
+      const QJsonObject entry = result.toObject();
+      if (!entry.value("success").toBool()) {
+        qWarning() << "[WebSocketClient] Batched operation failed:"
+                   << entry.value("error").toString();
+      }
+    }
+  }
+}
+
+bool WebSocketClient::applyStateUpdate(const QJsonObject& message) {
+  const QString topic = message.value("topic").toString();
+  const qint64 seq = message.value("seq").toInteger();
+
+  if (message.value("type").toString() == QLatin1String("snapshot")) {
+    m_deltaState.insert(topic, {message.value("payload").toObject(), seq});
+    m_resyncPending = false;
+    return true;
   }
+
+  auto state = m_deltaState.find(topic);
+  if (state == m_deltaState.end() || state->seq != message.value("base").toInteger()) {
+    m_deltaState.remove(topic);
+    return false;
+  }
+  QJsonObject payload = state->payload;
+  if (!JsonPatch::apply(payload, message.value("patch").toArray())) {
+    m_deltaState.remove(topic);
+    return false;
+  }
+  state->payload = payload;
+  state->seq = seq;
+  return true;
 }
 
 void WebSocketClient::onError(QAbstractSocket::SocketError error) {
@@ -150,5 +346,5 @@ void WebSocketClient::onError(QAbstractSocket::SocketError error) {
 
 void WebSocketClient::reconnect() {
   qDebug() << "Attempting to reconnect...";
-  m_socket->open(m_url);
+  open();
 }
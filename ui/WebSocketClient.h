@@ -19,11 +19,27 @@
 
 #pragma once
 
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLocalSocket>
 #include <QObject>
 #include <QUrl>
 #include <QVariantMap>
 #include <QWebSocket>
 
+/**
+ * @brief Connection to Crankshaft Core
+ *
+ * "ws://" and "wss://" URLs use a WebSocket. A "unix:" URL (for example
+ * "unix:/run/crankshaft/core.sock") connects to the core's local endpoint
+ * instead: length-prefixed CBOR over a Unix domain socket, with the same
+ * message schema.
+ *
+ * Topics subscribed with subscribeDelta() arrive as a snapshot followed by
+ * JSON patches; the client applies them and emits eventReceived() with the
+ * full payload, so QML sees no difference.
+ */
 class WebSocketClient : public QObject {
   Q_OBJECT
   Q_PROPERTY(bool connected READ isConnected NOTIFY connectedChanged)
@@ -32,6 +48,8 @@ class WebSocketClient : public QObject {
   explicit WebSocketClient(const QUrl& url, QObject* parent = nullptr);
 
   Q_INVOKABLE void subscribe(const QString& topic);
+  /// Subscribe with delta updates, for large payloads that change a little at a time
+  Q_INVOKABLE void subscribeDelta(const QString& topic);
   Q_INVOKABLE void unsubscribe(const QString& topic);
   Q_INVOKABLE void publish(const QString& topic, const QVariantMap& payload);
 
@@ -46,13 +64,50 @@ class WebSocketClient : public QObject {
   void onConnected();
   void onDisconnected();
   void onTextMessageReceived(const QString& message);
+  void onBinaryMessageReceived(const QByteArray& message);
   void onError(QAbstractSocket::SocketError error);
+  void onLocalReadyRead();
 
  private:
   void reconnect();
+  /// Open the socket, offering the binary (CBOR) subprotocol first
+  void open();
+  /// Send a message object in the negotiated encoding
+  void sendMessage(const QJsonObject& message);
+  /// Queue an operation; everything queued in one event-loop pass goes out as one batch
+  void queueOperation(const QJsonObject& operation);
+  /// Send queued operations (a lone operation is sent unwrapped)
+  void flushOperations();
+  /// Handle a decoded server message (shared by text and binary frames)
+  void handleMessage(const QJsonObject& message);
+  /// Apply a snapshot or delta message; false if the delta does not fit the held state
+  auto applyStateUpdate(const QJsonObject& message) -> bool;
+  /// True when the server accepted the CBOR subprotocol
+  [[nodiscard]] auto usesBinaryFrames() const -> bool;
 
-  QWebSocket* m_socket;
+  /// Must match WebSocketServer::kCborSubprotocol / kJsonSubprotocol in core
+  static constexpr const char* kCborSubprotocol = "crankshaft.cbor.v1";
+  static constexpr const char* kJsonSubprotocol = "crankshaft.json.v1";
+  /// Must match WebSocketServer::kMaxLocalFrameBytes in core
+  static constexpr quint32 kMaxLocalFrameBytes = 1024 * 1024;
+
+  QWebSocket* m_socket{nullptr};
+  /// Set instead of m_socket for "unix:" URLs
+  QLocalSocket* m_localSocket{nullptr};
+  QByteArray m_localBuffer;
+  QJsonArray m_pendingOperations;
   QUrl m_url;
   QStringList m_subscriptions;
+  /// Subset of m_subscriptions that asked for delta updates
+  QStringList m_deltaSubscriptions;
+
+  /// Payload and sequence number last applied per delta topic
+  struct DeltaState {
+    QJsonObject payload;
+    qint64 seq{0};
+  };
+  QHash<QString, DeltaState> m_deltaState;
+  /// A resync has been requested and no snapshot has arrived yet
+  bool m_resyncPending{false};
   bool m_reconnectOnDisconnect{true};
 };
@@ -56,7 +56,8 @@ int main(int argc, char* argv[]) {
   parser.addHelpOption();
   parser.addVersionOption();
 
-  QCommandLineOption serverOption(QStringList() << "s" << "server", "WebSocket server URL",
+  QCommandLineOption serverOption(QStringList() << "s" << "server",
+                                  "Core server URL (ws://host:port or unix:/path/to/socket)",
                                   "server", "ws://localhost:8080");
   parser.addOption(serverOption);
 
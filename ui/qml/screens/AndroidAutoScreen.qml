@@ -145,18 +145,23 @@ Rectangle {
                 anchors.fill: parent
                 acceptedButtons: Qt.LeftButton
                 
+                // Drags may leave the surface; the touch contract only accepts 0..1
+                function normalised(value, extent) {
+                    return Math.min(Math.max(value / extent, 0), 1)
+                }
+                
                 onPressed: (mouse) => {
                     wsClient.publish("androidauto/touch", {
-                        "x": mouse.x / width,
-                        "y": mouse.y / height,
+                        "x": normalised(mouse.x, width),
+                        "y": normalised(mouse.y, height),
                         "action": "down"
                     })
                 }
                 
                 onReleased: (mouse) => {
                     wsClient.publish("androidauto/touch", {
-                        "x": mouse.x / width,
-                        "y": mouse.y / height,
+                        "x": normalised(mouse.x, width),
+                        "y": normalised(mouse.y, height),
                         "action": "up"
                     })
                 }
@@ -164,8 +169,8 @@ Rectangle {
                 onPositionChanged: (mouse) => {
                     if (pressed) {
                         wsClient.publish("androidauto/touch", {
-                            "x": mouse.x / width,
-                            "y": mouse.y / height,
+                            "x": normalised(mouse.x, width),
+                            "y": normalised(mouse.y, height),
                             "action": "move"
                         })
                     }
@@ -328,18 +333,23 @@ Rectangle {
                 anchors.fill: parent
                 acceptedButtons: Qt.LeftButton
 
+                // Drags may leave the surface; the touch contract only accepts 0..1
+                function normalised(value, extent) {
+                    return Math.min(Math.max(value / extent, 0), 1)
+                }
+
                 onPressed: (mouse) => {
                     wsClient.publish("androidauto/touch", {
-                        "x": mouse.x / width,
-                        "y": mouse.y / height,
+                        "x": normalised(mouse.x, width),
+                        "y": normalised(mouse.y, height),
                         "action": "down"
                     })
                 }
 
                 onReleased: (mouse) => {
                     wsClient.publish("androidauto/touch", {
-                        "x": mouse.x / width,
-                        "y": mouse.y / height,
+                        "x": normalised(mouse.x, width),
+                        "y": normalised(mouse.y, height),
                         "action": "up"
                     })
                 }
@@ -347,8 +357,8 @@ Rectangle {
                 onPositionChanged: (mouse) => {
                     if (pressed) {
                         wsClient.publish("androidauto/touch", {
-                            "x": mouse.x / width,
-                            "y": mouse.y / height,
+                            "x": normalised(mouse.x, width),
+                            "y": normalised(mouse.y, height),
                             "action": "move"
                         })
                     }